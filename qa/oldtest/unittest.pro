@@ -6,7 +6,21 @@ SUBDIRS += \
     ../src/widgets/unittest/iconaction \
     ../src/widgets/unittest/richtext \
     ../src/unittest/psiiconset \
-    ../src/unittest/psipopup
+    ../src/unittest/psipopup \
+    ../src/unittest/clienticonmatcher \
+    ../src/unittest/highlightmatcher \
+    ../src/unittest/filetransferio \
+    ../src/unittest/rostersearchindex \
+    ../src/unittest/sqlitetuning \
+    ../src/unittest/webassetcache \
+    ../src/unittest/muclastseen \
+    ../src/unittest/mucautojoiner \
+    ../src/unittest/tracer \
+    ../src/unittest/eventloopwatchdog \
+    ../src/unittest/xmlring \
+    ../src/unittest/stanzareplay \
+    ../src/unittest/pgpkeyservice \
+    ../src/unittest/psioptions
 
 QMAKE_EXTRA_TARGETS += check
 check.commands = sh ./checkall
@@ -0,0 +1,132 @@
+/*
+ * benchhistory.cpp - benchmarks of the SQLite history storage
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "benchmark.h"
+
+#include "eventdb.h"
+#include "psiaccount.h"
+#include "psicon.h"
+#include "psievent.h"
+
+#include <QtTest/QtTest>
+
+static const int contactCount       = 10;
+static const int messagesPerContact = 1000;
+
+class HistoryBenchmark : public QObject {
+    Q_OBJECT
+
+    EDB    *edb_ = nullptr;
+    QString accId_;
+
+    static XMPP::Jid contact(int n) { return XMPP::Jid(QString("history%1@bench.example").arg(n)); }
+
+    PsiEvent::Ptr message(int contactNo, int n, const QDateTime &stamp) const
+    {
+        XMPP::Message m;
+        m.setFrom(contact(contactNo));
+        m.setType(XMPP::Message::Type::Chat);
+        // one message in a hundred has something rare to search for
+        QString body = QString("message %1 about topic %2").arg(n).arg(n % 37);
+        if (n % 100 == 0)
+            body += " needle";
+        m.setBody(body);
+        m.setTimeStamp(stamp);
+        return PsiEvent::Ptr(new MessageEvent(m, Benchmark::account()));
+    }
+
+    static bool wait(EDBHandle &h, const std::function<void()> &request)
+    {
+        QSignalSpy spy(&h, &EDBHandle::finished);
+        request();
+        return spy.wait(60000);
+    }
+
+    bool fill(int contactNo, int count, int first)
+    {
+        EDBHandle h(edb_);
+        QDateTime stamp = QDateTime::currentDateTime().addSecs(-count);
+        // the handle only reports its latest request, and requests are served in order
+        return wait(h, [&]() {
+            for (int i = 0; i < count; ++i)
+                h.append(accId_, contact(contactNo), message(contactNo, first + i, stamp.addSecs(i)), EDB::Contact);
+        }) && h.writeSuccess();
+    }
+
+private slots:
+    void initTestCase()
+    {
+        edb_   = Benchmark::session()->edb();
+        accId_ = Benchmark::account()->id();
+        QVERIFY(edb_);
+        for (int c = 0; c < contactCount; ++c)
+            QVERIFY(fill(c, messagesPerContact, 0));
+    }
+
+    void append()
+    {
+        int n = messagesPerContact;
+        QBENCHMARK
+        {
+            QVERIFY(fill(contactCount, 100, n));
+            n += 100;
+        }
+    }
+
+    void get_data()
+    {
+        QTest::addColumn<int>("begin");
+        QTest::newRow("latest") << 0;
+        QTest::newRow("deep") << messagesPerContact - 100;
+    }
+    void get()
+    {
+        QFETCH(int, begin);
+        EDBHandle h(edb_);
+        QBENCHMARK
+        {
+            QVERIFY(wait(h, [&]() { h.get(accId_, contact(0), QDateTime(), EDB::Backward, begin, 50); }));
+            QCOMPARE(h.result().size(), 50);
+        }
+    }
+
+    void find_data()
+    {
+        QTest::addColumn<QString>("text");
+        QTest::addColumn<bool>("allContacts");
+        QTest::newRow("rare") << QString("needle") << false;
+        QTest::newRow("common") << QString("topic") << false;
+        QTest::newRow("rare-all-contacts") << QString("needle") << true;
+    }
+    void find()
+    {
+        QFETCH(QString, text);
+        QFETCH(bool, allContacts);
+        const XMPP::Jid jid = allContacts ? XMPP::Jid() : contact(0);
+        EDBHandle       h(edb_);
+        QBENCHMARK
+        {
+            QVERIFY(wait(h, [&]() { h.find(accId_, text, jid, QDateTime(), EDB::Backward); }));
+            QVERIFY(!h.result().isEmpty());
+        }
+    }
+};
+
+PSI_BENCHMARK(HistoryBenchmark);
+#include "benchhistory.moc"
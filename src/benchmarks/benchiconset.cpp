@@ -0,0 +1,52 @@
+/*
+ * benchiconset.cpp - benchmarks of iconset loading
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "benchmark.h"
+
+#include "iconset.h"
+
+#include <QtTest/QtTest>
+
+class IconsetBenchmark : public QObject {
+    Q_OBJECT
+
+private slots:
+    void load_data()
+    {
+        QTest::addColumn<QString>("path");
+        QTest::newRow("directory") << QString("/iconsets/emoticons/default");
+        QTest::newRow("default-roster") << QString("/iconsets/roster/default");
+        QTest::newRow("jisp") << QString("/iconsets/roster/stellar-1.jisp");
+    }
+    void load()
+    {
+        QFETCH(QString, path);
+        int count = 0;
+        QBENCHMARK
+        {
+            Iconset is;
+            QVERIFY(is.load(Benchmark::sourceDir() + path));
+            count = is.count();
+        }
+        QVERIFY(count > 0);
+    }
+};
+
+PSI_BENCHMARK(IconsetBenchmark);
+#include "benchiconset.moc"
@@ -0,0 +1,51 @@
+/*
+ * benchmark.h - registry and fixtures of psi-benchmarks
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <QString>
+
+#include <functional>
+
+class PsiAccount;
+class PsiCon;
+class QObject;
+
+namespace Benchmark {
+
+using Factory = std::function<QObject *()>;
+
+// suites are run in the order they were registered. see PSI_BENCHMARK
+bool registerSuite(const char *name, const Factory &factory);
+
+// the root of the source tree, for iconsets and such
+QString sourceDir();
+
+// a client running a throwaway profile with a single account which never
+// connects. started on first use and shared by all the suites
+PsiCon     *session();
+PsiAccount *account();
+
+} // namespace Benchmark
+
+#define PSI_BENCHMARK(Class)                                                                                           \
+    static const bool Class##Registered = Benchmark::registerSuite(#Class, []() -> QObject * { return new Class; })
+
+#endif // BENCHMARK_H
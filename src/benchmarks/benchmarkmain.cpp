@@ -0,0 +1,249 @@
+/*
+ * benchmarkmain.cpp - runs the psi-benchmarks suites
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * psi-benchmarks [--json=FILE] [--baseline=FILE] [--tolerance=PERCENT] [--suite=NAME[,NAME...]] [QtTest options]
+ *
+ * Runs every registered suite headless (unless QT_QPA_PLATFORM says otherwise)
+ * against a temporary home directory and writes all the results to FILE,
+ * psi-benchmarks.json by default:
+ *   { "version": ..., "qt": ..., "date": ...,
+ *     "results": { "Suite::function:tag": { "metric": ..., "value": ..., "iterations": ... } } }
+ * where value is per iteration, in the units of the metric.
+ *
+ * With --baseline the results are compared to an earlier JSON file. Anything
+ * slower than the baseline by more than the tolerance (20% by default) is
+ * reported and makes the exit code non-zero, as does a failed check.
+ * QtTest options such as -iterations or -callgrind are passed to each suite.
+ */
+
+#include "benchmark.h"
+
+#include "applicationinfo.h"
+#include "optionstree.h"
+#include "profiles.h"
+#include "psiaccount.h"
+#include "psicon.h"
+#include "psicontactlist.h"
+
+#include <QApplication>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QSaveFile>
+#include <QTemporaryDir>
+#include <QXmlStreamReader>
+#include <QtCrypto>
+#include <QtTest/QtTest>
+
+#include <cmath>
+#include <memory>
+
+namespace {
+
+struct Suite {
+    QString            name;
+    Benchmark::Factory factory;
+};
+
+struct Result {
+    QString metric;
+    double  value; // per iteration
+    int     iterations;
+};
+
+QList<Suite> &suites()
+{
+    static QList<Suite> list;
+    return list;
+}
+
+PsiCon *psi = nullptr;
+
+// QtTest has no JSON output, so the results are read back from its XML log
+void readResults(const QString &suite, const QString &fileName, QMap<QString, Result> *results)
+{
+    QFile f(fileName);
+    if (!f.open(QIODevice::ReadOnly))
+        return;
+
+    QXmlStreamReader xml(&f);
+    QString          function;
+    while (!xml.atEnd()) {
+        if (xml.readNext() != QXmlStreamReader::StartElement)
+            continue;
+        const auto attributes = xml.attributes();
+        if (xml.name() == QLatin1String("TestFunction")) {
+            function = attributes.value("name").toString();
+        } else if (xml.name() == QLatin1String("BenchmarkResult")) {
+            QString    key = suite + "::" + function;
+            const auto tag = attributes.value("tag").toString();
+            if (!tag.isEmpty())
+                key += ':' + tag;
+            results->insert(key,
+                            { attributes.value("metric").toString(), attributes.value("value").toDouble(),
+                              attributes.value("iterations").toInt() });
+        }
+    }
+}
+
+bool writeResults(const QString &fileName, const QMap<QString, Result> &results)
+{
+    QJsonObject list;
+    for (auto it = results.cbegin(); it != results.cend(); ++it) {
+        list.insert(it.key(),
+                    QJsonObject { { "metric", it->metric }, { "value", it->value }, { "iterations", it->iterations } });
+    }
+    QJsonObject root { { "version", ApplicationInfo::version() },
+                       { "qt", QString::fromLatin1(qVersion()) },
+                       { "date", QDateTime::currentDateTimeUtc().toString(Qt::ISODate) },
+                       { "results", list } };
+
+    QSaveFile f(fileName);
+    if (!f.open(QIODevice::WriteOnly)) {
+        qWarning("benchmarks: failed to write %s: %s", qPrintable(fileName), qPrintable(f.errorString()));
+        return false;
+    }
+    f.write(QJsonDocument(root).toJson());
+    return f.commit();
+}
+
+// returns the number of results which got worse than the baseline by more than tolerance percent
+int compare(const QString &fileName, const QMap<QString, Result> &results, double tolerance)
+{
+    QFile f(fileName);
+    if (!f.open(QIODevice::ReadOnly)) {
+        qWarning("benchmarks: failed to read the baseline %s", qPrintable(fileName));
+        return 1;
+    }
+    const auto baseline = QJsonDocument::fromJson(f.readAll()).object().value("results").toObject();
+
+    int regressions = 0;
+    for (auto it = results.cbegin(); it != results.cend(); ++it) {
+        const auto   base = baseline.value(it.key()).toObject();
+        const double was  = base.value("value").toDouble();
+        if (base.value("metric").toString() != it->metric || was <= 0)
+            continue; // new or not comparable
+
+        const double change = (it->value / was - 1) * 100;
+        if (std::abs(change) <= tolerance)
+            continue;
+        if (change > 0)
+            ++regressions;
+        printf("%s %s: %g -> %g %s (%+.1f%%)\n", change > 0 ? "REGRESSION" : "improvement", qPrintable(it.key()), was,
+               it->value, qPrintable(it->metric), change);
+    }
+    return regressions;
+}
+
+} // namespace
+
+bool Benchmark::registerSuite(const char *name, const Factory &factory)
+{
+    suites().append({ QString::fromLatin1(name), factory });
+    return true;
+}
+
+QString Benchmark::sourceDir() { return QStringLiteral(PSI_SOURCE_DIR); }
+
+PsiCon *Benchmark::session()
+{
+    if (psi)
+        return psi;
+
+    activeProfile = QStringLiteral("benchmark");
+    profileNew(activeProfile);
+
+    UserAccount account;
+    account.name     = QStringLiteral("Benchmark");
+    account.jid      = QStringLiteral("bench@bench.example");
+    account.opt_auto = false; // there is no server
+    OptionsTree accounts;
+    account.toOptions(&accounts, "accounts.a0");
+    accounts.saveOptions(pathToProfile(activeProfile, ApplicationInfo::ConfigLocation) + "/accounts.xml", "accounts",
+                         ApplicationInfo::optionsNS(), ApplicationInfo::version());
+
+    psi = new PsiCon();
+    if (!psi->init())
+        qFatal("benchmarks: failed to start the session");
+    return psi;
+}
+
+PsiAccount *Benchmark::account() { return session()->contactList()->defaultAccount(); }
+
+int main(int argc, char *argv[])
+{
+    // nothing of the user's profiles is touched
+    QTemporaryDir home;
+    qputenv("PSIDATADIR", home.path().toLocal8Bit());
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QCA::Initializer init;
+    QApplication     app(argc, argv);
+    QApplication::setApplicationName(ApplicationInfo::name());
+    QApplication::setApplicationVersion(ApplicationInfo::version());
+    QApplication::setQuitOnLastWindowClosed(false);
+
+    QString     jsonFile  = QStringLiteral("psi-benchmarks.json");
+    QString     baseline;
+    double      tolerance = 20;
+    QStringList only;
+    QStringList testArgs;
+    const auto  args = QApplication::arguments();
+    for (int i = 1; i < args.size(); ++i) {
+        const QString &arg = args[i];
+        if (arg.startsWith("--json="))
+            jsonFile = arg.mid(7);
+        else if (arg.startsWith("--baseline="))
+            baseline = arg.mid(11);
+        else if (arg.startsWith("--tolerance="))
+            tolerance = arg.mid(12).toDouble();
+        else if (arg.startsWith("--suite="))
+            only += arg.mid(8).split(',');
+        else
+            testArgs += arg;
+    }
+
+    QMap<QString, Result> results;
+    int                   failed = 0;
+    for (const auto &suite : std::as_const(suites())) {
+        if (!only.isEmpty() && !only.contains(suite.name))
+            continue;
+        const QString            log = home.filePath(suite.name + ".xml");
+        std::unique_ptr<QObject> object(suite.factory());
+        failed += QTest::qExec(object.get(),
+                               QStringList { args.value(0), "-o", log + ",xml", "-o", "-,txt" } + testArgs);
+        readResults(suite.name, log, &results);
+    }
+    delete psi;
+    psi = nullptr;
+
+    if (!writeResults(jsonFile, results))
+        return 1;
+    printf("%d results written to %s\n", int(results.size()), qPrintable(jsonFile));
+
+    const int regressions = baseline.isEmpty() ? 0 : compare(baseline, results, tolerance);
+    return failed || regressions ? 1 : 0;
+}
+
+#ifdef QCA_STATIC
+#include <QtPlugin>
+Q_IMPORT_PLUGIN(qca_ossl)
+#endif
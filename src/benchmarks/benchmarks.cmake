@@ -0,0 +1,50 @@
+# psi-benchmarks: QBENCHMARK suites of the hot paths, see benchmarkmain.cpp.
+# The suites use the real classes, so everything but main.cpp is built again
+# with the same definitions and libraries as the client
+
+find_package(Qt${QT_DEFAULT_MAJOR_VERSION} REQUIRED COMPONENTS Test)
+
+set(BENCHMARK_SOURCES ${SOURCES})
+list(REMOVE_ITEM BENCHMARK_SOURCES main.cpp)
+
+list(APPEND BENCHMARK_SOURCES
+    benchmarks/benchmarkmain.cpp
+    benchmarks/benchhistory.cpp
+    benchmarks/benchiconset.cpp
+    benchmarks/benchomemo.cpp
+    benchmarks/benchoptions.cpp
+    benchmarks/benchroster.cpp
+    benchmarks/benchtext.cpp
+)
+
+add_executable(psi-benchmarks
+    ${BENCHMARK_SOURCES}
+    ${HEADERS}
+    benchmarks/benchmark.h
+    ${UI_FORMS}
+    ${QRC_SOURCES}
+)
+
+add_dependencies(psi-benchmarks iris build_ui_files)
+if(UNIX OR IS_WEBENGINE)
+    add_dependencies(psi-benchmarks qhttp)
+endif()
+
+get_target_property(BENCHMARK_DEFINITIONS ${PROJECT_NAME} COMPILE_DEFINITIONS)
+if(NOT BENCHMARK_DEFINITIONS)
+    set(BENCHMARK_DEFINITIONS "")
+endif()
+target_compile_definitions(psi-benchmarks PRIVATE
+    ${BENCHMARK_DEFINITIONS}
+    PSI_SOURCE_DIR="${PROJECT_SOURCE_DIR}"
+)
+
+get_target_property(BENCHMARK_LIBRARIES ${PROJECT_NAME} LINK_LIBRARIES)
+target_link_libraries(psi-benchmarks
+    ${BENCHMARK_LIBRARIES}
+    Qt${QT_DEFAULT_MAJOR_VERSION}::Test
+)
+
+set_target_properties(psi-benchmarks PROPERTIES
+    RUNTIME_OUTPUT_DIRECTORY "${CMAKE_BINARY_DIR}/benchmarks"
+)
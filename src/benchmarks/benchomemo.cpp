@@ -0,0 +1,177 @@
+/*
+ * benchomemo.cpp - benchmarks of the OMEMO storage
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "benchmark.h"
+
+#ifdef IRIS_ENABLE_OMEMO
+
+#include "psiomemostorage.h"
+
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+static const int contactCount      = 1000;
+static const int devicesPerContact = 4;
+
+class OmemoStorageBenchmark : public QObject {
+    Q_OBJECT
+
+    QTemporaryDir dir_;
+
+    static QString contact(int n) { return QString("omemo%1@bench.example").arg(n); }
+    static QByteArray random(int size)
+    {
+        QByteArray ret(size, Qt::Uninitialized);
+        for (auto &c : ret)
+            c = char(QRandomGenerator::global()->bounded(256));
+        return ret;
+    }
+
+    // what a device looks like after some conversation in both protocols
+    static XMPP::OmemoStorage::Device device()
+    {
+        XMPP::OmemoStorage::Device device;
+        for (auto protocol : { XMPP::OmemoProtocol::Legacy, XMPP::OmemoProtocol::Omemo2 }) {
+            auto &state                  = device.protocols[protocol];
+            state.keyId                  = random(33);
+            state.session                = random(1500);
+            state.lastReceivedRatchetKey = random(33);
+        }
+        return device;
+    }
+
+    static void populate(PsiOmemoStorage &storage)
+    {
+        for (int c = 0; c < contactCount; ++c) {
+            for (int id = 1; id <= devicesPerContact; ++id) {
+                const auto d = device();
+                storage.addDevice(contact(c), uint32_t(id), d);
+                storage.setTrustLevel("urn:xmpp:omemo:2", XMPP::Jid(contact(c)),
+                                      d.protocols.value(XMPP::OmemoProtocol::Omemo2).keyId,
+                                      id % 2 ? XMPP::EncryptionTrustLevel::ManuallyTrusted
+                                             : XMPP::EncryptionTrustLevel::Undecided);
+            }
+        }
+        storage.flush();
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QVERIFY(dir_.isValid());
+        PsiOmemoStorage storage(dir_.path(), "bench");
+        QVERIFY(storage.isOpen());
+        populate(storage);
+    }
+
+    void fill()
+    {
+        int run = 0;
+        QBENCHMARK
+        {
+            PsiOmemoStorage storage(dir_.path(), QString("fill%1").arg(run++));
+            populate(storage);
+        }
+    }
+
+    // what happens at login
+    void allData()
+    {
+        QBENCHMARK
+        {
+            PsiOmemoStorage storage(dir_.path(), "bench");
+            const auto      data = storage.allData();
+            QCOMPARE(data.devices.size(), contactCount);
+            // the plugin trust migration right after that
+            for (auto c = data.devices.cbegin(); c != data.devices.cend(); ++c) {
+                for (auto d = c->cbegin(); d != c->cend(); ++d)
+                    storage.legacyTrust(c.key(), d.key());
+            }
+        }
+    }
+
+    void trustLevel()
+    {
+        PsiOmemoStorage storage(dir_.path(), "bench");
+        QBENCHMARK
+        {
+            for (int c = 0; c < contactCount; ++c)
+                storage.trustLevel("urn:xmpp:omemo:2", XMPP::Jid(contact(c)), QByteArray(33, 'x'));
+        }
+    }
+
+    // not a benchmark. the storage is leaked like after a crash, and only what is on disk comes back
+    void crashSafety()
+    {
+        const auto saved = [this]() {
+            PsiOmemoStorage storage(dir_.path(), "crash");
+            return storage.allData().devices.value(contact(0)).value(1).protocols.value(XMPP::OmemoProtocol::Omemo2);
+        };
+        const auto trust = [this](const QByteArray &keyId) {
+            PsiOmemoStorage storage(dir_.path(), "crash");
+            return storage.trustLevel("urn:xmpp:omemo:2", XMPP::Jid(contact(0)), keyId);
+        };
+
+        auto storage = new PsiOmemoStorage(dir_.path(), "crash");
+        auto d       = device();
+        auto state   = &d.protocols[XMPP::OmemoProtocol::Omemo2];
+        QVERIFY(storage->addDevice(contact(0), 1, d));
+        QCOMPARE(saved().session, state->session);
+
+        // written behind
+        state->label = "phone";
+        QVERIFY(storage->addDevice(contact(0), 1, d));
+        QVERIFY(saved().label.isEmpty());
+        QVERIFY(storage->setTrustLevel("urn:xmpp:omemo:2", XMPP::Jid(contact(0)), state->keyId,
+                                       XMPP::EncryptionTrustLevel::AutomaticallyTrusted));
+        QCOMPARE(trust(state->keyId), XMPP::EncryptionTrustLevel::Undecided);
+
+        // written at once, with everything queued before
+        state->session = random(1500);
+        QVERIFY(storage->addDevice(contact(0), 1, d));
+        QCOMPARE(saved().session, state->session);
+        QCOMPARE(saved().label, QString("phone"));
+        QCOMPARE(trust(state->keyId), XMPP::EncryptionTrustLevel::AutomaticallyTrusted);
+
+        QVERIFY(storage->setTrustLevel("urn:xmpp:omemo:2", XMPP::Jid(contact(0)), state->keyId,
+                                       XMPP::EncryptionTrustLevel::Distrusted));
+        QCOMPARE(trust(state->keyId), XMPP::EncryptionTrustLevel::Distrusted);
+    }
+
+    // the counters of a device change with every message. a new session is written right away instead
+    void sessionUpdates()
+    {
+        PsiOmemoStorage storage(dir_.path(), "bench");
+        auto            d = device();
+        QBENCHMARK
+        {
+            for (int i = 0; i < 100; ++i) {
+                d.protocols[XMPP::OmemoProtocol::Omemo2].unrespondedSentStanzasCount = i;
+                storage.addDevice(contact(i % 10), 1, d);
+            }
+            QVERIFY(storage.flush());
+        }
+    }
+};
+
+PSI_BENCHMARK(OmemoStorageBenchmark);
+#include "benchomemo.moc"
+
+#endif // IRIS_ENABLE_OMEMO
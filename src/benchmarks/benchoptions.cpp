@@ -0,0 +1,112 @@
+/*
+ * benchoptions.cpp - benchmarks of the options tree
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "benchmark.h"
+
+#include "applicationinfo.h"
+#include "optionstree.h"
+
+#include <QtTest/QtTest>
+
+class OptionsBenchmark : public QObject {
+    Q_OBJECT
+
+    OptionsTree tree_;
+    QStringList names_;
+
+    static void paths()
+    {
+        QTest::addColumn<QString>("path");
+        QTest::newRow("shallow") << QString("options.ui.contactlist.show.offline-contacts");
+        QTest::newRow("deep") << QString("options.ui.look.colors.contactlist.status.online");
+        QTest::newRow("missing") << QString("options.ui.contactlist.no-such-option");
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QVERIFY(tree_.loadOptions(Benchmark::sourceDir() + "/options/default.xml", "options",
+                                  ApplicationInfo::optionsNS()));
+        names_ = tree_.allOptionNames();
+        QVERIFY(names_.size() > 100);
+    }
+
+    void getOption_data() { paths(); }
+    void getOption()
+    {
+        QFETCH(QString, path);
+        QBENCHMARK { tree_.getOption(path); }
+    }
+
+    void getAllOptions()
+    {
+        QBENCHMARK
+        {
+            for (const auto &name : std::as_const(names_))
+                tree_.getOption(name);
+        }
+    }
+
+    void setOption_data()
+    {
+        QTest::addColumn<bool>("changed");
+        QTest::addColumn<bool>("subscribed");
+        QTest::newRow("same") << false << false;
+        QTest::newRow("changed") << true << false;
+        QTest::newRow("changed-subscribed") << true << true;
+    }
+    void setOption()
+    {
+        QFETCH(bool, changed);
+        QFETCH(bool, subscribed);
+        const QString path = "options.ui.chat.log-height";
+        QObject       context;
+        int           notified = 0;
+        if (subscribed)
+            tree_.subscribe("options.ui.chat", &context, [&](const QStringList &) { ++notified; });
+
+        int i = 0;
+        QBENCHMARK { tree_.setOption(path, changed ? ++i : 0); }
+        QVERIFY(!subscribed || notified > 0);
+    }
+
+    void setOptionBatch()
+    {
+        QObject context;
+        tree_.subscribe("options.ui", &context, [](const QStringList &) { });
+        QStringList ints;
+        for (const auto &name : std::as_const(names_)) {
+            if (name.startsWith("options.ui.") && tree_.getOption(name).userType() == QMetaType::Int)
+                ints.append(name);
+        }
+        QVERIFY(!ints.isEmpty());
+
+        int i = 0;
+        QBENCHMARK
+        {
+            OptionsTree::Batch batch(&tree_);
+            ++i;
+            for (const auto &name : std::as_const(ints))
+                tree_.setOption(name, i);
+        }
+    }
+};
+
+PSI_BENCHMARK(OptionsBenchmark);
+#include "benchoptions.moc"
@@ -0,0 +1,153 @@
+/*
+ * benchroster.cpp - benchmarks of the roster and groupchat user models
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "benchmark.h"
+
+#include "contactlistmodel.h"
+#include "contactlistproxymodel.h"
+#include "gcuserview.h"
+#include "iris/xmpp_muc.h"
+#include "iris/xmpp_status.h"
+#include "psiaccount.h"
+#include "psicon.h"
+#include "psicontactlist.h"
+
+#include <QDomDocument>
+#include <QtTest/QtTest>
+
+static const int rosterSize    = 2000;
+static const int occupantCount = 500;
+
+static int countRows(const QAbstractItemModel &model, const QModelIndex &parent = QModelIndex())
+{
+    int rows = model.rowCount(parent);
+    int ret  = rows;
+    for (int i = 0; i < rows; ++i)
+        ret += countRows(model, model.index(i, 0, parent));
+    return ret;
+}
+
+class RosterBenchmark : public QObject {
+    Q_OBJECT
+
+    PsiContactList *contactList_ = nullptr;
+
+private slots:
+    void initTestCase()
+    {
+        contactList_ = Benchmark::session()->contactList();
+        contactList_->setShowOffline(true);
+
+        // the same roster push a server would send, 100 contacts at a time
+        for (int first = 0; first < rosterSize; first += 100) {
+            QDomDocument doc;
+            QDomElement  iq = doc.createElementNS("jabber:client", "iq");
+            iq.setAttribute("type", "set");
+            iq.setAttribute("id", QString("push%1").arg(first));
+            QDomElement query = doc.createElementNS("jabber:iq:roster", "query");
+            iq.appendChild(query);
+            for (int i = first; i < first + 100; ++i) {
+                QDomElement item = doc.createElementNS("jabber:iq:roster", "item");
+                item.setAttribute("jid", QString("contact%1@bench.example").arg(i));
+                item.setAttribute("name", QString("Contact %1").arg(i, 4, 10, QChar('0')));
+                item.setAttribute("subscription", "both");
+                QDomElement group = doc.createElementNS("jabber:iq:roster", "group");
+                group.appendChild(doc.createTextNode(QString("Group %1").arg(i % 20)));
+                item.appendChild(group);
+                query.appendChild(item);
+            }
+            Benchmark::account()->injectIncomingStanza(iq);
+        }
+        QTRY_VERIFY_WITH_TIMEOUT(contactList_->contacts().size() >= rosterSize, 30000);
+    }
+
+    void bulkAdd_data()
+    {
+        QTest::addColumn<bool>("groups");
+        QTest::newRow("flat") << false;
+        QTest::newRow("groups") << true;
+    }
+    void bulkAdd()
+    {
+        QFETCH(bool, groups);
+        ContactListModel model(contactList_);
+        model.setGroupsEnabled(groups);
+        QBENCHMARK { model.invalidateLayout(); }
+        QVERIFY(countRows(model) >= rosterSize);
+    }
+
+    void sort()
+    {
+        ContactListModel model(contactList_);
+        model.setGroupsEnabled(true);
+        model.invalidateLayout();
+        ContactListProxyModel proxy(nullptr);
+        proxy.setSourceModel(&model);
+        proxy.sort(0);
+        QBENCHMARK
+        {
+            proxy.invalidate();
+            QVERIFY(countRows(proxy) >= rosterSize);
+        }
+    }
+};
+
+class MucBenchmark : public QObject {
+    Q_OBJECT
+
+    static XMPP::Status occupant(int n, const QString &show = QString())
+    {
+        XMPP::Status s(show);
+        s.setMUCItem(XMPP::MUCItem(n % 50 ? XMPP::MUCItem::Participant : XMPP::MUCItem::Moderator,
+                                   n % 50 ? XMPP::MUCItem::NoAffiliation : XMPP::MUCItem::Owner));
+        return s;
+    }
+
+private slots:
+    void join()
+    {
+        GCUserModel model(Benchmark::account(), XMPP::Jid("room@conference.bench.example/me"), nullptr);
+        QBENCHMARK
+        {
+            for (int i = 0; i < occupantCount; ++i)
+                model.updateEntry(QString("nick%1").arg(i), occupant(i));
+            model.clear();
+        }
+    }
+
+    void statusChanges()
+    {
+        GCUserModel model(Benchmark::account(), XMPP::Jid("room@conference.bench.example/me"), nullptr);
+        for (int i = 0; i < occupantCount; ++i)
+            model.updateEntry(QString("nick%1").arg(i), occupant(i));
+
+        bool away = false;
+        QBENCHMARK
+        {
+            away = !away;
+            for (int i = 0; i < occupantCount; i += 5)
+                model.updateEntry(QString("nick%1").arg(i), occupant(i, away ? "away" : ""));
+        }
+        QCOMPARE(model.nickList().size(), occupantCount);
+    }
+};
+
+PSI_BENCHMARK(RosterBenchmark);
+PSI_BENCHMARK(MucBenchmark);
+#include "benchroster.moc"
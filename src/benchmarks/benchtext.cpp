@@ -0,0 +1,102 @@
+/*
+ * benchtext.cpp - benchmarks of message text processing
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "benchmark.h"
+
+#include "emojiregistry.h"
+#include "iconset.h"
+#include "psiiconset.h"
+#include "textutil.h"
+
+#include <QtTest/QtTest>
+
+class TextBenchmark : public QObject {
+    Q_OBJECT
+
+    static void messages()
+    {
+        QTest::addColumn<QString>("text");
+        QTest::newRow("short") << QString("ok, see you tomorrow");
+        QTest::newRow("links") << QString("docs at https://psi-im.org/wiki and www.example.org/path?x=1, mail "
+                                          "someone@example.org or join xmpp:room@conference.example.org?join ")
+                                      .repeated(4);
+        QTest::newRow("emoticons") << QString("that was fun :-) really :D but then :( and <3 ;) ").repeated(8);
+        QTest::newRow("emoji") << QString::fromUtf8("thanks 👍🏽 see you 😀 flags 🇷🇺🇺🇦 family 👨‍👩‍👧 ").repeated(8);
+        QTest::newRow("long") << QString("Lorem ipsum dolor sit amet, consectetur adipiscing elit. ").repeated(100);
+    }
+
+private slots:
+    void initTestCase()
+    {
+        // what the session would load from the data directory
+        if (PsiIconset::instance()->emoticons.isEmpty()) {
+            Iconset emoticons;
+            QVERIFY(emoticons.load(Benchmark::sourceDir() + "/iconsets/emoticons/default"));
+            PsiIconset::instance()->emoticons.append(emoticons);
+        }
+    }
+
+    void linkify_data() { messages(); }
+    void linkify()
+    {
+        QFETCH(QString, text);
+        const QString rich = TextUtil::plain2rich(text);
+        QBENCHMARK { TextUtil::linkify(rich); }
+    }
+
+    void emoticonify_data() { messages(); }
+    void emoticonify()
+    {
+        QFETCH(QString, text);
+        const QString rich = TextUtil::linkify(TextUtil::plain2rich(text));
+        QBENCHMARK { TextUtil::emoticonify(rich); }
+    }
+
+    void rich2plain_data() { messages(); }
+    void rich2plain()
+    {
+        QFETCH(QString, text);
+        const QString rich = TextUtil::emoticonify(TextUtil::linkify(TextUtil::plain2rich(text)));
+        QBENCHMARK { TextUtil::rich2plain(rich); }
+    }
+
+    void findEmoji_data() { messages(); }
+    void findEmoji()
+    {
+        QFETCH(QString, text);
+        const auto &registry = EmojiRegistry::instance();
+        int         found    = 0;
+        QBENCHMARK
+        {
+            found = 0;
+            for (int pos = 0;;) {
+                const auto [ref, at] = registry.findEmoji(text, pos);
+                if (ref.isEmpty())
+                    break;
+                ++found;
+                pos = at + int(ref.size());
+            }
+        }
+        if (QTest::currentDataTag() == QLatin1String("emoji"))
+            QVERIFY(found >= 4 * 8);
+    }
+};
+
+PSI_BENCHMARK(TextBenchmark);
+#include "benchtext.moc"
@@ -117,6 +117,7 @@ void ChatDlg::init()
     chatView()->setLocalNickname(account()->nick());
 #ifdef WEBKIT
     chatView()->setAccount(account());
+    chatView()->setHibernationEnabled(PsiOptions::instance()->getOption("options.ui.tabs.hibernate-after").toInt() > 0);
 #else
     chatView()->setMediaOpener(account()->fileSharingDeviceOpener());
 #endif
@@ -348,6 +349,22 @@ void ChatDlg::activated()
     setChatState(XMPP::StateActive);
 }
 
+bool ChatDlg::hibernate()
+{
+#ifdef WEBKIT
+    return chatView()->hibernate();
+#else
+    return false; // nothing worth to free in a text widget
+#endif
+}
+
+void ChatDlg::wakeUp()
+{
+#ifdef WEBKIT
+    chatView()->wakeUp();
+#endif
+}
+
 void ChatDlg::dropEvent(QDropEvent *event)
 {
     FileShareDlg::shareFiles(
@@ -588,6 +605,9 @@ void ChatDlg::optionsUpdate()
 {
     setLooks();
     setShortcuts();
+#ifdef WEBKIT
+    chatView()->setHibernationEnabled(PsiOptions::instance()->getOption("options.ui.tabs.hibernate-after").toInt() > 0);
+#endif
 
     if (!isTabbed() && isHidden()) {
         deleteLater();
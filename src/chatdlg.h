@@ -115,6 +115,8 @@ protected:
     void dropEvent(QDropEvent *event) override;
     void dragEnterEvent(QDragEnterEvent *event) override;
     bool eventFilter(QObject *obj, QEvent *event) override;
+    bool hibernate() override;
+    void wakeUp() override;
     void doFileShare(const QList<Reference> &&references, const QString &desc);
 
 public slots:
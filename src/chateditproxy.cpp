@@ -33,7 +33,8 @@ ChatEditProxy::ChatEditProxy(QWidget *parent) :
     layout_->setContentsMargins(0, 0, 0, 0);
     layout_->setSpacing(0);
 
-    connect(PsiOptions::instance(), &PsiOptions::optionChanged, this, &ChatEditProxy::optionsChanged);
+    PsiOptions::instance()->subscribe(expandingLineEdit, this,
+                                      [this](const QStringList &) { optionsChanged(expandingLineEdit); });
     optionsChanged(expandingLineEdit);
 }
 
@@ -32,7 +32,8 @@
 ChatSplitter::ChatSplitter(QWidget *parent) :
     QWidget(parent), splitterEnabled_(true), splitter_(nullptr), layout_(nullptr)
 {
-    connect(PsiOptions::instance(), SIGNAL(optionChanged(const QString &)), SLOT(optionsChanged()));
+    PsiOptions::instance()->subscribe("options.ui.chat.use-expanding-line-edit", this,
+                                      [this](const QStringList &) { optionsChanged(); });
     optionsChanged();
 
     if (!layout_)
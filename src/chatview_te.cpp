@@ -29,6 +29,7 @@
 #include "psirichtext.h"
 #include "qiteaudio.h"
 #include "textutil.h"
+#include "tracer.h"
 
 #include <QKeyEvent>
 #include <QMenu>
@@ -290,6 +291,7 @@ void ChatView::appendText(const QString &text)
 
 void ChatView::dispatchMessage(const MessageView &mv)
 {
+    TRACE_SPAN("ChatView::dispatchMessage");
     const QString &replaceId = mv.replaceId();
     if ((mv.type() == MessageView::Message || mv.type() == MessageView::Subject)
         && ChatViewCommon::updateLastMsgTime(mv.dateTime()) && replaceId.isEmpty()) {
@@ -38,11 +38,13 @@
 #include "psioptions.h"
 #include "psithememanager.h"
 #include "textutil.h"
+#include "tracer.h"
 #include "webview.h"
 #include "xmpp_tasks.h"
 
 #include <QAction>
 #include <QApplication>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QFileInfo>
 #include <QJsonDocument>
@@ -52,6 +54,7 @@
 #include <QMetaProperty>
 #include <QNetworkReply>
 #include <QPalette>
+#include <QTimer>
 #include <QWidget>
 #ifdef WEBENGINE
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
@@ -69,6 +72,8 @@
 class ChatViewJSObject;
 class ChatViewThemeSessionBridge;
 
+static const QLatin1String autoCopyOption("options.ui.automatically-copy-selected-text");
+
 class ChatViewPrivate {
 public:
     ChatViewPrivate(ChatView *q) : q(q) { }
@@ -93,6 +98,13 @@ public:
     AvatarFactory::UserHashes localIcons;
     ChatViewThemeProvider    *themeProvider = nullptr;
     QString                   localNickName;
+    QElapsedTimer             openTimer; // from construction to the first session init
+    bool                      preloadedView = false;
+    QList<QVariantMap>        transcript;                // the last items sent to the page, restored after hibernation
+    int                       transcriptSize     = 0;    // 0 - hibernation is disabled
+    bool                      transcriptComplete = true; // it has every item since the first one or the last clear
+    bool                      hibernated         = false;
+    bool                      restoring          = false;
 
     static QString closeIconTags(const QString &richText)
     {
@@ -142,10 +154,71 @@ public:
 
     void sendJsObject(const QVariantMap &map)
     {
+        record(map);
+        if (hibernated)
+            return; // will be restored from the transcript
         jsBuffer_.append(map);
         checkJsBuffer();
     }
 
+    void record(const QVariantMap &map)
+    {
+        auto type = map.value(QLatin1String("type")).toString();
+        if (type == QLatin1String("clear")) {
+            transcript.clear();
+            transcriptComplete = true;
+            return;
+        }
+        // these are sent anyway when the page is loaded
+        if (type == QLatin1String("receivehooks") || type == QLatin1String("settings"))
+            return;
+        if (!transcriptSize) {
+            transcriptComplete = false; // the page has it, the transcript won't
+            return;
+        }
+        transcript.append(map);
+        while (transcript.size() > transcriptSize) {
+            transcript.removeFirst();
+            transcriptComplete = false;
+        }
+    }
+
+    void dropTranscript()
+    {
+        transcriptComplete = transcriptComplete && transcript.isEmpty();
+        transcript.clear();
+    }
+
+    void sendPluginHooks()
+    {
+#ifdef PSI_PLUGINS
+        QVariantMap m;
+        m["type"]  = "receivehooks";
+        m["hooks"] = PluginManager::instance()->messageViewJSFilters();
+        sendJsObject(m);
+#endif
+    }
+
+    // logs the size of the page. mostly to see how much hibernation saves
+    void logMemoryUsage()
+    {
+        static const QString js(
+            "(function(){return {heap: window.performance && performance.memory ? performance.memory.usedJSHeapSize "
+            ": -1, nodes: document.getElementsByTagName('*').length};})()");
+        auto report = [name = jid_.full(), items = transcript.size()](const QVariant &v) {
+            auto m = v.toMap();
+            if (m.isEmpty())
+                return;
+            qDebug("ChatView %s: hibernating. JS heap %lld KiB, %d DOM nodes, %d items to restore", qPrintable(name),
+                   m.value("heap").toLongLong() / 1024, m.value("nodes").toInt(), int(items));
+        };
+#ifdef WEBENGINE
+        webView->page()->runJavaScript(js, report);
+#else
+        report(webView->page()->mainFrame()->evaluateJavaScript(js));
+#endif
+    }
+
     void checkJsBuffer();
 
     void sendReactionsToUI(const QString &nick, const QString &messageId, const QSet<QString> &reactions)
@@ -498,16 +571,109 @@ protected:
 
 #endif
 
+//----------------------------------------------------------------------------
+// ChatViewPool
+// Web views created in advance. Creating a web engine view and starting its
+// render process takes most of the time of opening a chat, while neither
+// depends on the chat or the theme, so it's done when nothing else happens.
+// The theme itself is loaded per session since it's rendered with the session
+// properties (jid, nick, avatars) and can't be rebound to another one.
+//----------------------------------------------------------------------------
+class ChatViewPool : public QObject {
+public:
+    static ChatViewPool *instance()
+    {
+        if (!instance_)
+            instance_ = new ChatViewPool();
+        return instance_;
+    }
+
+    static WebView *createView(QWidget *parent)
+    {
+        auto view = new WebView(parent);
+        view->setFocusPolicy(Qt::NoFocus);
+        view->setPage(new ChatViewPage(view));
+        view->connectPageActions();
+        return view;
+    }
+
+    // returns nullptr if there is nothing ready
+    WebView *take(QWidget *parent)
+    {
+        WebView *view = nullptr;
+        while (!view && !views_.isEmpty())
+            view = views_.takeFirst();
+        if (view)
+            view->setParent(parent);
+        refillTimer_.start();
+        return view;
+    }
+
+    void fill()
+    {
+        if (released_)
+            return;
+        int size = PsiOptions::instance()->getOption("options.ui.chat.preloaded-views").toInt();
+        views_.removeAll(nullptr);
+        if (views_.size() >= size)
+            return;
+
+        QElapsedTimer timer;
+        timer.start();
+        auto view = createView(holder_);
+        // starts the render process
+        view->setUrl(QUrl(QLatin1String("about:blank")));
+        connect(view, &WebView::loadFinished, this, [this, view, timer](bool) {
+            if (view->parentWidget() == holder_) // not taken yet
+                qDebug("ChatViewPool: view is preloaded in %lld ms", timer.elapsed());
+        });
+        views_.append(view);
+        if (views_.size() < size)
+            refillTimer_.start(); // one by one to not freeze the ui
+    }
+
+    void release()
+    {
+        released_ = true;
+        refillTimer_.stop();
+        views_.clear();
+        delete holder_; // with the views not taken yet
+        holder_ = nullptr;
+    }
+
+private:
+    ChatViewPool() : QObject(qApp), holder_(new QWidget)
+    {
+        // the pool itself lives until ~QCoreApplication when widgets can't be deleted anymore
+        connect(qApp, &QCoreApplication::aboutToQuit, this, &ChatViewPool::release);
+        refillTimer_.setSingleShot(true);
+        refillTimer_.setInterval(1000); // let the new chat finish its own loading first
+        connect(&refillTimer_, &QTimer::timeout, this, &ChatViewPool::fill);
+    }
+
+    ~ChatViewPool() { instance_ = nullptr; }
+
+    static ChatViewPool *instance_;
+
+    QWidget                 *holder_; // never shown
+    QList<QPointer<WebView>> views_;
+    QTimer                   refillTimer_;
+    bool                     released_ = false;
+};
+
+ChatViewPool *ChatViewPool::instance_ = nullptr;
+
 //----------------------------------------------------------------------------
 // ChatView
 //----------------------------------------------------------------------------
 ChatView::ChatView(QWidget *parent) : QFrame(parent), d(new ChatViewPrivate(this))
 {
-    d->jsObject = new ChatViewJSObject(this); /* It's a session bridge between html and c++ part */
-    d->webView  = new WebView(this);
-    d->webView->setFocusPolicy(Qt::NoFocus);
-    d->webView->setPage(new ChatViewPage(d->webView));
-    d->webView->connectPageActions();
+    d->openTimer.start();
+    d->jsObject      = new ChatViewJSObject(this); /* It's a session bridge between html and c++ part */
+    d->webView       = ChatViewPool::instance()->take(this);
+    d->preloadedView = d->webView != nullptr;
+    if (!d->webView)
+        d->webView = ChatViewPool::createView(this);
 
     d->quoteAction = new QAction(tr("Quote"), this);
     d->quoteAction->setShortcut(QKeySequence(tr("Ctrl+S")));
@@ -525,24 +691,16 @@ ChatView::ChatView(QWidget *parent) : QFrame(parent), d(new ChatViewPrivate(this
     setLooks(d->webView);
 
 #ifndef HAVE_X11 // linux has this feature built-in
-    connect(PsiOptions::instance(), SIGNAL(optionChanged(QString)),
-            SLOT(psiOptionChanged(QString)));                        // needed only for save autocopy state atm
-    psiOptionChanged("options.ui.automatically-copy-selected-text"); // init autocopy
-                                                                     // connection
+    PsiOptions::instance()->subscribe(autoCopyOption, this, [this](const QStringList &) {
+        psiOptionChanged(autoCopyOption); // needed only for save autocopy state atm
+    });
+    psiOptionChanged(autoCopyOption); // init autocopy connection
 #endif
     connect(d->jsObject, &ChatViewJSObject::inited, this, &ChatView::sessionInited);
 
+    d->sendPluginHooks();
 #ifdef PSI_PLUGINS
-    QVariantMap m;
-    m["type"]  = "receivehooks";
-    m["hooks"] = PluginManager::instance()->messageViewJSFilters();
-    d->sendJsObject(m);
-    connect(PluginManager::instance(), &PluginManager::jsFiltersUpdated, this, [this]() {
-        QVariantMap m;
-        m["type"]  = "receivehooks";
-        m["hooks"] = PluginManager::instance()->messageViewJSFilters();
-        d->sendJsObject(m);
-    });
+    connect(PluginManager::instance(), &PluginManager::jsFiltersUpdated, this, [this]() { d->sendPluginHooks(); });
 #endif
 }
 
@@ -558,9 +716,67 @@ ChatView::~ChatView()
 #endif
 }
 
+void ChatView::preloadViews() { ChatViewPool::instance()->fill(); }
+
+void ChatView::releasePreloadedViews() { ChatViewPool::instance()->release(); }
+
+void ChatView::setHibernationEnabled(bool enabled)
+{
+    d->transcriptSize
+        = enabled ? PsiOptions::instance()->getOption("options.ui.tabs.hibernated-transcript-size").toInt() : 0;
+    if (!d->transcriptSize && !d->hibernated) // otherwise it's still needed to wake up
+        d->dropTranscript();
+}
+
+bool ChatView::hibernate()
+{
+    // a page restored from a partial transcript would silently lose its beginning
+    if (!d->transcriptSize || !d->transcriptComplete || !d->sessionReady_ || d->hibernated) {
+        return false;
+    }
+    d->logMemoryUsage();
+    d->hibernated    = true;
+    d->sessionReady_ = false;
+    d->jsBuffer_.clear();
+    // give the page a moment to report its size
+    QTimer::singleShot(1000, this, [this]() {
+        if (!d->hibernated) {
+            return;
+        }
+#if defined(WEBENGINE) && QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+        // frees the page in the render process as well. loading a page makes it active again
+        if (!d->webView->isVisible()) {
+            d->webView->page()->setLifecycleState(QWebEnginePage::LifecycleState::Discarded);
+            return;
+        }
+#endif
+        d->webView->setUrl(QUrl(QLatin1String("about:blank")));
+    });
+    return true;
+}
+
+void ChatView::wakeUp()
+{
+    if (!d->hibernated) {
+        return;
+    }
+    d->hibernated = false;
+    d->restoring  = true;
+    d->openTimer.start();
+    d->jsBuffer_.clear();
+    d->sendPluginHooks();
+    d->jsBuffer_.append(d->transcript);
+    if (!d->transcriptSize)
+        d->dropTranscript();
+    init();
+}
+
 // something after we know isMuc and dialog is set. kind of final step
 void ChatView::init()
 {
+    if (d->hibernated) {
+        return; // the current theme will be loaded on wake up
+    }
     Theme curTheme = d->themeProvider->current();
     // qDebug() << "Init chatview with theme" << curTheme.name();
     if (curTheme.state() != Theme::State::Loaded) {
@@ -654,8 +870,8 @@ void ChatView::changeEvent(QEvent *event)
 
 void ChatView::psiOptionChanged(const QString &option)
 {
-    if (option == "options.ui.automatically-copy-selected-text") {
-        if (PsiOptions::instance()->getOption("options.ui.automatically-copy-selected-text").toBool()) {
+    if (option == autoCopyOption) {
+        if (PsiOptions::instance()->getOption(autoCopyOption).toBool()) {
             connect(d->webView->page(), SIGNAL(selectionChanged()), d->webView, SLOT(copySelected()));
         } else {
             disconnect(d->webView->page(), SIGNAL(selectionChanged()), d->webView, SLOT(copySelected()));
@@ -665,7 +881,14 @@ void ChatView::psiOptionChanged(const QString &option)
 
 void ChatView::sessionInited()
 {
-    qDebug("Session is initialized");
+    if (d->openTimer.isValid()) {
+        qDebug("Session is initialized in %lld ms (%s view)", d->openTimer.elapsed(),
+               d->restoring ? "restored" : (d->preloadedView ? "preloaded" : "new"));
+        d->openTimer.invalidate();
+        d->restoring = false;
+    } else {
+        qDebug("Session is initialized");
+    }
     d->sessionReady_ = true;
     d->checkJsBuffer();
 }
@@ -687,6 +910,7 @@ bool ChatView::handleCopyEvent(QObject *object, QEvent *event, ChatEdit *chatEdi
 // input point of all messages
 void ChatView::dispatchMessage(const MessageView &mv)
 {
+    TRACE_SPAN("ChatView::dispatchMessage");
     static QHash<MessageView::Type, QString> types;
     if (types.isEmpty()) {
         types.insert(MessageView::Message, "message");
@@ -714,6 +938,13 @@ void ChatView::dispatchMessage(const MessageView &mv)
         m["id"]      = mv.messageId();
         if (d->isMuc_) { // maybe w/o conditions ?
             m["alert"] = mv.isAlert();
+            if (!mv.highlights().isEmpty()) {
+                // [start, length] pairs in the plain text body. themes may use them to mark the matched words
+                QVariantList hl;
+                for (auto const &span : mv.highlights())
+                    hl.append(QVariant(QVariantList { span.start, span.length }));
+                m["highlights"] = hl;
+            }
         } else {
             m["awaitingReceipt"] = mv.isAwaitingReceipt();
         }
@@ -47,6 +47,19 @@ public:
 
     void markReceived(QString id);
 
+    // starts creating web views for the next chats in background
+    static void preloadViews();
+    // has to be called before the web engine profile is gone
+    static void releasePreloadedViews();
+
+    // keeps the last items sent to the page so they can be restored after hibernation. off by default
+    void setHibernationEnabled(bool enabled);
+    // unloads the theme page keeping the session. returns false if the view can't be restored later,
+    // e.g. when it shows more than the transcript has
+    bool hibernate();
+    // reloads the theme page and restores the items of the chat
+    void wakeUp();
+
     // reimplemented
     QSize sizeHint() const;
 
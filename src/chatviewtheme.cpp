@@ -259,16 +259,18 @@ bool ChatViewThemePrivate::applyToSession(ChatViewThemeSession *session)
         if (!weakSession) {
             return false;
         }
-        bool handled
-            = session->getContents(req->url(), [res](bool success, const QByteArray &data, const QByteArray &ctype) {
-                  if (success) {
-                      res->setStatusCode(qhttp::ESTATUS_OK);
-                      res->headers().insert("Content-Type", ctype);
-                  } else {
-                      res->setStatusCode(qhttp::ESTATUS_NOT_FOUND);
-                  }
-                  res->end(data);
-              });
+        // bob urls are made of the content hash
+        auto policy  = req->url().path().startsWith(QLatin1String("/psibob/")) ? WebServer::Immutable
+                                                                               : WebServer::Revalidate;
+        bool handled = session->getContents(
+            req->url(), [req, res, policy](bool success, const QByteArray &data, const QByteArray &ctype) {
+                if (success) {
+                    WebServer::sendAsset(req, res, WebAssetCache::makeAsset(data, ctype), policy);
+                } else {
+                    res->setStatusCode(qhttp::ESTATUS_NOT_FOUND);
+                    res->end(data);
+                }
+            });
         if (handled) {
             return true;
         }
@@ -311,9 +313,17 @@ bool ChatViewThemePrivate::applyToSession(ChatViewThemeSession *session)
             }
             return true;
         } else {
-            bool       loaded;
-            QByteArray data = loadData(httpRelPath + path, &loaded);
-            if (loaded) {
+            // all the tabs with this theme share the same files, so read them just once
+            QString cacheKey = id + QLatin1Char(':') + httpRelPath + path;
+            auto   &cache    = ChatViewCon::instance()->assetCache();
+            auto    asset    = cache.find(cacheKey);
+            if (asset.isNull()) {
+                bool       loaded;
+                QByteArray data = loadData(httpRelPath + path, &loaded);
+                if (!loaded) {
+                    return false;
+                }
+                auto ctype = WebAssetCache::contentType(path);
                 if (!data.isNull() && path.endsWith(QLatin1String(".tiff"))) {
                     // seems like we are loading tiff image which is supported by safari only.
                     // let's convert it
@@ -323,16 +333,14 @@ bool ChatViewThemePrivate::applyToSession(ChatViewThemeSession *session)
                     buffer.open(QIODevice::WriteOnly);
                     image.save(&buffer, "PNG");
                     if (!ba.isNull()) {
-                        data = ba;
+                        data  = ba;
+                        ctype = "image/png";
                     }
                 }
-                if (path.endsWith(QLatin1String(".css"))) {
-                    res->headers().insert("Content-Type", "text/css;charset=utf-8");
-                }
-                res->setStatusCode(qhttp::ESTATUS_OK);
-                res->end(data);
-                return true;
+                asset = cache.insert(cacheKey, data, ctype);
             }
+            WebServer::sendAsset(req, res, asset);
+            return true;
         }
         return false;
     };
@@ -362,11 +370,22 @@ bool ChatViewThemePrivate::applyToSession(ChatViewThemeSession *session)
     session->sessId = nam->registerSessionHandler(
         [session](const QNetworkRequest &req, QByteArray &data, QByteArray &mime) {
             Q_UNUSED(mime)
-            data = session->theme.loadData(session->theme.priv<ChatViewThemePrivate>()->httpRelPath + req.url().path());
-            if (!data.isNull()) {
+            // all the tabs with this theme share the same files, so read them just once
+            QString fileName = session->theme.priv<ChatViewThemePrivate>()->httpRelPath + req.url().path();
+            QString cacheKey = session->theme.id() + QLatin1Char(':') + fileName;
+            auto   &cache    = ChatViewCon::instance()->assetCache();
+            auto    asset    = cache.find(cacheKey);
+            if (asset.isNull()) {
+                data = session->theme.loadData(fileName);
+                if (data.isNull()) {
+                    return false;
+                }
+                cache.insert(cacheKey, data, QByteArray());
                 return true;
             }
-            return false;
+            bool deflated;
+            data = asset.body(false, &deflated);
+            return true;
         });
 
     QString html;
@@ -595,7 +614,13 @@ ChatViewThemeJSUtil::ChatViewThemeJSUtil(ChatViewThemePrivate *theme, QObject *p
     optChangeTimer.setSingleShot(true);
     optChangeTimer.setInterval(0);
     connect(&optChangeTimer, SIGNAL(timeout()), SLOT(sendOptionsChanges()));
-    connect(PsiOptions::instance(), SIGNAL(optionChanged(const QString &)), SLOT(optionsChanged(const QString &)));
+    // themes render with the chat and look options only
+    for (const char *prefix : { "options.ui.chat", "options.ui.look" }) {
+        PsiOptions::instance()->subscribe(prefix, this, [this](const QStringList &changed) {
+            for (const QString &option : changed)
+                optionsChanged(option);
+        });
+    }
 }
 
 void ChatViewThemeJSUtil::sendOptionsChanges()
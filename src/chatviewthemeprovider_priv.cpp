@@ -75,23 +75,20 @@ ChatViewCon::ChatViewCon(PsiCon *pc) : QObject(pc), pc(pc)
         QString fn = req->url().path().mid(sizeof("/psi/themes"));
         fn.replace("..", ""); // a little security
         fn = PsiThemeProvider::themePath(fn);
+        if (fn.isEmpty()) {
+            return false;
+        }
 
-        if (!fn.isEmpty()) {
+        auto asset = assetCache_.find(fn);
+        if (asset.isNull()) {
             QFile f(fn);
-            if (f.open(QIODevice::ReadOnly)) {
-                res->setStatusCode(qhttp::ESTATUS_OK);
-                if (fn.endsWith(QLatin1String(".js"))) {
-                    res->headers().insert("Content-Type", "application/javascript;charset=utf-8");
-                }
-                if (fn.endsWith(QLatin1String(".css"))) {
-                    res->headers().insert("Content-Type", "text/css;charset=utf-8");
-                }
-                res->end(f.readAll());
-                f.close();
-                return true;
+            if (!f.open(QIODevice::ReadOnly)) {
+                return false;
             }
+            asset = assetCache_.insert(fn, f.readAll(), WebAssetCache::contentType(fn));
         }
-        return false;
+        WebServer::sendAsset(req, res, asset);
+        return true;
     };
 
     WebServer::Handler iconsHandler = [&](qhttp::server::QHttpRequest *req, qhttp::server::QHttpResponse *res) -> bool {
@@ -99,7 +96,15 @@ ChatViewCon::ChatViewCon(PsiCon *pc) : QObject(pc), pc(pc)
         auto    icon = IconsetFactory::iconPtr(name);
 
         if (icon) {
-            auto ba = icon->raw();
+            auto ba   = icon->raw();
+            auto etag = WebAssetCache::etag(ba);
+            res->addHeader("Cache-Control", "no-cache");
+            res->addHeader("ETag", etag);
+            if (WebAssetCache::etagMatches(req->headers().value("if-none-match"), etag)) {
+                res->setStatusCode(qhttp::ESTATUS_NOT_MODIFIED);
+                res->end();
+                return true;
+            }
             res->addHeader("Content-Type", icon->mimeType().toLatin1());
             res->addHeader("Content-Length", QByteArray::number(ba.size()));
             if (ba.size() > 1 && std::uint8_t(ba.at(0)) == 0x1f && std::uint8_t(ba.at(1)) == 0x8b) {
@@ -117,22 +122,25 @@ ChatViewCon::ChatViewCon(PsiCon *pc) : QObject(pc), pc(pc)
         QString    hash = req->url().path().mid(sizeof("/psi/avatar")); // no / because of null pointer
         QByteArray ba;
         if (hash == QLatin1String("default.png")) {
-            QPixmap p;
-            QBuffer buffer(&ba);
-            buffer.open(QIODevice::WriteOnly);
-            p = IconsetFactory::icon("psi/default_avatar").pixmap();
-            if (p.save(&buffer, "PNG")) {
-                res->setStatusCode(qhttp::ESTATUS_OK);
-                res->headers().insert("Content-Type", "image/png");
-                res->end(ba);
-                return true;
+            auto asset = assetCache_.find(hash);
+            if (asset.isNull()) {
+                QPixmap p;
+                QBuffer buffer(&ba);
+                buffer.open(QIODevice::WriteOnly);
+                p = IconsetFactory::icon("psi/default_avatar").pixmap();
+                if (!p.save(&buffer, "PNG")) {
+                    return false;
+                }
+                asset = assetCache_.insert(hash, ba, "image/png");
             }
+            WebServer::sendAsset(req, res, asset);
+            return true;
         } else {
             AvatarFactory::AvatarData ad = AvatarFactory::avatarDataByHash(QByteArray::fromHex(hash.toLatin1()));
             if (!ad.data.isEmpty()) {
-                res->setStatusCode(qhttp::ESTATUS_OK);
-                res->headers().insert("Content-Type", ad.metaType.toLatin1());
-                res->end(ad.data);
+                // the url is the hash of the avatar, so it never changes
+                WebServer::sendAsset(req, res, WebAssetCache::makeAsset(ad.data, ad.metaType.toLatin1()),
+                                     WebServer::Immutable);
                 return true;
             }
         }
@@ -20,6 +20,7 @@
 #ifndef CHATVIEWTHEMEPROVIDER_PRIV_H
 #define CHATVIEWTHEMEPROVIDER_PRIV_H
 
+#include "webassetcache.h"
 #ifdef WEBENGINE
 #include "webserver.h"
 #include <QMap>
@@ -44,7 +45,8 @@ public:
 class ChatViewCon : public QObject {
     Q_OBJECT
 
-    PsiCon *pc;
+    PsiCon       *pc;
+    WebAssetCache assetCache_;
 #ifdef WEBENGINE
     QMap<QString, WebServer::Handler> sessionHandlers;
     int                               handlerSeed = 0;
@@ -60,6 +62,9 @@ public:
     void    unregisterSessionHandler(const QString &path);
     QUrl    serverUrl() const;
 #endif
+    // theme files and other static resources shared by all chat views
+    inline WebAssetCache &assetCache() { return assetCache_; }
+
     static ChatViewCon *instance();
     static void         init(PsiCon *pc);
     static bool         isReady();
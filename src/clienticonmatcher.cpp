@@ -0,0 +1,218 @@
+/*
+ * clienticonmatcher.cpp - client icon lookup by caps node or client name
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "clienticonmatcher.h"
+
+#include <QVarLengthArray>
+#include <algorithm>
+
+/*
+ * Client icon search.
+ * <left part of caps/clientName> =>  <list of icons with caps/clientName clarifications>
+ *
+ * Example:
+ * client_icons.txt contents:
+ *   psi-plus psi+,psi#fork#plus
+ *   psi-ny psi#ny
+ *
+ * The first column is an icon name in the iconpack and the remaining is a set of caps/clientName search spec.
+ * This mean for clients with caps node or client name (i.e. taken from disco#info or other sources) starting
+ * with: `psi+` and also for nodes/names starting with `psi` and having words "fork" and "plus" somewhere inside,
+ * "psi-plus" icons will be used. For psi-ny (New Year edition) icon caps/client-name whould start with "psi"
+ * and have "ny" somewhere in the middle.
+ *
+ * === How to add new icons ===
+ * In general you are gonna need to discover the client name and update one of iconpacks.
+ *
+ * To discover the client do next:
+ * 1. Find any alive contact using interested you client
+ * 2. Open XMPP Console and insert the current JID together with its current online resource into the filter line
+ * 3. Press Dump Ringbuf to see some stanzas.
+ * 4. Find <presence....> stanza and remember "ver" attribute from <c> element
+ * 5. Open caps.xml file (~/.cache/psi/caps.xml, "C:/Users/<USER>/AppData/Local/psi/cache") and search for
+ *    value of `ver`.
+ * 6. You should see a line like <identity name="TheClientName 1.0 O_o" category="client" ...>
+ * 7. You can take the most important unique part of "TheClientName 1.0 O_o" from the beginning (e.g. TheClient)
+ * 8. Come up with an icon name in lower case (e.g. "theclient")
+ * 9. Add a line to client_icons.txt with the format described above, all in lower case.
+ *    "theclient theclient"
+ * 10. If it conflicts with anything else try to add something unique from its name/node to the client lookup spec.
+ *     "theclient theclient#O_o"
+ * 11. Next you need to update an iconpack. We have at least two iconpacks for icons. One comes in this repo and
+ *     it's quite minimal just co cover popular clients. And there is also a larger iconpack in resources repo.
+ *     Choose one wisely and and the new "theclient" icon there.
+ *
+ *
+ * The descriptors are compiled into a prefix trie. Every trie node where some caps/client name spec ends
+ * keeps a list of icons with clarifications, the ones having more clarifications go first:
+ *
+ *   "psi"  => [
+ *                {"psi-plus",["fork", "plus"]}
+ *                {"psi-ny",["ny"]}
+ *             ]
+ *   "psi+" => [{"psi-plus",[]}]
+ *
+ * Where psi/psi+        - caps/client name (or its beginning) as it comes from client_icons.txt.
+ *       psi-plus/psi-ny - icon name
+ *       fork/plus/ny    - parts of caps/client name
+ *
+ * Now for example we need to lookup icon for caps node "psiplus.com". Walking the trie we collect all the nodes
+ * matching the beginning of the name. There is just "psi" (psi+ won't match because psiplus.com doesn't start
+ * with psi+). Both items in "psi" have clarification list and all the clarifications of an item have to be found
+ * after the matched beginning. Neither ["fork", "plus"] nor ["ny"] are all in "psiplus.com", so nothing is found.
+ * But "psi-fork-plus" would give "psi-plus" icon. If nothing matched on the longest beginning, shorter ones are
+ * tried as well.
+ *
+ * Note: It's quite regular for caps node to start with "https" but current client_icons.txt almost never have
+ * such records. It just means it relies heavily on discovered client names instead of caps nodes.
+ * Client name from its side may be taken from caps node when there is no other way to detect.
+ * Example:
+ * caps node = https://www.psi-im.org/helloworld/caps
+ * resulting client name = psi-im.org/helloworld
+ */
+
+static const int maxCacheSize = 4096; // just a safety net. usually there are less than a hundred distinct names
+
+int ClientIconMatcher::addNode()
+{
+    nodes_.append(Node());
+    return nodes_.size() - 1;
+}
+
+void ClientIconMatcher::addDescriptions(const QStringList &lines, const QSet<QString> &knownIcons)
+{
+    if (nodes_.isEmpty()) {
+        addNode(); // root
+    }
+    cache_.clear();
+
+    QVector<int> touched;
+    /* file format: <icon res name> <left_part_of_cap1#inside1#inside2>,<left_part_of_cap2>
+        next line the same.
+    */
+    for (const auto &line : lines) {
+        QString iconName = line.trimmed().section(QLatin1Char(' '), 0, 0);
+        if (iconName.isEmpty() || !knownIcons.contains(iconName)) {
+            continue;
+        }
+        QString caps = line.mid(iconName.length());
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+        const auto &cList = caps.split(QLatin1Char(','), Qt::SkipEmptyParts);
+#else
+        const auto &cList = caps.split(QLatin1Char(','), QString::SkipEmptyParts);
+#endif
+        for (const QString &c : cList) {
+            QString ct = c.trimmed();
+            if (ct.isEmpty()) {
+                continue;
+            }
+            QStringList spec = ct.split('#');
+            Check       check;
+            check.icon = iconName;
+            for (int i = 1; i < spec.size(); i++) {
+                check.inside.append(QStringMatcher(spec[i]));
+            }
+
+            int node = 0;
+            for (const QChar ch : std::as_const(spec[0])) {
+                auto it = nodes_[node].children.constFind(ch);
+                if (it == nodes_[node].children.constEnd()) {
+                    int child = addNode();
+                    nodes_[node].children.insert(ch, child);
+                    node = child;
+                } else {
+                    node = it.value();
+                }
+            }
+            if (nodes_[node].checks == -1) {
+                nodes_[node].checks = checks_.size();
+                checks_.append(QVector<Check>());
+            }
+            checks_[nodes_[node].checks].append(check);
+            touched.append(nodes_[node].checks);
+        }
+    }
+
+    // keep elements with a lot of # first. stable, so equal ones are checked in the file order
+    for (int idx : std::as_const(touched)) {
+        auto &checkList = checks_[idx];
+        std::stable_sort(checkList.begin(), checkList.end(),
+                         [](const auto &a, const auto &b) { return a.inside.size() > b.inside.size(); });
+    }
+}
+
+void ClientIconMatcher::clear()
+{
+    nodes_.clear();
+    checks_.clear();
+    cache_.clear();
+}
+
+bool ClientIconMatcher::isEmpty() const { return checks_.isEmpty(); }
+
+QString ClientIconMatcher::match(const QString &name) const
+{
+    if (checks_.isEmpty()) {
+        return QString();
+    }
+
+    // ends of all the specs matching the beginning of the name: <checks index, spec length>
+    QVarLengthArray<std::pair<int, int>, 8> candidates;
+    int                                     node = 0;
+    if (nodes_[node].checks != -1) {
+        candidates.append({ nodes_[node].checks, 0 });
+    }
+    for (int i = 0; i < name.size(); i++) {
+        auto it = nodes_[node].children.constFind(name[i]);
+        if (it == nodes_[node].children.constEnd()) {
+            break;
+        }
+        node = it.value();
+        if (nodes_[node].checks != -1) {
+            candidates.append({ nodes_[node].checks, i + 1 });
+        }
+    }
+
+    // the longest one is the most specific one
+    for (auto c = candidates.crbegin(); c != candidates.crend(); ++c) {
+        for (const Check &check : checks_[c->first]) {
+            bool matched = std::all_of(check.inside.begin(), check.inside.end(), [&](const QStringMatcher &m) {
+                return m.indexIn(name, c->second) != -1;
+            });
+            if (matched) {
+                return check.icon;
+            }
+        }
+    }
+    return QString();
+}
+
+QString ClientIconMatcher::cachedMatch(const QString &name)
+{
+    auto it = cache_.constFind(name);
+    if (it != cache_.constEnd()) {
+        return it.value();
+    }
+    if (cache_.size() >= maxCacheSize) {
+        cache_.clear();
+    }
+    QString icon = match(name);
+    cache_.insert(name, icon);
+    return icon;
+}
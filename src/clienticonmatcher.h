@@ -0,0 +1,59 @@
+/*
+ * clienticonmatcher.h - client icon lookup by caps node or client name
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef CLIENTICONMATCHER_H
+#define CLIENTICONMATCHER_H
+
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QStringMatcher>
+#include <QVector>
+
+class ClientIconMatcher {
+public:
+    // Adds client_icons.txt lines. Only icons the iconset has (knownIcons) are taken.
+    void addDescriptions(const QStringList &lines, const QSet<QString> &knownIcons);
+    void clear();
+    bool isEmpty() const;
+
+    // returns icon name (w/o "clients/" part) or null string if nothing matched
+    QString match(const QString &name) const;
+    // the same as match() but remembers results. there are just a few distinct nodes
+    QString cachedMatch(const QString &name);
+
+private:
+    struct Check {
+        QString                 icon;   // icon name w/o client/ part
+        QVector<QStringMatcher> inside; // search for texts inside provided name to be sure
+    };
+
+    struct Node {
+        QHash<QChar, int> children;
+        int               checks = -1; // index in checks_ if some descriptor ends here
+    };
+
+    int addNode();
+
+    QVector<Node>           nodes_;
+    QVector<QVector<Check>> checks_;
+    QHash<QString, QString> cache_;
+};
+
+#endif // CLIENTICONMATCHER_H
@@ -25,7 +25,10 @@
 
 ColorOpt::ColorOpt() : QObject(nullptr)
 {
-    connect(PsiOptions::instance(), SIGNAL(optionChanged(const QString &)), SLOT(optionChanged(const QString &)));
+    PsiOptions::instance()->subscribe("options.ui.look.colors", this, [this](const QStringList &changed) {
+        for (const QString &opt : changed)
+            optionChanged(opt);
+    });
     connect(PsiOptions::instance(), SIGNAL(destroyed()), SLOT(reset()));
 
     typedef struct {
@@ -33,7 +33,7 @@
 ContactListItem::ContactListItem(ContactListModel *model, Type type, SpecialGroupType specialGropType) :
     AbstractTreeItem(), _model(model), _type(type), _specialGroupType(specialGropType), _editing(false),
     _selfValid(true), _contact(nullptr), _account(nullptr), _expanded(true), _internalName(), _displayName(),
-    _totalContacts(0), _onlineContacts(0), _shouldBeVisible(type != Type::GroupType), _hidden(false)
+    _totalContacts(0), _onlineContacts(0), _visibleContacts(0), _hidden(false)
 {
     switch (_specialGroupType) {
     case SpecialGroupType::GeneralSpecialGroupType:
@@ -261,7 +261,7 @@ PsiAccount *ContactListItem::account() const
     return item->_account;
 }
 
-bool ContactListItem::shouldBeVisible() const { return _shouldBeVisible; }
+bool ContactListItem::shouldBeVisible() const { return _type != Type::GroupType || _visibleContacts > 0; }
 
 void ContactListItem::setHidden(bool hidden, bool notifyModel)
 {
@@ -533,17 +533,14 @@ QVariant ContactListItem::value(int role) const
             } break;
 
             case ContactListModel::DisplayGroupRole:
-                updateContactsCount();
                 res = name() + QString(" (%1/%2)").arg(_onlineContacts).arg(_totalContacts);
                 break;
 
             case ContactListModel::OnlineContactsRole:
-                updateContactsCount();
                 res = _onlineContacts;
                 break;
 
             case ContactListModel::TotalContactsRole:
-                updateContactsCount();
                 res = _totalContacts;
                 break;
 
@@ -562,38 +559,64 @@ QVariant ContactListItem::value(int role) const
     return res;
 }
 
-void ContactListItem::updateContactsCount() const
+void ContactListItem::updateCounters(bool attached)
 {
-    if (_type != Type::GroupType)
+    if (_type != Type::ContactType)
         return;
 
-    _totalContacts   = 0;
-    _onlineContacts  = 0;
-    _shouldBeVisible = false;
+    int total   = attached ? 1 : 0;
+    int online  = attached && _contact->isOnline() ? 1 : 0;
+    int visible = attached && (_contact->alerting() || _contact->isAlwaysVisible()) ? 1 : 0;
+
+    int totalDelta   = total - _totalContacts;
+    int onlineDelta  = online - _onlineContacts;
+    int visibleDelta = visible - _visibleContacts;
+    if (!totalDelta && !onlineDelta && !visibleDelta)
+        return;
+
+    _totalContacts   = total;
+    _onlineContacts  = online;
+    _visibleContacts = visible;
+    for (auto group = parent(); group && group->_type == Type::GroupType; group = group->parent()) {
+        group->_totalContacts += totalDelta;
+        group->_onlineContacts += onlineDelta;
+        group->_visibleContacts += visibleDelta;
+    }
+}
+
+#ifndef NDEBUG
+void ContactListItem::checkCounters() const
+{
+    int total   = 0;
+    int online  = 0;
+    int visible = 0;
 
     AbstractTreeItemList children = AbstractTreeItem::children();
     for (const auto &child : std::as_const(children)) {
         ContactListItem *item = static_cast<ContactListItem *>(child);
         if (item->_type == Type::ContactType) {
-            _totalContacts++;
-            if (item->_contact->alerting() || item->_contact->isAlwaysVisible()) {
-
-                _shouldBeVisible = true;
-            }
-
-            if (item->_contact->isOnline()) {
-                _onlineContacts++;
-            }
-        } else if (item->_type == Type::GroupType) {
-            item->updateContactsCount();
-            if (item->shouldBeVisible()) {
-                _shouldBeVisible = true;
+            total++;
+            if (item->_contact->isOnline())
+                online++;
+            if (item->_contact->alerting() || item->_contact->isAlwaysVisible())
+                visible++;
+        } else {
+            item->checkCounters();
+            if (item->_type == Type::GroupType) {
+                total += item->_totalContacts;
+                online += item->_onlineContacts;
+                visible += item->_visibleContacts;
             }
-            _totalContacts += item->_totalContacts;
-            _onlineContacts += item->_onlineContacts;
         }
     }
+
+    if (_type == Type::GroupType
+        && (total != _totalContacts || online != _onlineContacts || visible != _visibleContacts)) {
+        qWarning("contact list group \"%s\" counters are out of sync: %d/%d/%d instead of %d/%d/%d",
+                 qUtf8Printable(name()), _onlineContacts, _totalContacts, _visibleContacts, online, total, visible);
+    }
 }
+#endif
 
 QList<ContactListItem *> ContactListItem::allChildren() const
 {
@@ -104,7 +104,13 @@ public:
     void     setValue(int role, const QVariant &value);
     QVariant value(int role) const;
 
-    void updateContactsCount() const;
+    // Contact items only. Brings the online/total/visible counters of the parent groups in line with the contact
+    // state in O(1) per group. With attached=false the contact is removed from the counters.
+    void updateCounters(bool attached = true);
+#ifndef NDEBUG
+    // recounts all the groups in the subtree from scratch and warns if maintained counters differ
+    void checkCounters() const;
+#endif
 
     QList<ContactListItem *> allChildren() const;
 
@@ -126,9 +132,9 @@ private:
     bool                 _expanded;
     QString              _internalName;
     QString              _displayName;
-    mutable int          _totalContacts;
-    mutable int          _onlineContacts;
-    mutable bool         _shouldBeVisible;
+    int                  _totalContacts;   // for a contact item it's what the contact adds to its groups
+    int                  _onlineContacts;  // ditto
+    int                  _visibleContacts; // alerting or always visible
     bool                 _hidden;
 };
 
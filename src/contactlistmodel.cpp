@@ -109,6 +109,7 @@ void ContactListModel::Private::realAddContact(PsiContact *contact)
                 groupItem->setHidden(hidden.contains(groupItem->internalName()), false);
             }
             groupItem->appendChild(item);
+            item->updateCounters();
 
             monitoredContacts.insert(contact, q->toModelIndex(item));
         }
@@ -116,6 +117,7 @@ void ContactListModel::Private::realAddContact(PsiContact *contact)
         ContactListItem *item = new ContactListItem(q, ContactListItem::Type::ContactType);
         item->setContact(contact);
         root->appendChild(item);
+        item->updateCounters();
         monitoredContacts.insert(contact, q->toModelIndex(item));
     }
 
@@ -155,6 +157,8 @@ void ContactListModel::Private::updateContacts(const QList<PsiContact *> &contac
         indexes += indexes2;
 
         for (const QModelIndex &index : std::as_const(indexes2)) {
+            q->toItem(index)->updateCounters();
+
             QModelIndex parent = index.parent();
             int         row    = index.row();
             if (ranges.contains(parent)) {
@@ -238,6 +242,7 @@ void ContactListModel::Private::commit()
     commitTimer->stop();
     if (operationQueue.isEmpty())
         return;
+    TRACE_COUNTER("roster operations", operationQueue.size());
 
     QHashIterator<PsiContact *, int> it(operationQueue);
 
@@ -271,6 +276,10 @@ void ContactListModel::Private::commit()
     addContacts(contactsForAdding);
     updateContacts(contactsForUpdate);
     operationQueue.clear();
+
+#ifndef NDEBUG
+    static_cast<ContactListItem *>(q->root())->checkCounters();
+#endif
 }
 
 void ContactListModel::Private::clear()
@@ -336,6 +345,7 @@ void ContactListModel::Private::removeContact(PsiContact *contact)
         ContactListItem *item  = q->toItem(index);
         ContactListItem *group = item->parent();
 
+        item->updateCounters(false);
         delete item;
         q->endRemoveRows();
 
@@ -127,7 +127,13 @@ ContactListViewDelegate::Private::Private(ContactListViewDelegate *parent, Conta
     animTimer->setSingleShot(false);
     connect(animTimer, SIGNAL(timeout()), SLOT(updateAnim()));
 
-    connect(PsiOptions::instance(), SIGNAL(optionChanged(const QString &)), SLOT(optionChanged(const QString &)));
+    for (const QString &prefix : { QStringLiteral("options.ui.contactlist"), contactListFontOptionPath,
+                                   QStringLiteral("options.ui.look.contactlist"), contactListBackgroundOptionPath }) {
+        PsiOptions::instance()->subscribe(prefix, this, [this](const QStringList &changed) {
+            for (const QString &option : changed)
+                optionChanged(option);
+        });
+    }
     connect(ColorOpt::instance(), SIGNAL(changed(const QString &)), SLOT(colorOptionChanged(const QString &)));
     connect(PsiIconset::instance(), SIGNAL(rosterIconsSizeChanged(int)), SLOT(rosterIconsSizeChanged(int)));
 
@@ -22,8 +22,8 @@
 #include <QDir>
 #include <psi_config.h>
 
-SlowTimer::SlowTimer(const QString &path, int line, int maxTime, const QString &message) :
-    _path(QDir::fromNativeSeparators(path)), _line(line), _message(message), _maxTime(maxTime)
+SlowTimer::SlowTimer(const char *function, const QString &path, int line, int maxTime, const QString &message) :
+    _span(function), _path(QDir::fromNativeSeparators(path)), _line(line), _message(message), _maxTime(maxTime)
 {
     _timer.start();
 }
@@ -19,6 +19,8 @@
 
 #pragma once
 
+#include "tracer.h"
+
 #include <QDebug>
 #include <QElapsedTimer>
 
@@ -34,18 +36,24 @@
 #define CL_WARNING() qWarning().noquote() << "[cl]"
 #define CL_FATAL() QDebug(QtMsgType::QtFatalMsg).noquote() << "[cl]"
 
+// iconsets
+#define ICONSET_DEBUG() qDebug().noquote() << "[iconset]"
+
 // Common
 #define DEBUG() qDebug().noquote()
 #define CRITICAL() qCritical().noquote()
 #define WARNING() qWarning().noquote()
 #define FATAL() QDebug(QtMsgType::QtFatalMsg).noquote()
 
+// Also records a trace span named after the function when the Tracer is on
 class SlowTimer {
 public:
-    SlowTimer(const QString &path, int line, int maxTime = 0, const QString &message = QString());
+    SlowTimer(const char *function, const QString &path, int line, int maxTime = 0,
+              const QString &message = QString());
     ~SlowTimer();
 
 private:
+    TraceSpan     _span;
     QElapsedTimer _timer;
     QString       _path;
     int           _line;
@@ -53,4 +61,4 @@ private:
     int           _maxTime;
 };
 
-#define SLOW_TIMER(...) SlowTimer slowTimer(__FILE__, __LINE__, __VA_ARGS__)
+#define SLOW_TIMER(...) SlowTimer slowTimer(Q_FUNC_INFO, __FILE__, __LINE__, __VA_ARGS__)
@@ -22,7 +22,11 @@
 #include "edbsqlite.h"
 #include "historyimp.h"
 #include "jidutil.h"
+#include "psicon.h"
 #include "psicontactlist.h"
+#include "psioptions.h"
+#include "sqlitetuning.h"
+#include "tracer.h"
 
 #include <QJsonArray>
 #include <QJsonDocument>
@@ -32,6 +36,11 @@
 
 #define FAKEDELAY 0
 
+static const int maintenanceCheckInterval = 5 * 60 * 1000; // ms
+static const int maintenanceQuietSecs     = 120; // no history requests for this long
+static const int maintenanceIdleSecs      = 300; // or the user is away for this long
+static const int retentionBatch           = 5000;
+
 using namespace XMPP;
 
 //----------------------------------------------------------------------------
@@ -40,20 +49,29 @@ using namespace XMPP;
 
 EDBSqLite::EDBSqLite(PsiCon *psi) :
     EDB(psi), transactionsCounter(0), lastCommitTime(QDateTime::currentDateTime()), commitTimer(nullptr),
-    mirror_(nullptr)
+    insertMode(Normal), maintenanceTimer(nullptr), lastActivity(QDateTime::currentDateTime()), mirror_(nullptr)
 {
-    status            = NotActive;
-    QString      path = ApplicationInfo::historyDir() + "/history.db";
-    QSqlDatabase db   = QSqlDatabase::addDatabase("QSQLITE", "history");
-    db.setDatabaseName(path);
+    status          = NotActive;
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "history");
+    db.setDatabaseName(databasePath());
     if (!db.open()) {
         qWarning("%s\n%s", "EDBSqLite::EDBSqLite(): Can't open base.", qUtf8Printable(db.lastError().text()));
         return;
     }
+    PsiOptions            *o = PsiOptions::instance();
+    SqliteTuning::Settings settings;
+    settings.wal       = o->getOption("options.history.storage.wal").toBool();
+    settings.mmapSize  = o->getOption("options.history.storage.mmap-size").toInt();
+    settings.cacheSize = o->getOption("options.history.storage.cache-size").toInt();
+    const bool newDatabase = db.tables(QSql::Tables).size() == 0;
+    if (newDatabase)
+        SqliteTuning::enableIncrementalVacuum(db); // before anything is written
+    SqliteTuning::apply(db, settings);
+
     QSqlQuery query(db);
     query.exec("PRAGMA foreign_keys = ON;");
     setInsertingMode(Normal);
-    if (db.tables(QSql::Tables).size() == 0) {
+    if (newDatabase) {
         // no tables found.
         if (db.transaction()) {
             query.exec("CREATE TABLE `system` ("
@@ -122,6 +140,11 @@ bool EDBSqLite::init()
     }
 
     setMirror(new EDBFlatFile(psi()));
+
+    maintenanceTimer = new QTimer(this);
+    maintenanceTimer->setInterval(maintenanceCheckInterval);
+    connect(maintenanceTimer, &QTimer::timeout, this, &EDBSqLite::maintenance);
+    maintenanceTimer->start();
     return true;
 }
 
@@ -275,6 +298,7 @@ void EDBSqLite::setStorageParam(const QString &key, const QString &val)
 
 void EDBSqLite::setInsertingMode(InsertMode mode)
 {
+    insertMode = mode;
     // in the case of a flow of new records
     if (mode == Import) {
         // Commit after 10000 inserts and every 5 seconds
@@ -302,13 +326,19 @@ void EDBSqLite::setMirror(EDBFlatFile *mirr)
 
 EDBFlatFile *EDBSqLite::mirror() const { return mirror_; }
 
+QString EDBSqLite::databasePath() { return ApplicationInfo::historyDir() + "/history.db"; }
+
 void EDBSqLite::performRequests()
 {
     if (rlist.isEmpty())
         return;
 
+    TRACE_SPAN("EDBSqLite::performRequests");
+    TRACE_COUNTER("history queue", rlist.size());
+
     item_query_req *r    = rlist.takeFirst();
     const int       type = r->type;
+    lastActivity         = QDateTime::currentDateTime();
 
     if (type == item_query_req::Type_append) {
         bool b = appendEvent(r->accId, r->j, r->event, r->jidType);
@@ -727,6 +757,52 @@ void EDBSqLite::stopAutocommitTimer()
         commitTimer->stop();
 }
 
+void EDBSqLite::maintenance()
+{
+    if (status == NotActive || insertMode == Import || !rlist.isEmpty())
+        return;
+
+    PsiOptions *o        = PsiOptions::instance();
+    int         interval = o->getOption("options.history.storage.maintenance-interval").toInt();
+    QDateTime   now      = QDateTime::currentDateTime();
+    if (interval <= 0 || (lastMaintenance.isValid() && lastMaintenance.secsTo(now) < interval * 60))
+        return;
+    if (lastActivity.secsTo(now) < maintenanceQuietSecs && psi()->idle() < maintenanceIdleSecs)
+        return; // try again on the next check
+
+    bool more = removeExpired(Contact, o->getOption("options.history.retention.chat-days").toInt());
+    more |= removeExpired(GroupChatContact, o->getOption("options.history.retention.groupchat-days").toInt());
+    commit();
+    QSqlDatabase db = QSqlDatabase::database("history");
+    SqliteTuning::maintain(db);
+
+    // big backlogs of expired events are removed batch by batch on the following checks
+    lastMaintenance = more ? QDateTime() : now;
+}
+
+bool EDBSqLite::removeExpired(int type, int days)
+{
+    if (days <= 0 || !transaction(true))
+        return false;
+
+    QSqlQuery query(QSqlDatabase::database("history"));
+    query.prepare("DELETE FROM `events` WHERE `id` IN ("
+                  "SELECT `events`.`id` FROM `events`, `contacts`"
+                  " WHERE `contacts`.`id` = `contact_id` AND `contacts`.`type` = :type AND `date` < :date"
+                  " LIMIT :cnt);");
+    query.bindValue(":type", type);
+    query.bindValue(":date", QDateTime::currentDateTime().addDays(-days));
+    query.bindValue(":cnt", retentionBatch);
+    if (!query.exec()) {
+        qWarning("EDBSqLite::removeExpired(): %s", qUtf8Printable(query.lastError().text()));
+        rollback();
+        return false;
+    }
+    bool more = query.numRowsAffected() >= retentionBatch;
+    commit();
+    return more;
+}
+
 bool EDBSqLite::importExecute()
 {
     bool           res = true;
@@ -118,6 +118,11 @@ public:
     void         setMirror(EDBFlatFile *mirr);
     EDBFlatFile *mirror() const;
 
+    static QString databasePath();
+
+public slots:
+    bool commit();
+
 private:
     enum { NotActive, NotCommited, Commited };
     struct item_query_req {
@@ -142,6 +147,10 @@ private:
     int                     maxUncommitedSecs;
     unsigned int            commitByTimeoutSecs;
     QTimer                 *commitTimer;
+    InsertMode              insertMode;
+    QTimer                 *maintenanceTimer;
+    QDateTime               lastActivity;
+    QDateTime               lastMaintenance;
     EDBFlatFile            *mirror_;
     QList<item_query_req *> rlist;
     QHash<QString, qint64>  jidsCache;
@@ -158,10 +167,11 @@ private:
     void          startAutocommitTimer();
     void          stopAutocommitTimer();
     bool          importExecute();
+    bool          removeExpired(int type, int days);
 
 private slots:
     void performRequests();
-    bool commit();
+    void maintenance();
 };
 
 #endif // EDBSQLITE_H
@@ -0,0 +1,191 @@
+/*
+ * eventloopwatchdog.cpp - gui event loop latency monitor
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "eventloopwatchdog.h"
+
+#include "tracer.h"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QSaveFile>
+#include <QThread>
+
+#include <algorithm>
+#include <atomic>
+
+static const int heartbeatMsecs = 100;
+static const int stallMsecs     = 500;
+static const int maxStalls      = 50;
+
+static EventLoopWatchdog *instance_ = nullptr;
+
+class EventLoopWatchdog::Monitor : public QThread {
+public:
+    Monitor(EventLoopWatchdog *watchdog) : watchdog_(watchdog), guiScope_(Tracer::currentScope())
+    {
+        setObjectName("EventLoopWatchdog");
+        clock_.start();
+    }
+
+    void run() override
+    {
+        qint64 last = clock_.elapsed();
+        while (!quit_) {
+            QThread::msleep(heartbeatMsecs);
+            qint64 now = clock_.elapsed();
+            // this thread didn't run either for that long, so neither did the gui thread
+            bool suspended = now - last > heartbeatMsecs + stallMsecs;
+            last           = now;
+
+            qint64 sent = pingSent_;
+            if (sent < 0) {
+                pingSent_ = now;
+                QMetaObject::invokeMethod(
+                    watchdog_, [w = watchdog_, now]() { w->pong(now); }, Qt::QueuedConnection);
+            } else if (suspended) {
+                QMutexLocker locker(&mutex_);
+                discard_ = true;
+            } else if (now - sent >= heartbeatMsecs) {
+                const char  *scope = guiScope_.load(std::memory_order_relaxed);
+                QMutexLocker locker(&mutex_);
+                ++samples_[scope];
+            }
+        }
+    }
+
+    EventLoopWatchdog         *watchdog_;
+    std::atomic<const char *> &guiScope_;
+    QElapsedTimer              clock_;
+    std::atomic<bool>          quit_ { false };
+    std::atomic<qint64>        pingSent_ { -1 };
+    QMutex                     mutex_;
+    QHash<const char *, int>   samples_; // of the gui thread scope while the heartbeat is late
+    bool                       discard_ = false;
+};
+
+EventLoopWatchdog::EventLoopWatchdog(QObject *parent) :
+    QObject(parent), monitor_(new Monitor(this)), started_(QDateTime::currentDateTime()),
+    histogram_(bucketLimits().size() + 1)
+{
+    instance_ = this;
+    monitor_->start(QThread::LowPriority);
+}
+
+EventLoopWatchdog::~EventLoopWatchdog()
+{
+    monitor_->quit_ = true;
+    monitor_->wait();
+    delete monitor_;
+    if (instance_ == this)
+        instance_ = nullptr;
+}
+
+EventLoopWatchdog *EventLoopWatchdog::instance() { return instance_; }
+
+int EventLoopWatchdog::stallThreshold() const { return stallMsecs; }
+
+QVector<int> EventLoopWatchdog::bucketLimits() { return { 16, 33, 50, 100, 250, 500, 1000, 2500, 5000 }; }
+
+QVector<quint64> EventLoopWatchdog::histogram() const { return histogram_; }
+
+QList<EventLoopWatchdog::Stall> EventLoopWatchdog::stalls() const { return stalls_; }
+
+void EventLoopWatchdog::setReportFile(const QString &fileName) { reportFile_ = fileName; }
+
+void EventLoopWatchdog::pong(qint64 sent)
+{
+    qint64                   latency = monitor_->clock_.elapsed() - sent;
+    QHash<const char *, int> samples;
+    bool                     discard;
+    {
+        QMutexLocker locker(&monitor_->mutex_);
+        samples.swap(monitor_->samples_);
+        discard            = monitor_->discard_;
+        monitor_->discard_ = false;
+    }
+    monitor_->pingSent_ = -1;
+    if (discard)
+        return;
+
+    const auto limits = bucketLimits();
+    int        bucket = int(std::upper_bound(limits.begin(), limits.end(), latency) - limits.begin());
+    ++histogram_[bucket];
+    if (latency < stallMsecs)
+        return;
+
+    Stall stall { QDateTime::currentDateTime(), int(latency), {} };
+    for (auto it = samples.cbegin(); it != samples.cend(); ++it)
+        stall.scopes.append({ it.key() ? QString::fromUtf8(it.key()) : QString(), it.value() });
+    std::sort(stall.scopes.begin(), stall.scopes.end(),
+              [](const QPair<QString, int> &a, const QPair<QString, int> &b) { return a.second > b.second; });
+    stalls_.append(stall);
+    if (stalls_.size() > maxStalls)
+        stalls_.removeFirst();
+
+    QString where = stall.scopes.isEmpty() ? QString("unknown") : stall.scopes.first().first;
+    qWarning("[watchdog] gui thread stalled for %d ms in %s", stall.msecs,
+             qPrintable(where.isEmpty() ? QString("uninstrumented code") : where));
+    if (!reportFile_.isEmpty())
+        dump(reportFile_);
+}
+
+QString EventLoopWatchdog::report() const
+{
+    const auto limits = bucketLimits();
+    quint64    total  = 0;
+    for (auto n : histogram_)
+        total += n;
+
+    QString ret = QString("Event loop latency since %1, %2 heartbeats\n\n")
+                      .arg(started_.toString(Qt::ISODate), QString::number(total));
+    for (int i = 0; i < histogram_.size(); ++i) {
+        QString range = i < limits.size() ? QString("< %1 ms").arg(limits[i]) : QString(">= %1 ms").arg(limits.last());
+        ret += QString("%1 %2 %3%\n")
+                   .arg(range, 12)
+                   .arg(histogram_[i], 10)
+                   .arg(total ? 100.0 * double(histogram_[i]) / double(total) : 0.0, 6, 'f', 2);
+    }
+
+    ret += QString("\nStalls of %1 ms or longer (the last %2)\n\n").arg(stallMsecs).arg(maxStalls);
+    if (stalls_.isEmpty())
+        ret += "none\n";
+    for (const auto &s : stalls_) {
+        QStringList scopes;
+        for (const auto &scope : s.scopes)
+            scopes += QString("%1 (%2)").arg(scope.first.isEmpty() ? QString("uninstrumented code") : scope.first,
+                                             QString::number(scope.second));
+        ret += QString("%1 %2 ms: %3\n")
+                   .arg(s.time.toString(Qt::ISODate))
+                   .arg(s.msecs, 6)
+                   .arg(scopes.isEmpty() ? QString("not sampled") : scopes.join(", "));
+    }
+    return ret;
+}
+
+bool EventLoopWatchdog::dump(const QString &fileName) const
+{
+    QSaveFile f(fileName);
+    if (!f.open(QIODevice::WriteOnly)) {
+        qWarning("[watchdog] failed to write %s: %s", qPrintable(fileName), qPrintable(f.errorString()));
+        return false;
+    }
+    f.write(report().toUtf8());
+    return f.commit();
+}
@@ -0,0 +1,77 @@
+/*
+ * eventloopwatchdog.h - gui event loop latency monitor
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EVENTLOOPWATCHDOG_H
+#define EVENTLOOPWATCHDOG_H
+
+#include <QDateTime>
+#include <QList>
+#include <QObject>
+#include <QPair>
+#include <QVector>
+
+/**
+ * Measures how long events wait in the gui thread's event loop.
+ *
+ * A helper thread posts a heartbeat to the gui thread and the delay until it
+ * gets handled goes to a histogram. While a heartbeat is late, the helper
+ * samples the innermost TraceSpan the gui thread is in, so a stall comes
+ * with the instrumented code it was spent in. Time the whole process didn't
+ * run (e.g. the system was asleep) is not counted.
+ */
+class EventLoopWatchdog : public QObject {
+    Q_OBJECT
+public:
+    struct Stall {
+        QDateTime                  time; // when it was over
+        int                        msecs;
+        QList<QPair<QString, int>> scopes; // scope name and number of samples, most sampled first
+    };
+
+    // must be created in the gui thread
+    explicit EventLoopWatchdog(QObject *parent = nullptr);
+    ~EventLoopWatchdog();
+
+    // the running watchdog if any
+    static EventLoopWatchdog *instance();
+
+    int stallThreshold() const;
+    // upper limits (ms) of the histogram buckets but the last one, which has no limit
+    static QVector<int> bucketLimits();
+    QVector<quint64>    histogram() const;
+    QList<Stall>        stalls() const;
+
+    // the report is written there after every stall too
+    void    setReportFile(const QString &fileName);
+    QString report() const;
+    bool    dump(const QString &fileName) const;
+
+private:
+    class Monitor;
+
+    void pong(qint64 sent);
+
+    Monitor         *monitor_;
+    QDateTime        started_;
+    QVector<quint64> histogram_;
+    QList<Stall>     stalls_;
+    QString          reportFile_;
+};
+
+#endif // EVENTLOOPWATCHDOG_H
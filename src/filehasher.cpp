@@ -0,0 +1,258 @@
+/*
+ * filehasher.cpp - background hash sums calculation for shared files
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filehasher.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTimer>
+#include <QtConcurrent>
+
+#include <memory>
+#include <vector>
+
+static const int     blockSize        = 1024 * 1024;
+static const int     progressInterval = 200; // ms
+static const int     maxCacheEntries  = 5000;
+static const quint32 cacheMagic       = 0x50534843; // PSHC
+static const quint32 cacheVersion     = 1;
+
+static QCryptographicHash::Algorithm qtAlgorithm(XMPP::Hash::Type type)
+{
+    switch (type) {
+    case XMPP::Hash::Sha256:
+        return QCryptographicHash::Sha256;
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    case XMPP::Hash::Blake2b256:
+        return QCryptographicHash::Blake2b_256;
+#endif
+    default:
+        return QCryptographicHash::Sha1;
+    }
+}
+
+FileHasher::FileHasher(const QString &cacheFileName, QObject *parent) :
+    QObject(parent), cacheFileName_(cacheFileName), saveTimer_(new QTimer(this))
+{
+    jobs_.setMaxThreadCount(2);
+    algoPool_.setMaxThreadCount(algorithms().size() * jobs_.maxThreadCount());
+
+    saveTimer_->setSingleShot(true);
+    saveTimer_->setInterval(1000);
+    connect(saveTimer_, &QTimer::timeout, this, &FileHasher::save);
+
+    load();
+}
+
+FileHasher::~FileHasher()
+{
+    shutdown_ = true;
+    jobs_.waitForDone();
+    if (saveTimer_->isActive())
+        save();
+}
+
+QList<XMPP::Hash::Type> FileHasher::algorithms()
+{
+    // SHA-1 has to be the first one. see FileCacheItem::id()
+    return {
+        XMPP::Hash::Sha1, XMPP::Hash::Sha256,
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+        XMPP::Hash::Blake2b256,
+#endif
+    };
+}
+
+FileHasher::HashSums FileHasher::computeSums(QIODevice *dev, QThreadPool *pool,
+                                             const std::function<bool(qint64)> &progress)
+{
+    const auto                                       types = algorithms();
+    std::vector<std::unique_ptr<QCryptographicHash>> hashers;
+    for (auto t : types)
+        hashers.emplace_back(new QCryptographicHash(qtAlgorithm(t)));
+    if (!pool)
+        pool = QThreadPool::globalInstance();
+
+    auto readBlock = [dev](QByteArray &buf) {
+        buf.resize(blockSize);
+        qint64 r = dev->read(buf.data(), blockSize);
+        buf.resize(r > 0 ? int(r) : 0);
+        return r;
+    };
+
+    QByteArray cur, next;
+    qint64     done = 0;
+    qint64     r    = readBlock(cur);
+    while (r > 0) {
+        QList<QFuture<void>> futures;
+        for (size_t i = 1; i < hashers.size(); ++i) {
+            auto h = hashers[i].get();
+            futures.append(QtConcurrent::run(pool, [h, &cur]() { h->addData(cur); }));
+        }
+        // the first algorithm and reading of the next block are done in this thread meanwhile
+        hashers[0]->addData(cur);
+        qint64 nr = readBlock(next);
+        for (auto &f : futures)
+            f.waitForFinished();
+
+        done += cur.size();
+        if (progress && !progress(done))
+            return {};
+        cur.swap(next);
+        r = nr;
+    }
+    if (r < 0)
+        return {};
+
+    HashSums sums;
+    for (size_t i = 0; i < hashers.size(); ++i)
+        sums.append(XMPP::Hash(types[int(i)], hashers[i]->result()));
+    return sums;
+}
+
+FileHasher::HashSums FileHasher::cachedSums(const QString &fileName)
+{
+    QFileInfo fi(fileName);
+    auto      it = cache_.find(fi.absoluteFilePath());
+    if (it == cache_.end() || it->size != fi.size() || it->modified != fi.lastModified().toMSecsSinceEpoch())
+        return {};
+    it->lastUsed = QDateTime::currentMSecsSinceEpoch();
+    saveTimer_->start();
+    return it->sums;
+}
+
+bool FileHasher::isHashing(const QString &fileName) const { return running_.contains(fileName); }
+
+void FileHasher::hash(const QString &fileName)
+{
+    auto sums = cachedSums(fileName);
+    if (!sums.isEmpty()) {
+        QMetaObject::invokeMethod(
+            this, [this, fileName, sums]() { emit finished(fileName, sums); }, Qt::QueuedConnection);
+        return;
+    }
+    if (running_.contains(fileName))
+        return;
+    running_.insert(fileName);
+
+    QtConcurrent::run(&jobs_, [this, fileName]() {
+        QFile     file(fileName);
+        HashSums  sums;
+        qint64    size     = -1;
+        qint64    modified = 0;
+        QFileInfo fi(fileName);
+        if (file.open(QIODevice::ReadOnly)) {
+            size     = file.size();
+            modified = fi.lastModified().toMSecsSinceEpoch();
+            QElapsedTimer timer;
+            timer.start();
+            sums = computeSums(&file, &algoPool_, [&](qint64 done) {
+                if (shutdown_)
+                    return false;
+                if (timer.elapsed() >= progressInterval) {
+                    timer.restart();
+                    QMetaObject::invokeMethod(
+                        this, [this, fileName, done, size]() { emit progress(fileName, done, size); },
+                        Qt::QueuedConnection);
+                }
+                return true;
+            });
+        }
+        QMetaObject::invokeMethod(
+            this,
+            [this, fileName, size, modified, sums]() {
+                running_.remove(fileName);
+                if (!sums.isEmpty())
+                    store(fileName, size, modified, sums);
+                emit finished(fileName, sums);
+            },
+            Qt::QueuedConnection);
+    });
+}
+
+void FileHasher::store(const QString &fileName, qint64 size, qint64 modified, const HashSums &sums)
+{
+    cache_.insert(QFileInfo(fileName).absoluteFilePath(),
+                  { size, modified, QDateTime::currentMSecsSinceEpoch(), sums });
+    saveTimer_->start();
+}
+
+void FileHasher::load()
+{
+    QFile f(cacheFileName_);
+    if (!f.open(QIODevice::ReadOnly))
+        return;
+    QDataStream in(&f);
+    quint32     magic, version, count;
+    in >> magic >> version >> count;
+    if (magic != cacheMagic || version != cacheVersion)
+        return;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString     path;
+        CacheEntry  e;
+        QStringList sums;
+        in >> path >> e.size >> e.modified >> e.lastUsed >> sums;
+        for (const auto &s : std::as_const(sums)) {
+            auto ind = s.indexOf('+');
+            if (ind == -1)
+                continue;
+            auto       type = XMPP::Hash::parseType(QStringView { s }.left(ind));
+            auto       ba   = QByteArray::fromHex(QStringView { s }.mid(ind + 1).toLatin1());
+            XMPP::Hash hash(type, ba);
+            if (hash.isValid() && ba.size())
+                e.sums.append(hash);
+        }
+        if (in.status() == QDataStream::Ok && !e.sums.isEmpty())
+            cache_.insert(path, e);
+    }
+}
+
+void FileHasher::save()
+{
+    saveTimer_->stop();
+
+    QList<QPair<qint64, QString>> byUse;
+    for (auto it = cache_.cbegin(); it != cache_.cend(); ++it)
+        byUse.append({ it->lastUsed, it.key() });
+    if (byUse.size() > maxCacheEntries) {
+        std::sort(byUse.begin(), byUse.end());
+        for (int i = 0; i < byUse.size() - maxCacheEntries; ++i)
+            cache_.remove(byUse[i].second);
+    }
+
+    QSaveFile f(cacheFileName_);
+    if (!f.open(QIODevice::WriteOnly)) {
+        qWarning("filehasher: failed to save %s: %s", qPrintable(cacheFileName_), qPrintable(f.errorString()));
+        return;
+    }
+    QDataStream out(&f);
+    out << cacheMagic << cacheVersion << quint32(cache_.size());
+    for (auto it = cache_.cbegin(); it != cache_.cend(); ++it) {
+        QStringList sums;
+        for (const auto &h : it->sums)
+            sums.append(QString("%1+%2").arg(h.stringType(), QString::fromLatin1(h.toHex())));
+        out << it.key() << it->size << it->modified << it->lastUsed << sums;
+    }
+    f.commit();
+}
@@ -0,0 +1,94 @@
+/*
+ * filehasher.h - background hash sums calculation for shared files
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef FILEHASHER_H
+#define FILEHASHER_H
+
+#include "iris/xmpp_hash.h"
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QThreadPool>
+
+#include <atomic>
+#include <functional>
+
+class QIODevice;
+class QTimer;
+
+/**
+ * Calculates hash sums of local files in background.
+ *
+ * Every file is read just once. Each block read is fed to all the supported
+ * algorithms (SHA-1, SHA-256 and, with Qt6, BLAKE2b-256) in parallel while
+ * the next block is being read. SHA-1 always goes first in the result since
+ * it's what the file cache uses as an id.
+ *
+ * Results are remembered by (path, size, modification time) and saved to
+ * disk, so sharing the same file again doesn't need any reading at all.
+ */
+class FileHasher : public QObject {
+    Q_OBJECT
+public:
+    using HashSums = QList<XMPP::Hash>;
+
+    FileHasher(const QString &cacheFileName, QObject *parent = nullptr);
+    ~FileHasher();
+
+    // sums of the file if it was hashed before and hasn't been modified since. empty list otherwise
+    HashSums cachedSums(const QString &fileName);
+    // starts hashing in background. finished() will be emitted even if the sums are already known
+    void hash(const QString &fileName);
+    bool isHashing(const QString &fileName) const;
+
+    static QList<XMPP::Hash::Type> algorithms();
+    // reads dev till the end. returns an empty list on read error or when cancelled
+    static HashSums computeSums(QIODevice *dev, QThreadPool *pool = nullptr,
+                                const std::function<bool(qint64)> &progress = {});
+
+signals:
+    void progress(const QString &fileName, qint64 done, qint64 total);
+    // sums are empty on failure
+    void finished(const QString &fileName, const QList<XMPP::Hash> &sums);
+
+private slots:
+    void save();
+
+private:
+    struct CacheEntry {
+        qint64   size;
+        qint64   modified; // ms since epoch
+        qint64   lastUsed;
+        HashSums sums;
+    };
+
+    void load();
+    void store(const QString &fileName, qint64 size, qint64 modified, const HashSums &sums);
+
+    QString                    cacheFileName_;
+    QHash<QString, CacheEntry> cache_;
+    QSet<QString>              running_;
+    QThreadPool                jobs_;
+    QThreadPool                algoPool_;
+    QTimer                    *saveTimer_;
+    std::atomic<bool>          shutdown_ { false };
+};
+
+#endif // FILEHASHER_H
@@ -61,17 +61,53 @@ FileShareDlg::FileShareDlg(PsiAccount *acc, const XMPP::Jid &myJid, const QList<
 
     for (auto const &pi : items) {
         QFileInfo fi(pi->fileName());
-        auto      tr = filesModel->addTransfer(MultiFileTransferModel::Outgoing, fi.fileName(), quint64(fi.size()));
-        tr->setThumbnail(pi->thumbnail(QSize(64, 64)));
+        auto      transfer
+            = filesModel->addTransfer(MultiFileTransferModel::Outgoing, fi.fileName(), quint64(fi.size()));
+        transfer->setThumbnail(pi->thumbnail(QSize(64, 64)));
+        connect(pi, &FileSharingItem::imageReady, this,
+                [pi, transfer]() { transfer->setThumbnail(pi->thumbnail(QSize(64, 64))); });
         if (pi->isPublished()) {
-            tr->setCurrentSize(quint64(fi.size()));
-            tr->setState(MultiFileTransferModel::Done);
+            transfer->setCurrentSize(quint64(fi.size()));
+            transfer->setState(MultiFileTransferModel::Done);
+        } else if (pi->isHashing()) {
+            hashingCount++;
+            transfer->setState(MultiFileTransferModel::Pending, tr("Calculating checksums..."));
+            connect(pi, &FileSharingItem::hashingProgress, this, [transfer](qint64 done, qint64 total) {
+                if (total > 0)
+                    transfer->setState(MultiFileTransferModel::Pending,
+                                       tr("Calculating checksums... %1%").arg(done * 100 / total));
+            });
+            connect(pi, &FileSharingItem::hashingFinished, this, [this, pi, transfer, shareBtn]() {
+                if (pi->sums().isEmpty()) {
+                    transfer->setState(MultiFileTransferModel::Failed, tr("Failed to read the file"));
+                } else {
+                    transfer->setState(MultiFileTransferModel::Pending);
+                    transfer->setThumbnail(pi->thumbnail(QSize(64, 64)));
+                }
+                if (!--hashingCount)
+                    shareBtn->setEnabled(true);
+            });
         }
-        tr->setProperty("publisher", QVariant::fromValue<FileSharingItem *>(pi));
+        transfer->setProperty("publisher", QVariant::fromValue<FileSharingItem *>(pi));
     }
+    // all the checksums have to be known before publishing
+    shareBtn->setEnabled(!hashingCount);
 
     QImage preview;
-    if (items.count() > 1 || (preview = items[0]->preview(this->screen()->geometry().size() / 2)).isNull()) {
+    bool   pending = false;
+    if (items.count() == 1) {
+        auto pi      = items[0];
+        auto maxSize = this->screen()->geometry().size() / 2;
+        preview      = pi->preview(maxSize, &pending);
+        if (pending) { // show the list till the image is decoded
+            connect(pi, &FileSharingItem::imageReady, this, [this, pi, maxSize]() {
+                auto img = pi->preview(maxSize);
+                if (!img.isNull() && ui->pixmapRatioLabel->isHidden())
+                    showImage(img);
+            });
+        }
+    }
+    if (preview.isNull()) {
         ui->lv_files->show();
         ui->pixmapRatioLabel->hide();
     } else {
@@ -109,6 +145,10 @@ void FileShareDlg::publish()
             readyPublishers.append(publisher);
             return;
         }
+        if (publisher->sums().isEmpty()) { // failed to read the file
+            hasFailures = true;
+            return;
+        }
         item->setState(MultiFileTransferModel::Active);
         connect(publisher, &FileSharingItem::publishProgress, this,
                 [item](size_t progress) { item->setCurrentSize(progress); });
@@ -19,6 +19,7 @@
 
 #include "filesharingitem.h"
 #include "filecache.h"
+#include "filehasher.h"
 #include "filesharingmanager.h"
 #include "fileutil.h"
 #include "iris/httpfileupload.h"
@@ -26,15 +27,14 @@
 #include "iris/xmpp_reference.h"
 #include "iris/xmpp_thumbs.h"
 #include "psiaccount.h"
+#include "thumbnailservice.h"
 #include "userlist.h"
 
 #include <QBuffer>
 #include <QCryptographicHash>
 #include <QDir>
 #include <QFileIconProvider>
-#include <QImageReader>
 #include <QMimeDatabase>
-#include <QPainter>
 #include <QTemporaryFile>
 
 #define TEMP_TTL (7 * 24 * 3600)
@@ -112,17 +112,33 @@ FileSharingItem::FileSharingItem(const QString &fileName, PsiAccount *acc, FileS
     if (!file.open(QIODevice::ReadOnly))
         return;
 
-    auto h = Hash::from(Hash::Sha1, &file);
-    if (!h.isValid())
+    auto hasher = manager->hasher();
+    _sums       = hasher->cachedSums(fileName);
+    if (_sums.size() && initFromCache())
         return;
 
-    _sums.append(h);
+    _fileSize = quint64(file.size());
+    _mimeType = QMimeDatabase().mimeTypeForFileNameAndData(fileName, &file).name();
+    if (_sums.size())
+        return;
 
-    if (!initFromCache()) {
-        file.seek(0);
-        _fileSize = quint64(file.size());
-        _mimeType = QMimeDatabase().mimeTypeForFileNameAndData(fileName, &file).name();
-    }
+    // the sums will be known later. the file is read just once for all of them in background
+    _hashing = true;
+    connect(hasher, &FileHasher::progress, this, [this](const QString &name, qint64 done, qint64 total) {
+        if (name == _fileName)
+            emit hashingProgress(done, total);
+    });
+    connect(hasher, &FileHasher::finished, this, [this, hasher](const QString &name, const HashSums &sums) {
+        if (!_hashing || name != _fileName)
+            return;
+        _hashing = false;
+        hasher->disconnect(this);
+        _sums = sums;
+        if (_sums.size())
+            initFromCache();
+        emit hashingFinished();
+    });
+    hasher->hash(fileName);
 }
 
 FileSharingItem::FileSharingItem(const QString &mime, const QByteArray &data, const QVariantMap &metaData,
@@ -228,8 +244,14 @@ Reference FileSharingItem::toReference(const Jid &selfJid) const
     jfile.setMediaType(_mimeType);
     jfile.setDescription(_description);
 
-    QSize thumbSize(64, 64);
-    auto  thumbPix = thumbnail(thumbSize).pixmap(thumbSize);
+    QSize   thumbSize(64, 64);
+    QPixmap thumbPix;
+    bool    pending = false;
+    if (preview(thumbSize, &pending).isNull() && pending) // the reference is needed right now
+        thumbPix = QPixmap::fromImage(
+            ThumbnailService::framed(ThumbnailService::load(_fileName, thumbSize), thumbSize));
+    else
+        thumbPix = thumbnail(thumbSize).pixmap(thumbSize);
     if (!thumbPix.isNull()) {
         QByteArray pixData;
         QBuffer    buf(&pixData);
@@ -263,28 +285,35 @@ QIcon FileSharingItem::thumbnail(const QSize &size) const
     if (_fileType == FileType::RemoteFile)
         return QIcon();
 
-    QImage image;
-    if (_mimeType.startsWith(QLatin1String("image")) && image.load(_fileName)) {
-        auto   img = image.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-        QImage back(64, 64, QImage::Format_ARGB32_Premultiplied);
-        back.fill(Qt::transparent);
-        QPainter painter(&back);
-        auto     imgRect = img.rect();
-        imgRect.moveCenter(back.rect().center());
-        painter.drawImage(imgRect, img);
-        return QIcon(QPixmap::fromImage(std::move(back)));
+    if (_mimeType.startsWith(QLatin1String("image"))) {
+        auto img = preview(size);
+        if (!img.isNull())
+            return QIcon(QPixmap::fromImage(ThumbnailService::framed(img, size)));
     }
+    // also a placeholder till imageReady()
     return QFileIconProvider().icon(QFileInfo(_fileName));
 }
 
-QImage FileSharingItem::preview(const QSize &maxSize) const
+QImage FileSharingItem::preview(const QSize &maxSize, bool *pending) const
 {
-    QImage image;
-    if (image.load(_fileName)) {
-        auto s = image.size().boundedTo(maxSize);
-        return image.scaled(s, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    if (pending)
+        *pending = false;
+    if (_fileType == FileType::RemoteFile || !_mimeType.startsWith(QLatin1String("image")))
+        return QImage();
+
+    bool waiting = false;
+    auto service = _manager->thumbnails();
+    auto img     = service->image(_fileName, _sums.value(0), maxSize, &waiting);
+    if (waiting && !_imageConnection) {
+        auto self        = const_cast<FileSharingItem *>(this);
+        _imageConnection = connect(service, &ThumbnailService::ready, self, [self](const QString &fileName) {
+            if (fileName == self->_fileName)
+                emit self->imageReady();
+        });
     }
-    return image;
+    if (pending)
+        *pending = waiting;
+    return img;
 }
 
 QString FileSharingItem::displayName() const
@@ -78,7 +78,8 @@ public:
     ~FileSharingItem();
 
     QIcon                               thumbnail(const QSize &size) const;
-    QImage                              preview(const QSize &maxSize) const;
+    // image thumbnails are made in background. a placeholder/null image is returned till imageReady()
+    QImage                              preview(const QSize &maxSize, bool *pending = nullptr) const;
     QString                             displayName() const;
     QString                             fileName() const;
     inline const QString               &mimeType() const { return _mimeType; }
@@ -86,6 +87,8 @@ public:
     inline QVariantMap                  metaData() const { return _metaData; }
     inline std::optional<std::uint64_t> fileSize() const { return _fileSize; }
     inline const QStringList           &uris() const { return _uris; }
+    // local file checksums are being calculated in background. see hashingFinished()
+    inline bool isHashing() const { return _hashing; }
 
     // reborn flag updates ttl for the item
     FileCacheItem           *cache(bool reborn = false) const;
@@ -122,6 +125,11 @@ signals:
     void publishProgress(size_t transferredBytes);
     void downloadFinished();
     void logChanged();
+    void hashingProgress(qint64 done, qint64 total);
+    // sums() is empty if the file could not be read
+    void hashingFinished();
+    // thumbnail() or preview() requested before can be taken now
+    void imageReady();
 
 private:
     PsiAccount         *_acc     = nullptr;
@@ -139,6 +147,9 @@ private:
     QVariantMap                  _metaData;
     QStringList                  _log;
     QList<XMPP::Jid>             _jids;
+    bool                         _hashing = false;
+
+    mutable QMetaObject::Connection _imageConnection; // to ThumbnailService::ready
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(FileSharingItem::Flags)
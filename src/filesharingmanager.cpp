@@ -21,6 +21,7 @@
 
 #include "applicationinfo.h"
 #include "filecache.h"
+#include "filehasher.h"
 #include "filesharingdownloader.h"
 #include "httputil.h"
 #include "psiaccount.h"
@@ -38,6 +39,7 @@
 #endif
 #include "messageview.h"
 #include "textutil.h"
+#include "thumbnailservice.h"
 
 #include <QDir>
 #include <QMimeData>
@@ -48,6 +50,8 @@
 class FileSharingManager::Private {
 public:
     FileCache                           *cache;
+    FileHasher                          *hasher;
+    ThumbnailService                    *thumbnails;
     QHash<XMPP::Hash, FileSharingItem *> items;
 
     void rememberItem(FileSharingItem *item)
@@ -56,11 +60,29 @@ public:
         for (auto const &v : item->sums())
             items.insert(v, item); // TODO ensure we don't overwrite
     }
+
+    // returns false if the item is useless (failed to read the file. permissions problem?)
+    bool rememberLocalItem(FileSharingItem *item)
+    {
+        if (item->isHashing()) {
+            QObject::connect(item, &FileSharingItem::hashingFinished, item, [this, item]() {
+                if (item->sums().size())
+                    rememberItem(item);
+            });
+            return true;
+        }
+        if (item->sums().isEmpty())
+            return false;
+        rememberItem(item);
+        return true;
+    }
 };
 
 FileSharingManager::FileSharingManager(QObject *parent) : QObject(parent), d(new Private)
 {
-    d->cache = new FileCache(cacheDir(), this);
+    d->cache      = new FileCache(cacheDir(), this);
+    d->hasher     = new FileHasher(cacheDir() + "/hashes.dat", this);
+    d->thumbnails = new ThumbnailService(cacheDir() + "/thumbnails", this);
 }
 
 FileSharingManager::~FileSharingManager() { }
@@ -114,6 +136,10 @@ FileCacheItem *FileSharingManager::moveToCache(const QList<XMPP::Hash> &sums, co
     return d->cache->moveToCache(sums, file, metadata, maxAge);
 }
 
+FileHasher *FileSharingManager::hasher() const { return d->hasher; }
+
+ThumbnailService *FileSharingManager::thumbnails() const { return d->thumbnails; }
+
 FileSharingItem *FileSharingManager::item(const Hash &id) { return d->items.value(id); }
 
 QList<FileSharingItem *> FileSharingManager::createFromMimeData(const QMimeData *data, PsiAccount *acc)
@@ -173,9 +199,10 @@ QList<FileSharingItem *> FileSharingManager::createFromMimeData(const QMimeData
     } else {
         for (auto const &f : files) {
             auto item = new FileSharingItem(f, acc, this);
-            if (!item->sums().count())
-                continue; // failed to calculate checksum. permissions problem?
-            d->rememberItem(item);
+            if (!d->rememberLocalItem(item)) {
+                delete item;
+                continue;
+            }
             ret.append(item);
         }
     }
@@ -192,7 +219,10 @@ QList<FileSharingItem *> FileSharingManager::fromFilesList(const QStringList &fi
         QFileInfo fi(file);
         if (fi.isFile() && fi.isReadable()) {
             auto item = new FileSharingItem(file, acc, this);
-            d->rememberItem(item);
+            if (!d->rememberLocalItem(item)) {
+                delete item;
+                continue;
+            }
             ret << item;
         }
     }
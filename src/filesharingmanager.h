@@ -28,6 +28,7 @@
 
 class FileCache;
 class FileCacheItem;
+class FileHasher;
 class FileSharingDownloader;
 class FileSharingManager;
 class MessageView;
@@ -35,6 +36,7 @@ class PsiAccount;
 class QFileInfo;
 class QImage;
 class QMimeData;
+class ThumbnailService;
 
 namespace qhttp { namespace server {
     class QHttpRequest;
@@ -77,6 +79,11 @@ public:
     FileCacheItem *moveToCache(const QList<XMPP::Hash> &sums, const QFileInfo &data, const QVariantMap &metadata,
                                unsigned int maxAge);
 
+    // calculates checksums of local files to be shared
+    FileHasher *hasher() const;
+    // scaled down images of local files
+    ThumbnailService *thumbnails() const;
+
     FileSharingItem *item(const XMPP::Hash &id);
     // FileSharingItem* fromReference(const XMPP::Reference &ref, PsiAccount *acc);
     QList<FileSharingItem *> createFromMimeData(const QMimeData *data, PsiAccount *acc);
@@ -3,6 +3,7 @@
 #include "accountlabel.h"
 #include "accountscombobox.h"
 #include "busywidget.h"
+#include "filetransferio.h"
 #include "fileutil.h"
 #include "iris/filetransfer.h"
 #include "iris/s5b.h"
@@ -30,6 +31,11 @@
 
 typedef quint64 LARGE_TYPE;
 
+// a received file is not read from the connection while this much waits for
+// the disk, and is read again once the writer is down to the low mark
+static const qint64 writeHighWater = 4 * 1024 * 1024;
+static const qint64 writeLowWater  = 1024 * 1024;
+
 #define CSMAX (sizeof(LARGE_TYPE) * 8)
 #define CSMIN 16
 
@@ -107,6 +113,21 @@ public:
     int           shift;
     int           complement;
     QString       activeFile;
+
+    FileBlockReader  reader;
+    AsyncFileWriter *writer        = nullptr;
+    ProgressThrottle throttle;
+    bool             sendScheduled = false;
+    bool             readPaused    = false;
+
+    void closeWriter()
+    {
+        if (writer) {
+            writer->close();
+            delete writer;
+            writer = nullptr;
+        }
+    }
 };
 
 FileTransferHandler::FileTransferHandler(PsiAccount *pa, FileTransfer *ft)
@@ -139,6 +160,7 @@ FileTransferHandler::~FileTransferHandler()
     if (!d->activeFile.isEmpty())
         active_file_remove(d->activeFile);
 
+    delete d->writer;
     if (d->ft) {
         d->ft->close();
         delete d->ft;
@@ -300,31 +322,27 @@ void FileTransferHandler::ft_connected()
             emit error(ErrFile, 0, d->f.errorString());
             return;
         }
+        d->reader.setDevice(&d->f);
 
         if (d->sent == d->fileSize)
             QTimer::singleShot(0, this, SLOT(doFinish()));
         else
-            QTimer::singleShot(0, this, SLOT(trySend()));
+            scheduleSend();
     } else {
-        // open the file, truncating if offset is zero, otherwise set the correct offset
-        QIODevice::OpenMode m = QIODevice::ReadWrite;
-        if (d->offset == 0)
-            m |= QIODevice::Truncate;
-        bool ok = false;
-        if (d->f.open(m)) {
-            if (d->offset == 0) {
-                ok = true;
-            } else {
-                if (d->f.seek(d->offset))
-                    ok = true;
-            }
-        }
-        if (!ok) {
+        // open the file, truncating if offset is zero, otherwise set the correct offset.
+        // the data is written in a worker thread, so the event loop isn't blocked by disk
+        d->writer = new AsyncFileWriter;
+        if (!d->writer->open(d->f.fileName(), d->offset)) {
+            QString err = d->writer->errorString();
+            delete d->writer;
+            d->writer = nullptr;
             delete d->ft;
             d->ft = nullptr;
-            emit error(ErrFile, 0, d->f.errorString());
+            emit error(ErrFile, 0, err);
             return;
         }
+        connect(d->writer, &AsyncFileWriter::bytesWritten, this, &FileTransferHandler::writer_bytesWritten);
+        connect(d->writer, &AsyncFileWriter::error, this, &FileTransferHandler::writer_error);
 
         d->activeFile = d->f.fileName();
         active_file_add(d->activeFile);
@@ -339,18 +357,11 @@ void FileTransferHandler::ft_connected()
 
 void FileTransferHandler::ft_readyRead(const QByteArray &a)
 {
-    if (!d->sending) {
+    if (!d->sending && d->writer) {
         // printf("%d bytes read\n", a.size());
-        int r = int(d->f.write(a.data(), a.size()));
-        if (r < 0) {
-            d->f.close();
-            delete d->ft;
-            d->ft = nullptr;
-            emit error(ErrFile, 0, d->f.errorString());
-            return;
-        }
-        d->sent += a.size();
-        doFinish();
+        d->writer->write(a);
+        if (!d->readPaused && d->writer->bytesToWrite() > writeHighWater)
+            setReading(false);
     }
 }
 
@@ -363,16 +374,42 @@ void FileTransferHandler::ft_bytesWritten(qint64 x)
             d->f.close();
             delete d->ft;
             d->ft = nullptr;
-        } else
-            QTimer::singleShot(0, this, SLOT(trySend()));
-        emit progress(calcProgressStep(d->sent, d->complement, d->shift), d->sent);
+            emit progress(calcProgressStep(d->sent, d->complement, d->shift), d->sent);
+            return;
+        }
+        scheduleSend();
+        if (d->throttle.isDue())
+            emit progress(calcProgressStep(d->sent, d->complement, d->shift), d->sent);
     }
 }
 
+void FileTransferHandler::writer_bytesWritten(qint64 x)
+{
+    d->sent += x;
+    if (d->readPaused && d->writer && d->writer->bytesToWrite() < writeLowWater)
+        setReading(true);
+    if (d->sent == d->fileSize)
+        doFinish();
+    else if (d->throttle.isDue())
+        emit progress(calcProgressStep(d->sent, d->complement, d->shift), d->sent);
+}
+
+void FileTransferHandler::writer_error(const QString &errorString)
+{
+    // we are in its signal
+    d->writer->deleteLater();
+    d->writer = nullptr;
+    delete d->ft;
+    d->ft = nullptr;
+    emit error(ErrFile, 0, errorString);
+}
+
 void FileTransferHandler::ft_error(int x)
 {
     if (d->f.isOpen())
         d->f.close();
+    delete d->writer;
+    d->writer = nullptr;
     delete d->ft;
     d->ft = nullptr;
 
@@ -388,8 +425,35 @@ void FileTransferHandler::ft_error(int x)
         emit error(ErrTransfer, x, tr("Lost connection / Cancelled."));
 }
 
+void FileTransferHandler::scheduleSend()
+{
+    // several bytesWritten() may come before trySend() is invoked. one call is enough
+    if (!d->sendScheduled) {
+        d->sendScheduled = true;
+        QTimer::singleShot(0, this, SLOT(trySend()));
+    }
+}
+
+// FileTransfer reads everything the connection has on every readyRead(). While that is
+// disconnected the data stays in the socket and TCP slows the sender down
+void FileTransferHandler::setReading(bool on)
+{
+    if (!d->ft || !d->c)
+        return;
+    d->readPaused = !on;
+    if (on) {
+        connect(d->c, SIGNAL(readyRead()), d->ft, SLOT(stream_readyRead()));
+        // what came in meanwhile won't be announced again
+        QMetaObject::invokeMethod(d->ft, "stream_readyRead", Qt::QueuedConnection);
+    } else {
+        disconnect(d->c, SIGNAL(readyRead()), d->ft, SLOT(stream_readyRead()));
+    }
+}
+
 void FileTransferHandler::trySend()
 {
+    d->sendScheduled = false;
+
     // Since trySend comes from singleShot which is an "uncancelable"
     //   action, we should protect that d->ft is valid, for good measure
     if (!d->ft)
@@ -407,26 +471,29 @@ void FileTransferHandler::trySend()
     if (!d->ft->bsConnection())
         return;
 
-    int        blockSize = d->ft->dataSizeNeeded();
-    QByteArray a(blockSize, 0);
-    int        r = 0;
-    if (blockSize > 0)
-        r = int(d->f.read(a.data(), a.size()));
-    if (r < 0) {
-        d->f.close();
-        delete d->ft;
-        d->ft = nullptr;
-        emit error(ErrFile, 0, d->f.errorString());
-        return;
+    // Keep the connection's send window full. It's filled with several
+    //   smaller blocks from the reader's pool, so there is always more than
+    //   one block in flight and no block has to be allocated.
+    int needed;
+    while (d->ft && (needed = d->ft->dataSizeNeeded()) > 0) {
+        QByteArray a = d->reader.read(needed);
+        if (a.isNull()) {
+            d->f.close();
+            delete d->ft;
+            d->ft = nullptr;
+            emit error(ErrFile, 0, d->f.errorString());
+            return;
+        }
+        if (a.isEmpty()) // unexpected end of file
+            return;
+        d->ft->writeFileData(a);
     }
-    if (r < int(a.size()))
-        a.resize(r);
-    d->ft->writeFileData(a);
 }
 
 void FileTransferHandler::doFinish()
 {
     if (d->sent == d->fileSize) {
+        d->closeWriter();
         d->f.close();
         delete d->ft;
         d->ft = nullptr;
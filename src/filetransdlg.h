@@ -66,6 +66,8 @@ private slots:
     void ft_readyRead(const QByteArray &);
     void ft_bytesWritten(qint64);
     void ft_error(int);
+    void writer_bytesWritten(qint64);
+    void writer_error(const QString &);
     void trySend();
     void doFinish();
 
@@ -74,6 +76,8 @@ private:
     Private *d;
 
     void mapSignals();
+    void scheduleSend();
+    void setReading(bool on);
 };
 
 class FileRequestDlg : public QDialog, public Ui::FileTrans {
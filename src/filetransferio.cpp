@@ -0,0 +1,148 @@
+/*
+ * filetransferio.cpp - file reading/writing helpers for file transfers
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filetransferio.h"
+
+#include <QFile>
+
+//----------------------------------------------------------------------------
+// FileBlockReader
+//----------------------------------------------------------------------------
+
+FileBlockReader::FileBlockReader(int blockSize, int poolSize) : blockSize_(blockSize), pool_(qMax(poolSize, 1)) { }
+
+void FileBlockReader::setDevice(QIODevice *dev) { dev_ = dev; }
+
+int FileBlockReader::blockSize() const { return blockSize_; }
+
+QByteArray FileBlockReader::read(int max)
+{
+    QByteArray &buf = pool_[next_];
+    next_           = (next_ + 1) % pool_.size();
+
+    buf.resize(qMin(max, blockSize_));
+    qint64 r = dev_->read(buf.data(), buf.size());
+    if (r < 0)
+        return QByteArray();
+    if (r < buf.size())
+        buf.resize(int(r));
+    return buf;
+}
+
+//----------------------------------------------------------------------------
+// AsyncFileWriter
+//----------------------------------------------------------------------------
+
+class AsyncFileWriter::Worker : public QObject {
+    Q_OBJECT
+public:
+    QFile file;
+    bool  failed = false;
+
+public slots:
+    void write(const QByteArray &data)
+    {
+        if (failed)
+            return;
+        if (file.write(data) != data.size()) {
+            failed = true;
+            emit error(file.errorString());
+            return;
+        }
+        emit bytesWritten(data.size());
+    }
+
+    void close() { file.close(); }
+
+signals:
+    void bytesWritten(qint64);
+    void error(const QString &);
+};
+
+AsyncFileWriter::AsyncFileWriter(QObject *parent) : QObject(parent) { }
+
+AsyncFileWriter::~AsyncFileWriter()
+{
+    if (worker_) {
+        thread_.quit();
+        thread_.wait();
+        delete worker_;
+    }
+}
+
+bool AsyncFileWriter::open(const QString &fileName, qint64 offset)
+{
+    if (worker_)
+        return false;
+
+    auto w = new Worker;
+    w->file.setFileName(fileName);
+    QIODevice::OpenMode m = QIODevice::ReadWrite;
+    if (offset == 0)
+        m |= QIODevice::Truncate;
+    if (!w->file.open(m) || (offset && !w->file.seek(offset))) {
+        errorString_ = w->file.errorString();
+        delete w;
+        return false;
+    }
+
+    worker_ = w;
+    worker_->moveToThread(&thread_);
+    connect(worker_, &Worker::bytesWritten, this, [this](qint64 bytes) {
+        pending_ -= bytes;
+        emit bytesWritten(bytes);
+    });
+    connect(worker_, &Worker::error, this, &AsyncFileWriter::error);
+    thread_.start();
+    return true;
+}
+
+QString AsyncFileWriter::errorString() const { return errorString_; }
+
+void AsyncFileWriter::write(const QByteArray &data)
+{
+    if (worker_) {
+        pending_ += data.size();
+        QMetaObject::invokeMethod(worker_, "write", Qt::QueuedConnection, Q_ARG(QByteArray, data));
+    }
+}
+
+qint64 AsyncFileWriter::bytesToWrite() const { return pending_; }
+
+void AsyncFileWriter::close()
+{
+    if (worker_ && thread_.isRunning())
+        QMetaObject::invokeMethod(worker_, "close", Qt::BlockingQueuedConnection);
+}
+
+//----------------------------------------------------------------------------
+// ProgressThrottle
+//----------------------------------------------------------------------------
+
+ProgressThrottle::ProgressThrottle(int interval) : interval_(interval) { }
+
+bool ProgressThrottle::isDue()
+{
+    if (timer_.isValid() && timer_.elapsed() < interval_)
+        return false;
+    timer_.start();
+    return true;
+}
+
+#include "filetransferio.moc"
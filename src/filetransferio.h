@@ -0,0 +1,108 @@
+/*
+ * filetransferio.h - file reading/writing helpers for file transfers
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef FILETRANSFERIO_H
+#define FILETRANSFERIO_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QThread>
+#include <QVector>
+
+class QFile;
+class QIODevice;
+
+/**
+ * Reads a file in blocks of at most blockSize bytes using a small pool of
+ * buffers which are reused round robin instead of allocating a new one for
+ * every block. If a returned block is still referenced when its buffer comes
+ * around again, the buffer is detached by Qt, so handing blocks over to a
+ * connection which queues them is safe.
+ */
+class FileBlockReader {
+public:
+    enum { DefaultBlockSize = 16 * 1024, DefaultPoolSize = 8 };
+
+    FileBlockReader(int blockSize = DefaultBlockSize, int poolSize = DefaultPoolSize);
+
+    void setDevice(QIODevice *dev);
+    int  blockSize() const;
+
+    // reads up to max bytes (but not more than blockSize). returns a null array on error
+    QByteArray read(int max);
+
+private:
+    QIODevice          *dev_ = nullptr;
+    int                 blockSize_;
+    int                 next_ = 0;
+    QVector<QByteArray> pool_;
+};
+
+/**
+ * Writes data to a file in a worker thread. write() only queues the data;
+ * bytesWritten() is emitted in the caller's thread once it is on disk.
+ * Nothing limits the queue, the caller watches bytesToWrite() and stops
+ * reading its source while the disk is behind.
+ */
+class AsyncFileWriter : public QObject {
+    Q_OBJECT
+public:
+    AsyncFileWriter(QObject *parent = nullptr);
+    ~AsyncFileWriter();
+
+    // opens the file in the caller's thread, truncating it if offset is zero
+    bool    open(const QString &fileName, qint64 offset);
+    QString errorString() const;
+
+    void   write(const QByteArray &data);
+    qint64 bytesToWrite() const; // queued and not on disk yet
+    // waits for all the queued data to be written and closes the file
+    void close();
+
+signals:
+    void bytesWritten(qint64 bytes);
+    void error(const QString &errorString);
+
+private:
+    class Worker;
+    QThread thread_;
+    Worker *worker_ = nullptr;
+    QString errorString_;
+    qint64  pending_ = 0;
+};
+
+/**
+ * Limits how often transfer progress is reported to the UI.
+ */
+class ProgressThrottle {
+public:
+    enum { DefaultInterval = 100 }; // ms, 10 updates per second
+
+    ProgressThrottle(int interval = DefaultInterval);
+
+    // true on the first call and then at most once per interval
+    bool isDue();
+
+private:
+    QElapsedTimer timer_;
+    int           interval_;
+};
+
+#endif // FILETRANSFERIO_H
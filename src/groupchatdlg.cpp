@@ -38,6 +38,7 @@
 #include "mcmdsimplesite.h"
 #include "messageview.h"
 #include "msgmle.h"
+#include "muchighlighter.h"
 #include "mucconfigdlg.h"
 #include "mucmanager.h"
 #include "mucreasonseditor.h"
@@ -879,6 +880,7 @@ GCMainDlg::GCMainDlg(PsiAccount *pa, const Jid &j, TabManager *tabManager) : Tab
     ui_.log->setLocalNickname(d->self);
 #ifdef WEBKIT
     ui_.log->setAccount(account());
+    ui_.log->setHibernationEnabled(PsiOptions::instance()->getOption("options.ui.tabs.hibernate-after").toInt() > 0);
 #else
     ui_.log->setMediaOpener(account()->fileSharingDeviceOpener());
 #endif
@@ -1255,6 +1257,22 @@ void GCMainDlg::activated()
     d->trackBar = false;
 }
 
+bool GCMainDlg::hibernate()
+{
+#ifdef WEBKIT
+    return ui_.log->hibernate();
+#else
+    return false; // nothing worth to free in a text widget
+#endif
+}
+
+void GCMainDlg::wakeUp()
+{
+#ifdef WEBKIT
+    ui_.log->wakeUp();
+#endif
+}
+
 void GCMainDlg::mucInfoDialog(const QString &title, const QString &message, const MUCItem::Actor &actor,
                               const QString &reason)
 {
@@ -2202,21 +2220,12 @@ void GCMainDlg::message(const Message &_m, const PsiEvent::Ptr &e)
         return;
 
     // code to determine if the speaker was addressing this client in chat
-    if (dm.body().contains(d->self))
-        d->alert = true;
+    auto highlights = MucHighlighter::instance()->match(dm.body(), d->self);
+    d->alert        = !highlights.isEmpty();
 
-    if (dm.body().left(d->self.length()) == d->self)
+    if (dm.body().startsWith(d->self))
         d->lastReferrer = dm.from().resource();
 
-    if (options->getOption("options.ui.muc.use-highlighting").toBool()) {
-        QStringList highlightWords = options->getOption("options.ui.muc.highlight-words").toStringList();
-        for (const QString &word : std::as_const(highlightWords)) {
-            if (dm.body().contains((word), Qt::CaseInsensitive)) {
-                d->alert = true;
-            }
-        }
-    }
-
     // play sound?
     if (from == d->self) {
         if (!dm.spooled())
@@ -2245,7 +2254,7 @@ void GCMainDlg::message(const Message &_m, const PsiEvent::Ptr &e)
         mv.setDateTime(dm.timeStamp());
         dispatchMessage(mv);
     } else
-        appendMessage(m, d->alert);
+        appendMessage(m, d->alert, highlights);
 }
 
 void GCMainDlg::joined()
@@ -2273,7 +2282,7 @@ bool GCMainDlg::isLastMessageAlert() const { return d->alert; }
 void GCMainDlg::appendSysMsg(const QString &str, bool alert)
 {
     MessageView mv = MessageView::systemMessage(str);
-    mv.setAlert(alert && PsiOptions::instance()->getOption(QStringLiteral("options.ui.muc.use-highlighting")).toBool());
+    mv.setAlert(alert && MucHighlighter::instance()->isEnabled());
     dispatchMessage(mv);
 }
 
@@ -2287,7 +2296,7 @@ void GCMainDlg::dispatchMessage(const MessageView &mv)
         doAlert();
 }
 
-void GCMainDlg::appendMessage(const Message &m, bool alert)
+void GCMainDlg::appendMessage(const Message &m, bool alert, const HighlightMatcher::Spans &highlights)
 {
     Message dm = m.displayMessage();
     // figure out the encryption state
@@ -2321,10 +2330,12 @@ void GCMainDlg::appendMessage(const Message &m, bool alert)
     } else {
         mv.setPlainText(dm.body());
     }
-    if (!PsiOptions::instance()->getOption("options.ui.muc.use-highlighting").toBool())
+    if (!MucHighlighter::instance()->isEnabled())
         alert = false;
     mv.setMessageId(dm.id());
     mv.setAlert(alert);
+    if (alert)
+        mv.setHighlights(highlights);
     mv.setUserId(dm.from().full()); // theoretically, this can be inferred from the chat dialog properties
     mv.setNick(dm.from().resource());
     mv.setLocal(mv.nick() == d->self);
@@ -2479,6 +2490,9 @@ void GCMainDlg::optionsUpdate()
     setLooks();
     setToolbuttons();
     setShortcuts();
+#ifdef WEBKIT
+    ui_.log->setHibernationEnabled(PsiOptions::instance()->getOption("options.ui.tabs.hibernate-after").toInt() > 0);
+#endif
     d->typeahead->optionsUpdate();
     // update status icons
     d->usersModel->updateAll();
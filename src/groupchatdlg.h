@@ -21,6 +21,7 @@
 #define GROUPCHATDLG_H
 
 #include "advwidget.h"
+#include "highlightmatcher.h"
 #include "languagemanager.h"
 #include "mucmanager.h"
 #include "psievent.h"
@@ -85,6 +86,8 @@ protected:
     void dragEnterEvent(QDragEnterEvent *);
     void dropEvent(QDropEvent *);
     void closeEvent(QCloseEvent *);
+    bool hibernate();
+    void wakeUp();
     void mucInfoDialog(const QString &title, const QString &message, const MUCItem::Actor &actor,
                        const QString &reason);
     void setStatusTabIcon(int status);
@@ -159,7 +162,7 @@ private:
     bool lastWasEncrypted_ = false;
 
     void doAlert();
-    void appendMessage(const Message &, bool);
+    void appendMessage(const Message &, bool, const HighlightMatcher::Spans &highlights = {});
     void setLooks();
     void setToolbuttons();
 
@@ -0,0 +1,187 @@
+/*
+ * highlightmatcher.cpp - compiled multi-pattern matcher for highlight words
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "highlightmatcher.h"
+
+#include <QDebug>
+#include <QQueue>
+
+#include <algorithm>
+
+static inline bool isWordChar(QChar c) { return c.isLetterOrNumber() || c == QLatin1Char('_'); }
+
+void HighlightMatcher::compile(const QStringList &rules)
+{
+    clear();
+    for (const QString &rule : rules) {
+        if (rule.length() > 2 && rule.startsWith(QLatin1Char('/')) && rule.endsWith(QLatin1Char('/'))) {
+            QRegularExpression re(rule.mid(1, rule.length() - 2),
+                                  QRegularExpression::CaseInsensitiveOption
+                                      | QRegularExpression::UseUnicodePropertiesOption);
+            if (!re.isValid()) {
+                qWarning("highlightmatcher: invalid rule %s: %s", qPrintable(rule), qPrintable(re.errorString()));
+                continue;
+            }
+            re.optimize();
+            regexps_.append(re);
+        } else if (rule.length() > 2 && rule.startsWith(QLatin1Char('"')) && rule.endsWith(QLatin1Char('"'))) {
+            addPattern(rule.mid(1, rule.length() - 2), true);
+        } else {
+            addPattern(rule, false);
+        }
+    }
+    buildFailLinks();
+}
+
+void HighlightMatcher::clear()
+{
+    nodes_.clear();
+    nodes_.append(Node()); // root
+    patterns_.clear();
+    regexps_.clear();
+}
+
+bool HighlightMatcher::isEmpty() const { return patterns_.isEmpty() && regexps_.isEmpty(); }
+
+void HighlightMatcher::addPattern(const QString &word, bool wholeWord)
+{
+    if (word.isEmpty())
+        return;
+    if (nodes_.isEmpty())
+        nodes_.append(Node());
+
+    int state = 0;
+    for (QChar c : word) {
+        c        = c.toCaseFolded();
+        int next = nodes_[state].next.value(c, -1);
+        if (next == -1) {
+            next = nodes_.size();
+            nodes_.append(Node());
+            nodes_[state].next.insert(c, next);
+        }
+        state = next;
+    }
+    nodes_[state].patterns.append(patterns_.size());
+    patterns_.append({ int(word.length()), wholeWord });
+}
+
+// classic BFS. outputs of a fail target are merged into the node so scan() doesn't have to follow the links
+void HighlightMatcher::buildFailLinks()
+{
+    QQueue<int> queue;
+    for (int child : std::as_const(nodes_[0].next)) {
+        nodes_[child].fail = 0;
+        queue.enqueue(child);
+    }
+    while (!queue.isEmpty()) {
+        int state = queue.dequeue();
+        for (auto it = nodes_[state].next.cbegin(); it != nodes_[state].next.cend(); ++it) {
+            int child = it.value();
+            int fail  = nodes_[state].fail;
+            while (fail && !nodes_[fail].next.contains(it.key()))
+                fail = nodes_[fail].fail;
+            fail = nodes_[fail].next.value(it.key(), 0);
+
+            nodes_[child].fail = fail;
+            nodes_[child].patterns += nodes_[fail].patterns;
+            queue.enqueue(child);
+        }
+    }
+}
+
+inline int HighlightMatcher::step(int state, QChar c) const
+{
+    for (;;) {
+        int next = nodes_[state].next.value(c, -1);
+        if (next != -1)
+            return next;
+        if (!state)
+            return 0;
+        state = nodes_[state].fail;
+    }
+}
+
+inline bool HighlightMatcher::isAccepted(const QString &text, int end, const Pattern &p) const
+{
+    if (!p.wholeWord)
+        return true;
+    int start = end - p.length;
+    return (start == 0 || !isWordChar(text.at(start - 1))) && (end == text.length() || !isWordChar(text.at(end)));
+}
+
+// cb(start, length) returns false to stop scanning
+template <typename Callback> void HighlightMatcher::scan(const QString &text, Callback &&cb) const
+{
+    if (!patterns_.isEmpty()) {
+        int state = 0;
+        for (int i = 0; i < text.length(); ++i) {
+            state = step(state, text.at(i).toCaseFolded());
+            for (int pi : nodes_[state].patterns) {
+                const Pattern &p = patterns_[pi];
+                if (isAccepted(text, i + 1, p) && !cb(i + 1 - p.length, p.length))
+                    return;
+            }
+        }
+    }
+    for (const QRegularExpression &re : regexps_) {
+        auto it = re.globalMatch(text);
+        while (it.hasNext()) {
+            auto m = it.next();
+            if (m.capturedLength() && !cb(int(m.capturedStart()), int(m.capturedLength())))
+                return;
+        }
+    }
+}
+
+HighlightMatcher::Spans HighlightMatcher::match(const QString &text, const QString &nick) const
+{
+    Spans spans;
+    scan(text, [&spans](int start, int length) {
+        spans.append({ start, length });
+        return true;
+    });
+    if (!nick.isEmpty()) {
+        for (int pos = text.indexOf(nick); pos != -1; pos = text.indexOf(nick, pos + nick.length()))
+            spans.append({ pos, int(nick.length()) });
+    }
+    if (spans.size() < 2)
+        return spans;
+
+    std::sort(spans.begin(), spans.end(), [](const Span &a, const Span &b) { return a.start < b.start; });
+    Spans merged;
+    merged.append(spans.first());
+    for (int i = 1; i < spans.size(); ++i) {
+        Span &last = merged.last();
+        if (spans[i].start <= last.end())
+            last.length = std::max(last.end(), spans[i].end()) - last.start;
+        else
+            merged.append(spans[i]);
+    }
+    return merged;
+}
+
+bool HighlightMatcher::hasMatch(const QString &text) const
+{
+    bool found = false;
+    scan(text, [&found](int, int) {
+        found = true;
+        return false;
+    });
+    return found;
+}
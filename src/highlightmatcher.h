@@ -0,0 +1,87 @@
+/*
+ * highlightmatcher.h - compiled multi-pattern matcher for highlight words
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef HIGHLIGHTMATCHER_H
+#define HIGHLIGHTMATCHER_H
+
+#include <QHash>
+#include <QList>
+#include <QRegularExpression>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * Matches a text against a list of highlight rules at once.
+ *
+ * Rule syntax (one rule per string):
+ *   word       - case-insensitive substring, like it always was
+ *   "word"     - case-insensitive whole word
+ *   /pattern/  - case-insensitive regular expression
+ *
+ * Plain and whole word rules are compiled to a single Aho-Corasick automaton
+ * over case-folded characters, so the text is scanned once regardless of the
+ * number of rules. Folding is done per UTF-16 unit, hence span positions are
+ * valid for the original text as well.
+ */
+class HighlightMatcher {
+public:
+    struct Span {
+        int start  = 0;
+        int length = 0;
+
+        inline int  end() const { return start + length; }
+        inline bool operator==(const Span &other) const { return start == other.start && length == other.length; }
+    };
+    using Spans = QList<Span>;
+
+    void compile(const QStringList &rules);
+    void clear();
+    bool isEmpty() const;
+
+    // returns sorted, non-overlapping spans of all the rules matched in text.
+    // nick (if not empty) is searched for case-sensitively as a substring too.
+    Spans match(const QString &text, const QString &nick = QString()) const;
+    // true if anything matches. stops on the first match
+    bool hasMatch(const QString &text) const;
+
+private:
+    struct Pattern {
+        int  length;
+        bool wholeWord;
+    };
+
+    struct Node {
+        QHash<QChar, int> next;
+        int               fail = 0;
+        QVector<int>      patterns; // including the ones reachable by fail links
+    };
+
+    void addPattern(const QString &word, bool wholeWord);
+    void buildFailLinks();
+    int  step(int state, QChar c) const;
+    bool isAccepted(const QString &text, int end, const Pattern &p) const;
+
+    template <typename Callback> void scan(const QString &text, Callback &&cb) const;
+
+    QVector<Node>             nodes_;
+    QVector<Pattern>          patterns_;
+    QList<QRegularExpression> regexps_;
+};
+
+#endif // HIGHLIGHTMATCHER_H
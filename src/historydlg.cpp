@@ -21,11 +21,14 @@
 
 #include "coloropt.h"
 #include "common.h"
+#include "edbsqlite.h"
 #include "fileutil.h"
+#include "historyexporter.h"
 #include "jidutil.h"
 #include "psiaccount.h"
 #include "psicon.h"
 #include "psicontact.h"
+#include "psicontactlist.h"
 #include "psiiconset.h"
 #include "psioptions.h"
 #include "shortcutmanager.h"
@@ -50,61 +53,6 @@ typedef Qt::TimeSpec TimeZomeEnum;
 
 static const QString geometryOption = "options.ui.history.size";
 
-static QString getNext(QString *str)
-{
-    int n = 0;
-    // skip leading spaces (but *do* return them later!)
-    while (n < int(str->length()) && str->at(n).isSpace()) {
-        ++n;
-    }
-    if (n == int(str->length())) {
-        return QString();
-    }
-    // find end or next space
-    while (n < int(str->length()) && !str->at(n).isSpace()) {
-        ++n;
-    }
-    QString result = str->mid(0, n);
-    *str           = str->mid(n);
-    return result;
-}
-
-// wraps a string against a fixed width
-static QStringList wrapString(const QString &str, int wid)
-{
-    QStringList lines;
-    QString     cur;
-    QString     tmp = str;
-    // printf("parsing: [%s]\n", tmp.latin1());
-    while (1) {
-        QString word = getNext(&tmp);
-        if (word == QString()) {
-            lines += cur;
-            break;
-        }
-        // printf("word:[%s]\n", word.latin1());
-        if (!cur.isEmpty()) {
-            if (int(cur.length()) + int(word.length()) > wid) {
-                lines += cur;
-                cur = "";
-            }
-        }
-        if (cur.isEmpty()) {
-            // trim the whitespace in front
-            for (int n = 0; n < int(word.length()); ++n) {
-                if (!word.at(n).isSpace()) {
-                    if (n > 0) {
-                        word = word.mid(n);
-                    }
-                    break;
-                }
-            }
-        }
-        cur += word;
-    }
-    return lines;
-}
-
 SearchProxy::SearchProxy(PsiCon *p, DisplayProxy *d) : QObject(nullptr), active(false)
 {
     psi = p;
@@ -656,7 +604,17 @@ HistoryDlg::HistoryDlg(const Jid &jid, PsiAccount *pa) :
     optionUpdated("options.ui.look.colors.messages.received");
     optionUpdated("options.ui.emoticons.use-emoticons");
     optionUpdated("options.ui.chat.legacy-formatting");
-    connect(PsiOptions::instance(), SIGNAL(optionChanged(QString)), SLOT(optionUpdated(QString)));
+    for (const char *option : {
+#ifndef Q_OS_LINUX
+             "options.ui.automatically-copy-selected-text",
+#endif
+             "options.ui.look.colors.messages.sent", "options.ui.look.colors.messages.received",
+             "options.ui.emoticons.use-emoticons", "options.ui.chat.legacy-formatting" }) {
+        PsiOptions::instance()->subscribe(option, this, [this](const QStringList &changed) {
+            for (const QString &option : changed)
+                optionUpdated(option);
+        });
+    }
 
     connect(pa, SIGNAL(removedContact(PsiContact *)), SLOT(removedContact(PsiContact *)));
 
@@ -941,118 +899,55 @@ void HistoryDlg::exportHistory()
         them = JIDUtil::nickOrJid(u->name(), u->jid().full());
     else
         them = d->jid.full();
-    QString s     = (!them.isEmpty()) ? JIDUtil::encode(them).toLower() : "all_contacts";
-    QString fname = FileUtil::getSaveFileName(this, tr("Export message history"), s + ".txt",
-                                              tr("Text files (*.txt);;All files (*.*)"));
-    if (fname.isEmpty())
-        return;
+    QString s = (!them.isEmpty()) ? JIDUtil::encode(them).toLower() : "all_contacts";
+    startExport(getCurrentAccountId(), d->jid, s);
+}
+
+void HistoryDlg::exportAllHistory() { startExport(QString(), Jid(), "all_contacts"); }
 
-    QFile f(fname);
-    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
-        QMessageBox::information(this, tr("Error"), tr("Error writing to file."));
+void HistoryDlg::startExport(const QString &accId, const Jid &jid, const QString &baseName)
+{
+    QString filter;
+    QString fname = FileUtil::getSaveFileName(
+        this, tr("Export message history"), baseName + ".txt",
+        tr("Text files (*.txt);;JSON Lines (*.jsonl);;XML files (*.xml);;All files (*.*)"), &filter);
+    if (fname.isEmpty())
         return;
-    }
-    QTextStream stream(&f);
-
-    EDB    *edb = nullptr;
-    QString us;
-    // PsiAccount *pa = nullptr;
-    if (d->pa) {
-        edb = d->pa->edb();
-        us  = d->pa->nick();
-    } else {
-        edb = d->psi->edb();
-        us  = d->psi->contactList()->defaultAccount()->nick();
-    }
 
-    EDBHandle *h;
-    int        start = 0;
-    startRequest();
-    QString paId = getCurrentAccountId();
-    int     max  = 0;
-    {
-        quint64 edbCnt = d->psi->edb()->eventsCount(paId, d->jid);
-        if (edbCnt > 1000) {
-            max = int(edbCnt / 1000);
-            if ((edbCnt % 1000) != 0)
-                ++max;
-            showProgress(max);
-        }
-    }
-    PsiAccount *acc = nullptr;
-    if ((d->psi->edb()->features() & EDB::SeparateAccounts) == 0) {
-        Q_ASSERT(d->pa);
-        acc = d->pa;
+    HistoryExporter::Format format = HistoryExporter::formatForFileName(fname);
+    if (filter.contains("*.jsonl"))
+        format = HistoryExporter::JsonLines;
+    else if (filter.contains("*.xml"))
+        format = HistoryExporter::Xml;
+
+    auto exporter = new HistoryExporter(static_cast<EDBSqLite *>(d->psi->edb()), this);
+    for (PsiAccount *pa : d->psi->contactList()->accounts()) {
+        exporter->setAccountNick(pa->id(), pa->nick());
+        for (PsiContact *pc : pa->contactList())
+            exporter->setContactName(pc->jid().bare(), JIDUtil::nickOrJid(pc->name(), pc->jid().bare()));
     }
-    while (1) {
-        h = new EDBHandle(edb);
-        h->get(paId, d->jid, QDateTime(), EDB::Forward, start, 1000);
-        while (h->busy()) {
-            qApp->processEvents();
-        }
-
-        const EDBResult r   = h->result();
-        int             cnt = r.count();
-
-        // events are in forward order
-        for (int i = 0; i < cnt; ++i) {
-            EDBItemPtr    item = r.value(i);
-            PsiEvent::Ptr e(item->event());
-            QString       txt;
-
-            QString ts = QLocale().toString(e->timeStamp(), QLocale::ShortFormat);
-
-            QString nick;
-            if (e->originLocal()) {
-                if (acc)
-                    nick = acc->nick();
-                else if (e->account())
-                    nick = e->account()->nick();
-                else
-                    nick = tr("deleted");
-            } else {
-                if (!them.isEmpty())
-                    nick = them;
-                else
-                    nick = e->from().full();
-            }
-
-            if (e->type() == PsiEvent::Message) {
-                MessageEvent::Ptr me = e.staticCast<MessageEvent>();
-                stream << QString("[%1] <%2>: ").arg(ts, nick) /* << endl*/;
-#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
-                QStringList lines = me->message().body().split('\n', Qt::KeepEmptyParts);
-#else
-                QStringList lines = me->message().body().split('\n', QString::KeepEmptyParts);
-#endif
-                for (const QString &str : std::as_const(lines)) {
-                    QStringList sub = wrapString(str, 72);
-                    for (const QString &str2 : std::as_const(sub)) {
-                        txt += str2 + "\n" + QString("    ");
-                    }
-                }
-            } else {
-                continue;
-            }
-#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
-            stream << txt << Qt::endl;
-#else
-            stream << txt << endl;
-#endif
-        }
-        delete h;
 
-        if (max > 0)
-            incrementProgress();
-
-        // done!
-        if (cnt == 0)
-            break;
-
-        start += 1000;
-    }
-    f.close();
-    stopRequest();
+    auto progress = new QProgressDialog(tr("Exporting history..."), tr("Cancel"), 0, 1000, this);
+    progress->setWindowTitle(tr("Export message history"));
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(500);
+    connect(progress, &QProgressDialog::canceled, exporter, &HistoryExporter::cancel);
+    connect(exporter, &HistoryExporter::progress, progress,
+            [progress](qint64 done, qint64 total, double eventsPerSecond) {
+                progress->setValue(total ? int(done * 1000 / total) : 0);
+                progress->setLabelText(tr("Exported %1 of %2 events (%3 events/s)")
+                                           .arg(done)
+                                           .arg(total)
+                                           .arg(qRound(eventsPerSecond)));
+            });
+    connect(exporter, &HistoryExporter::finished, this,
+            [this, exporter, progress](bool success, const QString &errorString) {
+                progress->deleteLater();
+                exporter->deleteLater();
+                if (!success && !errorString.isEmpty())
+                    QMessageBox::information(this, tr("Error"), tr("Error writing to file.") + "\n" + errorString);
+            });
+    exporter->start(fname, format, accId, jid);
 }
 
 void HistoryDlg::doMenu()
@@ -1069,6 +964,8 @@ void HistoryDlg::doMenu()
     QAction *chat = m->addAction(IconsetFactory::icon("psi/chat").icon(), tr("&Open chat"), this, SLOT(openChat()));
     QAction *exp
         = m->addAction(IconsetFactory::icon("psi/save").icon(), tr("&Export history"), this, SLOT(exportHistory()));
+    QAction *all = m->addAction(IconsetFactory::icon("psi/save").icon(), tr("Export &all history"), this,
+                                SLOT(exportAllHistory()));
     QAction *del = m->addAction(IconsetFactory::icon("psi/clearChat").icon(), tr("&Delete history"), this,
                                 SLOT(removeHistory()));
 
@@ -1080,6 +977,8 @@ void HistoryDlg::doMenu()
     int features = d->psi->edb()->features();
     if ((!d->pa && !(features & EDB::AllAccounts)) || (d->jid.isEmpty() && !(features & EDB::AllContacts)))
         exp->setEnabled(false);
+    if (!(features & EDB::AllAccounts) || !(features & EDB::AllContacts))
+        all->setEnabled(false);
 
     m->exec(QCursor::pos());
     delete m;
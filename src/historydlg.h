@@ -163,6 +163,7 @@ private slots:
     void changeAccount(const QString accountName);
     void removeHistory();
     void exportHistory();
+    void exportAllHistory();
     void openChat();
     void doMenu();
     void removedContact(PsiContact *);
@@ -196,6 +197,7 @@ private:
     QString                  getCurrentAccountId() const;
     HistoryContactListModel *contactListModel();
     void                     setShortcuts();
+    void                     startExport(const QString &accId, const Jid &jid, const QString &baseName);
 
     class Private;
     Private                 *d;
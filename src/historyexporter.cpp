@@ -0,0 +1,510 @@
+/*
+ * historyexporter.cpp - background export of the message history
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "historyexporter.h"
+
+#include "edbsqlite.h"
+
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocale>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QXmlStreamWriter>
+#include <QtConcurrent>
+
+#include <atomic>
+
+static const int exportBufferSize = 256 * 1024;
+static const int progressInterval = 250; // ms
+
+static QString getNext(QString *str)
+{
+    int n = 0;
+    // skip leading spaces (but *do* return them later!)
+    while (n < int(str->length()) && str->at(n).isSpace()) {
+        ++n;
+    }
+    if (n == int(str->length())) {
+        return QString();
+    }
+    // find end or next space
+    while (n < int(str->length()) && !str->at(n).isSpace()) {
+        ++n;
+    }
+    QString result = str->mid(0, n);
+    *str           = str->mid(n);
+    return result;
+}
+
+// wraps a string against a fixed width
+static QStringList wrapString(const QString &str, int wid)
+{
+    QStringList lines;
+    QString     cur;
+    QString     tmp = str;
+    // printf("parsing: [%s]\n", tmp.latin1());
+    while (1) {
+        QString word = getNext(&tmp);
+        if (word == QString()) {
+            lines += cur;
+            break;
+        }
+        // printf("word:[%s]\n", word.latin1());
+        if (!cur.isEmpty()) {
+            if (int(cur.length()) + int(word.length()) > wid) {
+                lines += cur;
+                cur = "";
+            }
+        }
+        if (cur.isEmpty()) {
+            // trim the whitespace in front
+            for (int n = 0; n < int(word.length()); ++n) {
+                if (!word.at(n).isSpace()) {
+                    if (n > 0) {
+                        word = word.mid(n);
+                    }
+                    break;
+                }
+            }
+        }
+        cur += word;
+    }
+    return lines;
+}
+
+// see EDBSqLite::appendEvent() for the type codes
+static QString eventTypeName(int type)
+{
+    switch (type) {
+    case 0:
+        return QStringLiteral("normal");
+    case 1:
+        return QStringLiteral("chat");
+    case 3:
+        return QStringLiteral("subscribe");
+    case 4:
+        return QStringLiteral("error");
+    case 5:
+        return QStringLiteral("headline");
+    case 6:
+        return QStringLiteral("subscribed");
+    case 7:
+        return QStringLiteral("unsubscribe");
+    case 8:
+        return QStringLiteral("unsubscribed");
+    default:
+        return QStringLiteral("system");
+    }
+}
+
+static inline bool isMessageType(int type) { return type == 0 || type == 1 || type == 4 || type == 5; }
+
+//----------------------------------------------------------------------------
+// HistoryExporter::Private
+//----------------------------------------------------------------------------
+
+class HistoryExporter::Private {
+public:
+    struct Contact {
+        qint64  id;
+        QString accId;
+        QString jid;
+        int     type;
+    };
+
+    struct Event {
+        QString                        resource;
+        QDateTime                      date;
+        int                            type;
+        bool                           local;
+        QString                        subject;
+        QString                        body;
+        QString                        lang;
+        QList<QPair<QString, QString>> urls;
+    };
+
+    HistoryExporter        *q;
+    EDBSqLite              *edb;
+    QHash<QString, QString> accountNicks;
+    QHash<QString, QString> contactNames;
+    QString                 fileName;
+    Format                  format = PlainText;
+    QString                 accId;
+    XMPP::Jid               jid;
+    std::atomic<bool>       cancelled { false };
+    QFutureWatcher<QString> watcher;
+
+    // worker thread state
+    QByteArray       out;
+    QBuffer          buffer;
+    QXmlStreamWriter xml;
+    bool             severalContacts = false;
+
+    Private(HistoryExporter *q, EDBSqLite *edb) : q(q), edb(edb) { }
+
+    QString run();
+    QString exportAll(QSqlDatabase &db, QFile &file);
+    bool    flush(QFile &file, bool force);
+
+    void    writeHeader();
+    void    writeFooter();
+    void    writeContactBegin(const Contact &c);
+    void    writeContactEnd(const Contact &c);
+    void    writeEvent(const Contact &c, const Event &e);
+    QString nick(const Contact &c, const Event &e) const;
+};
+
+QString HistoryExporter::Private::run()
+{
+    QFile               file(fileName);
+    QIODevice::OpenMode mode = QIODevice::WriteOnly | QIODevice::Truncate;
+    if (format == PlainText)
+        mode |= QIODevice::Text;
+    if (!file.open(mode)) {
+        return HistoryExporter::tr("Error writing to file.");
+    }
+
+    const QString connName = QString("history-export-%1").arg(quintptr(this));
+    QString       error;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connName);
+        db.setDatabaseName(EDBSqLite::databasePath());
+        db.setConnectOptions("QSQLITE_OPEN_READONLY");
+        if (db.open()) {
+            error = exportAll(db, file);
+            db.close();
+        } else {
+            error = db.lastError().text();
+        }
+    }
+    QSqlDatabase::removeDatabase(connName);
+
+    file.close();
+    if (!error.isEmpty() || cancelled) {
+        file.remove();
+    }
+    return error;
+}
+
+QString HistoryExporter::Private::exportAll(QSqlDatabase &db, QFile &file)
+{
+    QString filter;
+    if (!accId.isEmpty())
+        filter.append(" AND `acc_id` = :acc_id");
+    if (!jid.isEmpty())
+        filter.append(" AND `jid` = :jid");
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+
+    // contacts to export and the total number of events for the progress
+    QList<Contact> contacts;
+    query.prepare("SELECT `id`, `acc_id`, `jid`, `type` FROM `contacts` WHERE 1" + filter
+                  + " ORDER BY `acc_id`, `jid`;");
+    if (!accId.isEmpty())
+        query.bindValue(":acc_id", accId);
+    if (!jid.isEmpty())
+        query.bindValue(":jid", jid.full());
+    if (!query.exec())
+        return query.lastError().text();
+    while (query.next()) {
+        contacts.append({ query.value(0).toLongLong(), query.value(1).toString(), query.value(2).toString(),
+                          query.value(3).toInt() });
+    }
+    query.finish();
+
+    qint64 total = 0;
+    query.prepare("SELECT count(*) FROM `events`, `contacts` WHERE `contacts`.`id` = `contact_id`" + filter + ";");
+    if (!accId.isEmpty())
+        query.bindValue(":acc_id", accId);
+    if (!jid.isEmpty())
+        query.bindValue(":jid", jid.full());
+    if (query.exec() && query.next())
+        total = query.value(0).toLongLong();
+    query.finish();
+
+    // ordered by date like EDB's QueryOldest. rows are streamed, not paged
+    query.prepare("SELECT `resource`, `date`, `type`, `direction`, `subject`, `m_text`, `lang`, `extra_data`"
+                  " FROM `events` WHERE `contact_id` = :contact_id ORDER BY `date`, `id`;");
+
+    buffer.close();
+    out.clear();
+    out.reserve(exportBufferSize + exportBufferSize / 4);
+    buffer.setBuffer(&out);
+    buffer.open(QIODevice::WriteOnly);
+    xml.setDevice(&buffer);
+    xml.setAutoFormatting(true);
+    severalContacts = contacts.size() > 1;
+
+    QElapsedTimer timer;
+    timer.start();
+    qint64 lastProgress = 0;
+    qint64 done         = 0;
+
+    emit q->progress(0, total, 0);
+
+    writeHeader();
+    for (const Contact &c : std::as_const(contacts)) {
+        query.bindValue(":contact_id", c.id);
+        if (!query.exec())
+            return query.lastError().text();
+
+        writeContactBegin(c);
+        while (query.next()) {
+            if (cancelled)
+                return QString();
+
+            Event e;
+            e.resource = query.value(0).toString();
+            e.date     = query.value(1).toDateTime();
+            e.type     = query.value(2).toInt();
+            e.local    = query.value(3).toInt() == 1;
+            e.subject  = query.value(4).toString();
+            e.body     = query.value(5).toString();
+            e.lang     = query.value(6).toString();
+
+            QString extra = query.value(7).toString();
+            if (!extra.isEmpty()) {
+                const auto urls = QJsonDocument::fromJson(extra.toUtf8()).object().value("jabber:x:oob").toArray();
+                for (const auto &u : urls) {
+                    const QJsonArray item = u.toArray();
+                    if (!item.isEmpty())
+                        e.urls.append({ item.at(0).toString(), item.at(1).toString() });
+                }
+            }
+            writeEvent(c, e);
+            ++done;
+
+            if (!flush(file, false))
+                return file.errorString();
+            if (timer.elapsed() - lastProgress >= progressInterval) {
+                lastProgress = timer.elapsed();
+                emit q->progress(done, total, done * 1000.0 / qMax<qint64>(lastProgress, 1));
+            }
+        }
+        query.finish();
+        writeContactEnd(c);
+    }
+    writeFooter();
+
+    if (!flush(file, true))
+        return file.errorString();
+    emit q->progress(done, done, done * 1000.0 / qMax<qint64>(timer.elapsed(), 1));
+    return QString();
+}
+
+bool HistoryExporter::Private::flush(QFile &file, bool force)
+{
+    if (out.size() < exportBufferSize && !force)
+        return true;
+    if (file.write(out) != out.size())
+        return false;
+    out.resize(0); // keeps the capacity
+    buffer.seek(0);
+    return true;
+}
+
+QString HistoryExporter::Private::nick(const Contact &c, const Event &e) const
+{
+    if (e.local)
+        return accountNicks.value(c.accId, HistoryExporter::tr("deleted"));
+    QString name = contactNames.value(c.jid);
+    if (name.isEmpty())
+        return e.resource.isEmpty() ? c.jid : c.jid + '/' + e.resource;
+    return name;
+}
+
+void HistoryExporter::Private::writeHeader()
+{
+    if (format == Xml) {
+        xml.writeStartDocument();
+        xml.writeStartElement("history");
+        xml.writeAttribute("exported", QDateTime::currentDateTime().toString(Qt::ISODate));
+    }
+}
+
+void HistoryExporter::Private::writeFooter()
+{
+    if (format == Xml) {
+        xml.writeEndElement();
+        xml.writeEndDocument();
+    }
+}
+
+void HistoryExporter::Private::writeContactBegin(const Contact &c)
+{
+    if (format == Xml) {
+        xml.writeStartElement("contact");
+        xml.writeAttribute("account", c.accId);
+        xml.writeAttribute("jid", c.jid);
+        xml.writeAttribute("type", c.type == EDB::GroupChatContact ? "groupchat" : "contact");
+        QString name = contactNames.value(c.jid);
+        if (!name.isEmpty())
+            xml.writeAttribute("name", name);
+    } else if (format == PlainText && severalContacts) {
+        QString name   = contactNames.value(c.jid);
+        QString header = name.isEmpty() ? c.jid : QString("%1 (%2)").arg(name, c.jid);
+        buffer.write(QString("==== %1 ====\n\n").arg(header).toUtf8());
+    }
+}
+
+void HistoryExporter::Private::writeContactEnd(const Contact &c)
+{
+    Q_UNUSED(c)
+    if (format == Xml)
+        xml.writeEndElement();
+}
+
+void HistoryExporter::Private::writeEvent(const Contact &c, const Event &e)
+{
+    switch (format) {
+    case PlainText: {
+        if (!isMessageType(e.type))
+            return;
+        // the same layout the export had before it was moved to a thread
+        QString txt = QString("[%1] <%2>: ").arg(QLocale().toString(e.date, QLocale::ShortFormat), nick(c, e));
+        const QStringList lines = e.body.split('\n');
+        for (const QString &str : lines) {
+            const QStringList sub = wrapString(str, 72);
+            for (const QString &str2 : sub) {
+                txt += str2 + "\n    ";
+            }
+        }
+        txt += '\n';
+        buffer.write(txt.toUtf8());
+        break;
+    }
+    case JsonLines: {
+        QJsonObject o;
+        o.insert("account", c.accId);
+        o.insert("jid", c.jid);
+        if (!e.resource.isEmpty())
+            o.insert("resource", e.resource);
+        o.insert("time", e.date.toString(Qt::ISODateWithMs));
+        o.insert("type", eventTypeName(e.type));
+        o.insert("direction", e.local ? "out" : "in");
+        o.insert("nick", nick(c, e));
+        if (!e.subject.isEmpty())
+            o.insert("subject", e.subject);
+        if (isMessageType(e.type))
+            o.insert("body", e.body);
+        if (!e.lang.isEmpty())
+            o.insert("lang", e.lang);
+        if (!e.urls.isEmpty()) {
+            QJsonArray urls;
+            for (const auto &u : e.urls) {
+                QJsonObject uo { { "url", u.first } };
+                if (!u.second.isEmpty())
+                    uo.insert("desc", u.second);
+                urls.append(uo);
+            }
+            o.insert("urls", urls);
+        }
+        buffer.write(QJsonDocument(o).toJson(QJsonDocument::Compact));
+        buffer.write("\n", 1);
+        break;
+    }
+    case Xml: {
+        xml.writeStartElement("event");
+        xml.writeAttribute("time", e.date.toString(Qt::ISODateWithMs));
+        xml.writeAttribute("type", eventTypeName(e.type));
+        xml.writeAttribute("direction", e.local ? "out" : "in");
+        if (!e.resource.isEmpty())
+            xml.writeAttribute("resource", e.resource);
+        if (!e.lang.isEmpty())
+            xml.writeAttribute("xml:lang", e.lang);
+        if (!e.subject.isEmpty())
+            xml.writeTextElement("subject", e.subject);
+        if (isMessageType(e.type))
+            xml.writeTextElement("body", e.body);
+        for (const auto &u : e.urls) {
+            xml.writeStartElement("url");
+            if (!u.second.isEmpty())
+                xml.writeAttribute("desc", u.second);
+            xml.writeCharacters(u.first);
+            xml.writeEndElement();
+        }
+        xml.writeEndElement();
+        break;
+    }
+    }
+}
+
+//----------------------------------------------------------------------------
+// HistoryExporter
+//----------------------------------------------------------------------------
+
+HistoryExporter::HistoryExporter(EDBSqLite *edb, QObject *parent) : QObject(parent), d(new Private(this, edb))
+{
+    connect(&d->watcher, &QFutureWatcher<QString>::finished, this, [this]() {
+        QString error = d->watcher.result();
+        emit finished(error.isEmpty() && !d->cancelled, error);
+    });
+}
+
+HistoryExporter::~HistoryExporter()
+{
+    cancel();
+    d->watcher.waitForFinished();
+    delete d;
+}
+
+void HistoryExporter::setAccountNick(const QString &accId, const QString &nick) { d->accountNicks.insert(accId, nick); }
+
+void HistoryExporter::setContactName(const QString &jid, const QString &name) { d->contactNames.insert(jid, name); }
+
+void HistoryExporter::start(const QString &fileName, Format format, const QString &accId, const XMPP::Jid &jid)
+{
+    if (isRunning())
+        return;
+    d->fileName = fileName;
+    d->format   = format;
+    d->accId    = accId;
+    d->jid      = jid;
+    d->cancelled = false;
+    // the worker has its own connection and can't see not yet commited events
+    d->edb->commit();
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    d->watcher.setFuture(QtConcurrent::run(&Private::run, d));
+#else
+    d->watcher.setFuture(QtConcurrent::run(d, &Private::run));
+#endif
+}
+
+void HistoryExporter::cancel() { d->cancelled = true; }
+
+bool HistoryExporter::isRunning() const { return d->watcher.isRunning(); }
+
+HistoryExporter::Format HistoryExporter::formatForFileName(const QString &fileName)
+{
+    if (fileName.endsWith(".jsonl", Qt::CaseInsensitive) || fileName.endsWith(".json", Qt::CaseInsensitive))
+        return JsonLines;
+    if (fileName.endsWith(".xml", Qt::CaseInsensitive))
+        return Xml;
+    return PlainText;
+}
@@ -0,0 +1,68 @@
+/*
+ * historyexporter.h - background export of the message history
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef HISTORYEXPORTER_H
+#define HISTORYEXPORTER_H
+
+#include "iris/xmpp_jid.h"
+
+#include <QObject>
+
+class EDBSqLite;
+
+/**
+ * Exports history from the sqlite storage in a worker thread.
+ *
+ * The worker opens its own read-only connection to the history database and
+ * reads events contact by contact with forward-only queries, so neither the
+ * GUI thread nor the EDB request queue is blocked for the export time.
+ * Output is accumulated in memory and written to the file in big chunks.
+ */
+class HistoryExporter : public QObject {
+    Q_OBJECT
+public:
+    enum Format { PlainText, JsonLines, Xml };
+
+    HistoryExporter(EDBSqLite *edb, QObject *parent = nullptr);
+    ~HistoryExporter();
+
+    // names used for the "nick" of the events. have to be set before start()
+    void setAccountNick(const QString &accId, const QString &nick);
+    void setContactName(const QString &jid, const QString &name);
+
+    // empty accId / jid means all accounts / all contacts
+    void start(const QString &fileName, Format format, const QString &accId = QString(),
+               const XMPP::Jid &jid = XMPP::Jid());
+    void cancel();
+    bool isRunning() const;
+
+    static Format formatForFileName(const QString &fileName);
+
+signals:
+    // emitted from time to time while exporting
+    void progress(qint64 done, qint64 total, double eventsPerSecond);
+    // errorString is empty on success and on cancel
+    void finished(bool success, const QString &errorString);
+
+private:
+    class Private;
+    Private *d;
+};
+
+#endif // HISTORYEXPORTER_H
@@ -27,12 +27,17 @@
 #ifdef USE_CRASH
 #include "crash.h"
 #endif
+#include "eventloopwatchdog.h"
 #include "profiledlg.h"
+#include "psiaccount.h"
 #include "psiapplication.h"
 #include "psicli.h"
 #include "psicon.h"
+#include "psicontactlist.h"
 #include "psiiconset.h"
 #include "psioptions.h"
+#include "stanzareplay.h"
+#include "tracer.h"
 #include "translationmanager.h"
 
 #include <QBitmap>
@@ -42,6 +47,7 @@
 #include <QFileInfo>
 #include <QHashIterator>
 #include <QImage>
+#include <QJsonDocument>
 #include <QLibraryInfo>
 #include <QMessageBox>
 #include <QProcess>
@@ -110,7 +116,7 @@ bool PsiMain::useActiveInstance()
     if (!autoOpen && cmdline.isEmpty()) {
         return false;
     } else if (!cmdline.contains("help") && !cmdline.contains("version") && !cmdline.contains("choose-profile")
-               && ActiveProfiles::instance()->isAnyActive()
+               && !cmdline.contains("replay") && ActiveProfiles::instance()->isAnyActive()
                && ((cmdline.contains("profile") && ActiveProfiles::instance()->isActive(cmdline["profile"]))
                    || !cmdline.contains("profile"))) {
 
@@ -141,6 +147,16 @@ bool PsiMain::useActiveInstance()
         return cmdline.contains("remote");
 }
 
+// the replay writes to the profile it runs in, so it runs only in a temporary PSIDATADIR
+static bool isTemporaryHome()
+{
+    const QString dir = qEnvironmentVariable("PSIDATADIR");
+    if (dir.isEmpty())
+        return false;
+    const QString home = QDir(dir).canonicalPath();
+    return !home.isEmpty() && home.startsWith(QDir::temp().canonicalPath() + '/');
+}
+
 /**
  * \brief Initialize this Psi instance
  */
@@ -159,6 +175,10 @@ void PsiMain::useLocalInstance()
     } else if (cmdline.contains("version")) {
         PsiCli().showVersion();
         QTimer::singleShot(0, this, SLOT(bail()));
+    } else if (cmdline.contains("replay") && !isTemporaryHome()) {
+        qWarning("replay: refusing to replay to a real profile. Set PSIDATADIR to a directory in %s",
+                 qPrintable(QDir::tempPath()));
+        QTimer::singleShot(0, this, SLOT(bail()));
     } else if (cmdline.contains("choose-profile")) {
         // Select a profile
         QTimer::singleShot(0, this, SLOT(chooseProfile()));
@@ -277,7 +297,7 @@ void PsiMain::sessionStart()
     PsiOptions::reset();
     // get a PsiCon
     pcon = new PsiCon();
-    if (!pcon->init()) {
+    if (!pcon->init(!cmdline.contains("replay"))) {
         delete pcon;
         pcon = nullptr;
         emit quit();
@@ -294,6 +314,50 @@ void PsiMain::sessionStart()
         cmdline.remove("status");
         cmdline.remove("status-message");
     }
+    if (cmdline.contains("replay")) {
+        startReplay();
+        cmdline.remove("replay");
+    }
+}
+
+/**
+ * \brief Replays stanzas to the first enabled account, reports and quits. See StanzaReplay
+ */
+void PsiMain::startReplay()
+{
+    const auto &accounts = pcon->contactList()->enabledAccounts();
+    if (accounts.isEmpty()) {
+        qWarning("replay: the profile has no enabled accounts");
+        QTimer::singleShot(0, this, SLOT(bail()));
+        return;
+    }
+
+    PsiAccount   *account = accounts.first();
+    const QString report  = cmdline.value("replay-report");
+
+    // synthetic messages are not history
+    UserAccount acc = account->accountOptions();
+    acc.opt_log     = false;
+    account->setUserAccount(acc);
+
+    auto replay = new StanzaReplay([account](const QDomElement &e) { account->injectIncomingStanza(e); }, this);
+    if (!replay->load(cmdline.value("replay"), account->jid().full())) {
+        delete replay;
+        QTimer::singleShot(0, this, SLOT(bail()));
+        return;
+    }
+    replay->setJoinHandler([account](const QString &room) { account->injectGroupChatJoin(Jid(room)); });
+    replay->setSpeed(cmdline.value("replay-speed", "1").toDouble());
+    replay->setTraceFile(report.isEmpty() ? QDir::temp().filePath("psi-replay.trace.json") : report + ".trace.json");
+    connect(replay, &StanzaReplay::finished, this, [this, replay, report]() {
+        if (report.isEmpty())
+            puts(QJsonDocument(replay->report()).toJson().constData());
+        else
+            replay->writeReport(report);
+        replay->deleteLater();
+        bail();
+    });
+    replay->start();
 }
 
 void PsiMain::sessionQuit(int x)
@@ -571,6 +635,13 @@ PSI_EXPORT_FUNC int main(int argc, char *argv[])
         Crash::registerSigsegvHandler(argv[0]);
 #endif
 
+    // PSI_TRACE=<file> records a trace from the very start (see also options.debug.trace-file)
+    const QString traceFile = qEnvironmentVariable("PSI_TRACE");
+    if (!traceFile.isEmpty())
+        Tracer::start(traceFile);
+    // always on. see Help -> Diagnostics -> Event Loop Latency
+    EventLoopWatchdog watchdog;
+
     // seed the random number generator
     srand(uint(time(nullptr)));
 
@@ -617,6 +688,7 @@ PSI_EXPORT_FUNC int main(int argc, char *argv[])
     psi->useLocalInstance();
     int returnValue = QCoreApplication::exec();
     delete psi;
+    Tracer::stop();
 
     return returnValue;
 }
@@ -52,6 +52,7 @@ private:
     PsiCon *pcon;
 
     void saveSettings();
+    void startReplay();
 };
 
 #endif // MAIN_H
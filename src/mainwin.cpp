@@ -28,6 +28,7 @@
 #include "avcall/avcall.h"
 #include "common.h"
 #include "desktoputil.h"
+#include "eventloopwatchdog.h"
 #include "eventnotifier.h"
 #include "geolocationdlg.h"
 #include "globalstatusmenu.h"
@@ -283,6 +284,7 @@ void MainWin::Private::updateMenu(const QStringList &actions, QMenu *menu)
             QMenu *diagMenu = new QMenu(tr("Diagnostics"), menu);
             getAction("help_diag_qcaplugin")->addTo(diagMenu);
             getAction("help_diag_qcakeystore")->addTo(diagMenu);
+            getAction("help_diag_eventloop")->addTo(diagMenu);
             menu->addMenu(diagMenu);
             continue;
         }
@@ -360,7 +362,16 @@ MainWin::MainWin(bool _onTop, bool _asTool, PsiCon *psi) :
     } else
         setCentralWidget(rosterBar);
 
-    connect(PsiOptions::instance(), SIGNAL(optionChanged(const QString &)), SLOT(optionChanged(const QString &)));
+    for (const QString &option : { toolbarsStateOptionPath, QStringLiteral("options.ui.contactlist.css"),
+#if defined(USE_TASKBARNOTIFIER) && defined(Q_OS_WIN)
+                                   QStringLiteral("options.ui.flash-windows"),
+#endif
+         }) {
+        PsiOptions::instance()->subscribe(option, this, [this](const QStringList &changed) {
+            for (const QString &option : changed)
+                optionChanged(option);
+        });
+    }
 
     d->vb_roster     = new QVBoxLayout(rosterBar);
     d->rosterWidget_ = new PsiRosterWidget(rosterBar);
@@ -501,6 +512,7 @@ MainWin::MainWin(bool _onTop, bool _asTool, PsiCon *psi) :
     helpMenu->addMenu(diagMenu);
     d->getAction("help_diag_qcaplugin")->addTo(diagMenu);
     d->getAction("help_diag_qcakeystore")->addTo(diagMenu);
+    d->getAction("help_diag_eventloop")->addTo(diagMenu);
     if (AvCallManager::isSupported()) {
         helpMenu->addSeparator();
         d->getAction("help_about_psimedia")->addTo(helpMenu);
@@ -683,6 +695,7 @@ void MainWin::registerAction(IconAction *action)
     cd(QStringLiteral("help_about_qt"), &IconAction::triggered, this, &MainWin::actAboutQtActivated);
     cd(QStringLiteral("help_diag_qcaplugin"), &IconAction::triggered, this, &MainWin::actDiagQCAPluginActivated);
     cd(QStringLiteral("help_diag_qcakeystore"), &IconAction::triggered, this, &MainWin::actDiagQCAKeyStoreActivated);
+    cd(QStringLiteral("help_diag_eventloop"), &IconAction::triggered, this, &MainWin::actDiagEventLoopActivated);
     // clang-format on
 
     auto connectReverse = [action](const QString &actionName, auto src, auto signal, auto slot, bool checked) {
@@ -1039,6 +1052,16 @@ void MainWin::actDiagQCAKeyStoreActivated()
     w->show();
 }
 
+void MainWin::actDiagEventLoopActivated()
+{
+    auto    watchdog = EventLoopWatchdog::instance();
+    QString dtext    = watchdog ? watchdog->report() : tr("The event loop watchdog is not running.");
+    auto    w        = new ShowTextDlg(dtext, true, false, this);
+    w->setWindowTitle(CAP(tr("Event Loop Latency")));
+    w->resize(640, 480);
+    w->show();
+}
+
 void MainWin::actChooseStatusActivated()
 {
     PsiOptions        *o = PsiOptions::instance();
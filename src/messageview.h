@@ -21,6 +21,7 @@
 #define MESSAGEVIEW_H
 
 #include "filesharingitem.h"
+#include "highlightmatcher.h"
 #include "iris/xmpp_message.h"
 
 #include <QDateTime>
@@ -132,6 +133,9 @@ public:
     inline const QString                  &reactionsId() const { return _reactionsId; }
     inline void                            setReactions(const QSet<QString> &r) { _reactions = r; }
     inline const QSet<QString>            &reactions() const { return _reactions; }
+    // highlighted parts of the plain text body (see HighlightMatcher)
+    inline void                            setHighlights(const HighlightMatcher::Spans &h) { _highlights = h; }
+    inline const HighlightMatcher::Spans  &highlights() const { return _highlights; }
 
 private:
     Type                     _type;
@@ -151,6 +155,7 @@ private:
     QString                  _reactionsId;
     QList<FileSharingItem *> _references;
     QSet<QString>            _reactions;
+    HighlightMatcher::Spans  _highlights;
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(MessageView::Flags)
@@ -178,7 +178,10 @@ ChatEdit::ChatEdit(QWidget *parent) :
 
     previous_position_ = 0;
     setCheckSpelling(checkSpellingGloballyEnabled());
-    connect(PsiOptions::instance(), &PsiOptions::optionChanged, this, &ChatEdit::optionsChanged);
+    for (const QString &option : { QString(spellOption), QString(capOption), QString(audioMessage) }) {
+        PsiOptions::instance()->subscribe(option, this,
+                                          [this, option](const QStringList &) { optionsChanged(option); });
+    }
     typedMsgsIndex = 0;
     initActions();
     setShortcuts();
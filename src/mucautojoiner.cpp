@@ -0,0 +1,122 @@
+/*
+ * mucautojoiner.cpp - schedules joining of bookmarked group chats
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "mucautojoiner.h"
+
+#include <QTimer>
+
+#include <algorithm>
+
+MucAutoJoiner::MucAutoJoiner(QObject *parent) : QObject(parent), budgetTimer_(new QTimer(this))
+{
+    budgetTimer_->setSingleShot(true);
+    connect(budgetTimer_, &QTimer::timeout, this, &MucAutoJoiner::timeout);
+}
+
+MucAutoJoiner::~MucAutoJoiner() { }
+
+void MucAutoJoiner::setConcurrency(int rooms) { concurrency_ = qMax(1, rooms); }
+
+int MucAutoJoiner::concurrency() const { return concurrency_; }
+
+void MucAutoJoiner::setBudget(int msecs) { budget_ = qMax(0, msecs); }
+
+int MucAutoJoiner::budget() const { return budget_; }
+
+void MucAutoJoiner::add(const QString &room, qint64 priority)
+{
+    if (rooms_.contains(room))
+        return;
+    if (rooms_.isEmpty())
+        elapsed_.start();
+    rooms_.insert(room, false);
+
+    auto pos = std::upper_bound(queue_.begin(), queue_.end(), priority,
+                                [](qint64 p, const Item &item) { return p > item.priority; });
+    queue_.insert(pos, { room, priority });
+    // let the caller add all the rooms it has before the first one is started
+    QTimer::singleShot(0, this, &MucAutoJoiner::next);
+}
+
+void MucAutoJoiner::finished(const QString &room)
+{
+    auto it = rooms_.find(room);
+    if (it == rooms_.end() || it.value())
+        return;
+    it.value() = true;
+    ++finished_;
+    running_.remove(room);
+    // it could be joined by the user before its turn
+    auto qit = std::find_if(queue_.begin(), queue_.end(), [&room](const Item &item) { return item.room == room; });
+    if (qit != queue_.end())
+        queue_.erase(qit);
+
+    emit progress(finished_, rooms_.size());
+    if (finished_ == rooms_.size()) {
+        auto msecs = elapsed_.elapsed();
+        clear();
+        emit done(msecs);
+        return;
+    }
+    next();
+}
+
+void MucAutoJoiner::clear()
+{
+    queue_.clear();
+    running_.clear();
+    rooms_.clear();
+    finished_ = 0;
+    budgetTimer_->stop();
+}
+
+bool MucAutoJoiner::isActive() const { return !rooms_.isEmpty(); }
+
+int MucAutoJoiner::finishedCount() const { return finished_; }
+
+int MucAutoJoiner::totalCount() const { return rooms_.size(); }
+
+void MucAutoJoiner::next()
+{
+    while (running_.size() < concurrency_ && !queue_.isEmpty()) {
+        auto room = queue_.takeFirst().room;
+        running_[room].start();
+        emit join(room); // may call finished() right away
+    }
+    if (running_.isEmpty()) {
+        budgetTimer_->stop();
+        return;
+    }
+    qint64 oldest = 0;
+    for (const auto &t : std::as_const(running_))
+        oldest = qMax(oldest, t.elapsed());
+    budgetTimer_->start(int(qMax<qint64>(0, budget_ - oldest)));
+}
+
+void MucAutoJoiner::timeout()
+{
+    // slow rooms keep joining in background but don't hold the queue anymore
+    for (auto it = running_.begin(); it != running_.end();) {
+        if (it->elapsed() >= budget_)
+            it = running_.erase(it);
+        else
+            ++it;
+    }
+    next();
+}
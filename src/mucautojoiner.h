@@ -0,0 +1,88 @@
+/*
+ * mucautojoiner.h - schedules joining of bookmarked group chats
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef MUCAUTOJOINER_H
+#define MUCAUTOJOINER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QObject>
+
+class QTimer;
+
+/**
+ * Joins rooms a few at a time instead of all at once.
+ *
+ * Every join brings the presences of all the occupants and the room history,
+ * so joining tens of rooms at once floods the connection and the ui. Rooms
+ * are started in the order of priority, at most concurrency() of them at
+ * once. The next room is started when one of the running ones is finished
+ * (joined or failed) or has been running for longer than budget().
+ */
+class MucAutoJoiner : public QObject {
+    Q_OBJECT
+public:
+    MucAutoJoiner(QObject *parent = nullptr);
+    ~MucAutoJoiner();
+
+    void setConcurrency(int rooms);
+    int  concurrency() const;
+    // ms to wait for a room before starting the next one anyway
+    void setBudget(int msecs);
+    int  budget() const;
+
+    // rooms with higher priority are joined first, rooms with the same priority in the order they were added
+    void add(const QString &room, qint64 priority);
+    // to be called when the room is joined or the join has failed
+    void finished(const QString &room);
+    // forgets everything. e.g. on disconnect
+    void clear();
+
+    bool isActive() const;
+    int  finishedCount() const;
+    int  totalCount() const;
+
+signals:
+    // the room has to be joined now
+    void join(const QString &room);
+    void progress(int finished, int total);
+    // all the rooms are finished. msecs is the time since the first room was added
+    void done(qint64 msecs);
+
+private:
+    void next();
+    void timeout();
+
+    struct Item {
+        QString room;
+        qint64  priority;
+    };
+
+    QList<Item>                   queue_;
+    QHash<QString, QElapsedTimer> running_;  // rooms counted against the concurrency
+    QHash<QString, bool>          rooms_;    // all the rooms of this round. true if finished
+    QTimer                       *budgetTimer_;
+    QElapsedTimer                 elapsed_;
+    int                           concurrency_ = 2;
+    int                           budget_      = 5000;
+    int                           finished_    = 0;
+};
+
+#endif // MUCAUTOJOINER_H
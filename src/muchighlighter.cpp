@@ -0,0 +1,65 @@
+/*
+ * muchighlighter.cpp - groupchat highlight rules shared by all groupchat dialogs
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "muchighlighter.h"
+
+#include "psioptions.h"
+
+static const QString useHighlightingOpt = QStringLiteral("options.ui.muc.use-highlighting");
+static const QString highlightWordsOpt  = QStringLiteral("options.ui.muc.highlight-words");
+
+MucHighlighter::MucHighlighter() : QObject(nullptr)
+{
+    // both options are under options.ui.muc, so a batch changing both recompiles once
+    PsiOptions::instance()->subscribe("options.ui.muc", this, [this](const QStringList &changed) {
+        if (changed.contains(useHighlightingOpt) || changed.contains(highlightWordsOpt))
+            compile();
+    });
+    connect(PsiOptions::instance(), SIGNAL(destroyed()), SLOT(reset()));
+    compile();
+}
+
+void MucHighlighter::compile()
+{
+    auto o   = PsiOptions::instance();
+    enabled_ = o->getOption(useHighlightingOpt).toBool();
+    if (enabled_)
+        matcher_.compile(o->getOption(highlightWordsOpt).toStringList());
+    else
+        matcher_.clear();
+}
+
+HighlightMatcher::Spans MucHighlighter::match(const QString &body, const QString &nick) const
+{
+    return matcher_.match(body, nick);
+}
+
+/**
+ * Returns the singleton instance of this class
+ */
+MucHighlighter *MucHighlighter::instance()
+{
+    if (!instance_)
+        instance_.reset(new MucHighlighter());
+    return instance_.get();
+}
+
+void MucHighlighter::reset() { instance_.reset(nullptr); }
+
+std::unique_ptr<MucHighlighter> MucHighlighter::instance_;
@@ -0,0 +1,56 @@
+/*
+ * muchighlighter.h - groupchat highlight rules shared by all groupchat dialogs
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef MUCHIGHLIGHTER_H
+#define MUCHIGHLIGHTER_H
+
+#include "highlightmatcher.h"
+
+#include <QObject>
+
+#include <memory>
+
+/**
+ * Keeps options.ui.muc.use-highlighting and options.ui.muc.highlight-words
+ * compiled, so groupchat dialogs don't have to read options per message.
+ */
+class MucHighlighter : public QObject {
+    Q_OBJECT
+public:
+    static MucHighlighter *instance();
+
+    inline bool isEnabled() const { return enabled_; }
+
+    // highlighted spans of a message body. the nick (own nick in the room)
+    // is always looked for, highlight words only when highlighting is enabled
+    HighlightMatcher::Spans match(const QString &body, const QString &nick) const;
+
+public slots:
+    static void reset();
+
+private:
+    MucHighlighter();
+    void compile();
+
+    static std::unique_ptr<MucHighlighter> instance_;
+    bool                                   enabled_ = false;
+    HighlightMatcher                       matcher_;
+};
+
+#endif // MUCHIGHLIGHTER_H
@@ -0,0 +1,108 @@
+/*
+ * muclastseen.cpp - last seen messages of group chats
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "muclastseen.h"
+
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
+#include <QTimer>
+
+static const quint32 fileMagic   = 0x50534d4c; // PSML
+static const quint32 fileVersion = 1;
+
+MucLastSeen::MucLastSeen(const QString &fileName, QObject *parent) :
+    QObject(parent), fileName_(fileName), saveTimer_(new QTimer(this))
+{
+    // busy rooms would make it write all the time otherwise
+    saveTimer_->setSingleShot(true);
+    saveTimer_->setInterval(10000);
+    connect(saveTimer_, &QTimer::timeout, this, &MucLastSeen::save);
+
+    load();
+}
+
+MucLastSeen::~MucLastSeen()
+{
+    if (saveTimer_->isActive())
+        save();
+}
+
+QDateTime MucLastSeen::lastSeen(const QString &room) const
+{
+    auto it = marks_.constFind(room);
+    if (it == marks_.constEnd() || !it->time)
+        return QDateTime();
+    return QDateTime::fromSecsSinceEpoch(it->time, Qt::UTC);
+}
+
+bool MucLastSeen::seen(const QString &room, const QDateTime &time, const QString &id, bool spooled)
+{
+    if (!time.isValid())
+        return true;
+
+    qint64 t = time.toSecsSinceEpoch();
+    Mark  &m = marks_[room];
+    if (spooled && m.time && (t < m.time || (t == m.time && !id.isEmpty() && m.ids.contains(id))))
+        return false;
+
+    if (t > m.time) {
+        m.time = t;
+        m.ids.clear();
+    }
+    if (t == m.time && !id.isEmpty() && !m.ids.contains(id))
+        m.ids.append(id);
+    saveTimer_->start();
+    return true;
+}
+
+void MucLastSeen::load()
+{
+    QFile f(fileName_);
+    if (!f.open(QIODevice::ReadOnly))
+        return;
+    QDataStream in(&f);
+    quint32     magic, version, count;
+    in >> magic >> version >> count;
+    if (magic != fileMagic || version != fileVersion)
+        return;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString room;
+        Mark    m;
+        in >> room >> m.time >> m.ids;
+        if (in.status() == QDataStream::Ok)
+            marks_.insert(room, m);
+    }
+}
+
+void MucLastSeen::save()
+{
+    saveTimer_->stop();
+
+    QSaveFile f(fileName_);
+    if (!f.open(QIODevice::WriteOnly)) {
+        qWarning("muclastseen: failed to save %s: %s", qPrintable(fileName_), qPrintable(f.errorString()));
+        return;
+    }
+    QDataStream out(&f);
+    out << fileMagic << fileVersion << quint32(marks_.size());
+    for (auto it = marks_.cbegin(); it != marks_.cend(); ++it)
+        out << it.key() << it->time << it->ids;
+    f.commit();
+}
@@ -0,0 +1,66 @@
+/*
+ * muclastseen.h - last seen messages of group chats
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef MUCLASTSEEN_H
+#define MUCLASTSEEN_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QObject>
+#include <QStringList>
+
+class QTimer;
+
+/**
+ * Remembers the time and the ids of the last messages received from each
+ * group chat, so on the next join only the messages sent after them are
+ * requested and the repeated part of the room history is recognized.
+ *
+ * Timestamps are compared with a precision of one second, since that's what
+ * delayed delivery stamps have. Ids are used to tell apart messages of the
+ * same second. Changes are saved to disk shortly after they are made.
+ */
+class MucLastSeen : public QObject {
+    Q_OBJECT
+public:
+    MucLastSeen(const QString &fileName, QObject *parent = nullptr);
+    ~MucLastSeen();
+
+    // time of the last message received from the room. invalid if nothing was received yet
+    QDateTime lastSeen(const QString &room) const;
+    // records a message of the room. returns false if it's a spooled message which was already seen
+    bool seen(const QString &room, const QDateTime &time, const QString &id, bool spooled);
+
+public slots:
+    void save();
+
+private:
+    struct Mark {
+        qint64      time = 0; // seconds since epoch
+        QStringList ids;      // of the messages received within that second
+    };
+
+    void load();
+
+    QString              fileName_;
+    QHash<QString, Mark> marks_;
+    QTimer              *saveTimer_;
+};
+
+#endif // MUCLASTSEEN_H
@@ -20,6 +20,7 @@
 #include "multifiletransferdlg.h"
 
 #include "avatars.h"
+#include "filesharingmanager.h"
 #include "fileutil.h"
 #include "iconset.h"
 #include "iris/jid/jid.h"
@@ -34,6 +35,7 @@
 #include "psiaccount.h"
 #include "psicon.h"
 #include "psicontact.h"
+#include "thumbnailservice.h"
 #include "ui_multifiletransferdlg.h"
 #include "userlist.h"
 
@@ -48,7 +50,6 @@
 #include <QMimeData>
 #include <QMimeDatabase>
 #include <QNetworkReply>
-#include <QPainter>
 
 using namespace XMPP;
 
@@ -403,18 +404,27 @@ void MultiFileTransferDlg::appendOutgoing(const QStringList &fileList)
         if (fi.isFile() && fi.isReadable()) {
             auto mftItem = d->model->addTransfer(MultiFileTransferModel::Outgoing, fi.fileName(), quint64(fi.size()));
 
-            QImage img(fi.filePath());
+            QSize  thumbSize(64, 64);
+            auto   thumbs  = d->account->psi()->fileSharingManager()->thumbnails();
+            bool   pending = false;
+            QImage img;
+            if (d->session) // the thumbnail is sent right away
+                img = ThumbnailService::load(fi.filePath(), thumbSize);
+            else
+                img = thumbs->image(fi.filePath(), XMPP::Hash(), thumbSize, &pending);
             if (!img.isNull()) {
-                img = img.scaled(64, 64, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-                QImage back(64, 64, QImage::Format_ARGB32_Premultiplied);
-                back.fill(Qt::transparent);
-                QPainter painter(&back);
-                auto     imgRect = img.rect();
-                imgRect.moveCenter(back.rect().center());
-                painter.drawImage(imgRect, img);
-                mftItem->setThumbnail(QIcon(QPixmap::fromImage(std::move(back))));
+                mftItem->setThumbnail(QIcon(QPixmap::fromImage(ThumbnailService::framed(img, thumbSize))));
             } else {
-                mftItem->setThumbnail(QFileIconProvider().icon(fi));
+                mftItem->setThumbnail(QFileIconProvider().icon(fi)); // also a placeholder till the image is decoded
+                if (pending) {
+                    connect(thumbs, &ThumbnailService::ready, mftItem,
+                            [mftItem, thumbSize, path = fi.filePath()](const QString &fileName, const QSize &size,
+                                                                       const QImage &image) {
+                                if (fileName == path && size == thumbSize && !image.isNull())
+                                    mftItem->setThumbnail(
+                                        QIcon(QPixmap::fromImage(ThumbnailService::framed(image, thumbSize))));
+                            });
+                }
             }
 
             mftItem->setFileName(fname);
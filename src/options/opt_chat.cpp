@@ -100,6 +100,8 @@ void OptionsTabChat::applyOptions()
         o->setOption("options.shortcuts.chat.send", vl);
     }
     o->setOption("options.ui.chat.history.preload-history-size", d->sb_msgHistCount->value());
+    o->setOption("options.history.retention.chat-days", d->sb_chatRetention->value());
+    o->setOption("options.history.retention.groupchat-days", d->sb_mucRetention->value());
 }
 
 void OptionsTabChat::restoreOptions()
@@ -123,4 +125,6 @@ void OptionsTabChat::restoreOptions()
     d->ck_chatSoftReturn->setChecked(
         ShortcutManager::instance()->shortcuts("chat.send").contains(QKeySequence(Qt::Key_Return)));
     d->sb_msgHistCount->setValue(o->getOption("options.ui.chat.history.preload-history-size").toInt());
+    d->sb_chatRetention->setValue(o->getOption("options.history.retention.chat-days").toInt());
+    d->sb_mucRetention->setValue(o->getOption("options.history.retention.groupchat-days").toInt());
 }
@@ -26,6 +26,7 @@
 #include "optionstab.h"
 #include "psicon.h"
 #include "psiiconset.h"
+#include "psioptions.h"
 
 #include <QItemDelegate>
 #include <QLabel>
@@ -463,6 +464,8 @@ void OptionsDlgBase::Private::doApply()
     if (!dirty)
         return;
 
+    // subscribers get all the options of every page at once instead of one by one
+    OptionsTree::Batch batch(PsiOptions::instance());
     for (OptionsTab *opttab : std::as_const(tabs)) {
         opttab->applyOptions();
     }
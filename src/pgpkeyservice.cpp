@@ -0,0 +1,327 @@
+/*
+ * pgpkeyservice.cpp - cached metadata of the GnuPG keyring
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "pgpkeyservice.h"
+
+#include "gpgprocess.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+
+#include <memory>
+
+static const int changeDelay = 500; // ms. gpg touches several files on each change
+
+static const char *keyringFiles[] = { "pubring.kbx", "pubring.gpg" };
+
+// colon listings escape ':' and control characters as \xNN
+static QString unescape(const QString &field)
+{
+    if (!field.contains(QLatin1String("\\x")))
+        return field;
+    const QByteArray in = field.toUtf8();
+    QByteArray       out;
+    for (int i = 0; i < in.size(); ++i) {
+        if (in[i] == '\\' && i + 3 < in.size() && in[i + 1] == 'x') {
+            bool ok;
+            int  c = in.mid(i + 2, 2).toInt(&ok, 16);
+            if (ok) {
+                out += char(c);
+                i += 3;
+                continue;
+            }
+        }
+        out += in[i];
+    }
+    return QString::fromUtf8(out);
+}
+
+PGPKeyService *PGPKeyService::instance_ = nullptr;
+
+PGPKeyService::PGPKeyService(QObject *parent) : QObject(parent)
+{
+    changeTimer_.setSingleShot(true);
+    changeTimer_.setInterval(changeDelay);
+    connect(&changeTimer_, &QTimer::timeout, this, &PGPKeyService::keyringChanged);
+    connect(&watcher_, &QFileSystemWatcher::directoryChanged, &changeTimer_, qOverload<>(&QTimer::start));
+    connect(&watcher_, &QFileSystemWatcher::fileChanged, &changeTimer_, qOverload<>(&QTimer::start));
+    watch();
+}
+
+PGPKeyService::~PGPKeyService()
+{
+    if (instance_ == this)
+        instance_ = nullptr;
+}
+
+PGPKeyService *PGPKeyService::instance()
+{
+    if (!instance_)
+        instance_ = new PGPKeyService(QCoreApplication::instance());
+    return instance_;
+}
+
+bool PGPKeyService::isReady() const { return ready_; }
+
+void PGPKeyService::key(const QString &keyId, QObject *context, const std::function<void(const Key &)> &callback)
+{
+    if (ready_) {
+        callback(find(keyId));
+        return;
+    }
+
+    auto connection = std::make_shared<QMetaObject::Connection>();
+    auto once       = [keyId, callback, connection](const QString &id, const PGPKeyService::Key &key) {
+        if (id != keyId)
+            return;
+        QObject::disconnect(*connection);
+        callback(key);
+    };
+    *connection = connect(this, &PGPKeyService::keyReady, context, once);
+    waiting_.insert(keyId);
+    if (!listing_)
+        reload();
+}
+
+void PGPKeyService::publicKeyData(const QString &keyId, QObject *context,
+                                  const std::function<void(const QString &)> &callback)
+{
+    const QString k  = normalized(keyId);
+    auto          it = exports_.constFind(k);
+    if (it != exports_.cend()) {
+        callback(*it);
+        return;
+    }
+
+    auto connection = std::make_shared<QMetaObject::Connection>();
+    auto once       = [k, callback, connection](const QString &id, const QString &data) {
+        if (id != k)
+            return;
+        QObject::disconnect(*connection);
+        callback(data);
+    };
+    *connection = connect(this, &PGPKeyService::publicKeyDataReady, context, once);
+    if (exporting_.contains(k))
+        return;
+    exporting_.insert(k);
+
+    auto gpg        = new GpgProcess(this);
+    int  generation = generation_;
+    connect(gpg, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this,
+            [this, gpg, k, generation]() { exported(gpg, k, generation); });
+    connect(gpg, &QProcess::errorOccurred, this, [this, gpg, k, generation](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart)
+            exported(gpg, k, generation);
+    });
+    gpg->start({ "--armor", "--export", "0x" + k }, QIODevice::ReadOnly);
+}
+
+void PGPKeyService::exported(GpgProcess *gpg, const QString &keyId, int generation)
+{
+    gpg->deleteLater();
+    exporting_.remove(keyId);
+
+    QString data;
+    if (gpg->error() != QProcess::FailedToStart && gpg->success()) {
+        data = QString::fromUtf8(gpg->readAllStandardOutput());
+#ifdef Q_OS_WIN
+        data.remove('\r');
+#endif
+    }
+    // the keyring has changed meanwhile. the export may be stale already
+    if (!data.isEmpty() && generation == generation_)
+        exports_.insert(keyId, data);
+    emit publicKeyDataReady(keyId, data);
+}
+
+QString PGPKeyService::formatFingerprint(const QString &fingerprint)
+{
+    if (fingerprint.size() != 40)
+        return QString();
+    QString ret = fingerprint;
+    for (int k = ret.size() - 4; k >= 3; k -= 4)
+        ret.insert(k, ' ');
+    ret.insert(24, ' ');
+    return ret;
+}
+
+QString PGPKeyService::homeDir()
+{
+    const QString env = QString::fromLocal8Bit(qgetenv("GNUPGHOME"));
+    if (!env.isEmpty())
+        return env;
+#ifdef Q_OS_WIN
+    return QString::fromLocal8Bit(qgetenv("APPDATA")) + "/gnupg";
+#else
+    return QDir::homePath() + "/.gnupg";
+#endif
+}
+
+void PGPKeyService::reload()
+{
+    if (listing_) {
+        // whatever is being listed may be outdated already
+        listAgain_ = true;
+        return;
+    }
+
+    ready_    = false;
+    stamp_    = keyringStamp();
+    listing_  = new GpgProcess(this);
+    auto done = [this, gpg = listing_]() {
+        if (listing_ == gpg)
+            listed();
+    };
+    connect(listing_, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this, done);
+    connect(listing_, &QProcess::errorOccurred, this, [done](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart)
+            done();
+    });
+    listing_->start({ "--list-public-keys", "--with-colons", "--fixed-list-mode", "--with-fingerprint" },
+                    QIODevice::ReadOnly);
+}
+
+void PGPKeyService::listed()
+{
+    auto gpg = listing_;
+    listing_ = nullptr;
+    gpg->deleteLater();
+
+    keys_.clear();
+    index_.clear();
+    if (gpg->error() != QProcess::FailedToStart && gpg->success())
+        parse(QString::fromUtf8(gpg->readAllStandardOutput()));
+
+    if (listAgain_) {
+        listAgain_ = false;
+        reload();
+        return;
+    }
+
+    ready_         = true;
+    const auto ids = std::move(waiting_);
+    waiting_.clear();
+    for (const auto &id : ids)
+        emit keyReady(id, find(id));
+    emit keysChanged();
+}
+
+void PGPKeyService::parse(const QString &listing)
+{
+    enum { None, Primary, Subkey } fingerprintOf = None;
+
+    const auto addIds = [this](const QString &id) {
+        if (id.isEmpty())
+            return;
+        index_.insert(id, keys_.size() - 1);
+        index_.insert(id.right(8), keys_.size() - 1);
+    };
+
+    const auto lines = listing.split('\n');
+    for (const auto &line : lines) {
+        const auto fields = line.split(':');
+        const auto type   = fields.value(0);
+        if (type == QLatin1String("pub")) {
+            keys_.append(Key { fields.value(4).toUpper(), QString(), QString() });
+            addIds(keys_.last().id);
+            fingerprintOf = Primary;
+        } else if (keys_.isEmpty()) {
+            continue;
+        } else if (type == QLatin1String("sub")) {
+            addIds(fields.value(4).toUpper());
+            fingerprintOf = Subkey;
+        } else if (type == QLatin1String("fpr") && fingerprintOf != None) {
+            const QString fpr = fields.value(9).toUpper();
+            if (fingerprintOf == Primary)
+                keys_.last().fingerprint = fpr;
+            if (!fpr.isEmpty())
+                index_.insert(fpr, keys_.size() - 1);
+            fingerprintOf = None;
+        } else if (type == QLatin1String("uid") && keys_.last().ownerName.isEmpty()) {
+            keys_.last().ownerName = unescape(fields.value(9));
+        }
+    }
+}
+
+QString PGPKeyService::normalized(const QString &keyId)
+{
+    QString k = keyId.trimmed().toUpper();
+    if (k.startsWith(QLatin1String("0X")))
+        k.remove(0, 2);
+    k.remove(' ');
+    return k;
+}
+
+PGPKeyService::Key PGPKeyService::find(const QString &keyId) const
+{
+    const QString k = normalized(keyId);
+    // a long id is the tail of the fingerprint, a short id is the tail of a long id
+    int i = index_.value(k, -1);
+    if (i == -1 && k.size() > 16)
+        i = index_.value(k.right(16), -1);
+    return i == -1 ? Key() : keys_[i];
+}
+
+QString PGPKeyService::keyringStamp()
+{
+    QString    stamp;
+    const QDir home(homeDir());
+    for (const char *name : keyringFiles) {
+        QFileInfo fi(home.filePath(name));
+        if (fi.exists())
+            stamp += QString("%1:%2:%3;").arg(name).arg(fi.size()).arg(fi.lastModified().toMSecsSinceEpoch());
+    }
+    return stamp;
+}
+
+void PGPKeyService::watch()
+{
+    const QDir  home(homeDir());
+    QStringList paths;
+    if (home.exists())
+        paths << home.absolutePath();
+    for (const char *name : keyringFiles) {
+        if (home.exists(name))
+            paths << home.filePath(name);
+    }
+    // gpg replaces the files, and a replaced file is no longer watched
+    const auto watched = watcher_.files() + watcher_.directories();
+    for (const auto &path : std::as_const(watched))
+        paths.removeAll(path);
+    if (!paths.isEmpty())
+        watcher_.addPaths(paths);
+}
+
+void PGPKeyService::keyringChanged()
+{
+    watch();
+    // lock files, agent sockets and the trust database change often enough.
+    // only the keyring itself matters
+    if (keyringStamp() == stamp_)
+        return;
+
+    ++generation_;
+    exports_.clear();
+    // nobody has asked for anything yet, nothing to refresh
+    if (!ready_ && !listing_)
+        return;
+    reload();
+}
@@ -0,0 +1,111 @@
+/*
+ * pgpkeyservice.h - cached metadata of the GnuPG keyring
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PGPKEYSERVICE_H
+#define PGPKEYSERVICE_H
+
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QTimer>
+
+#include <functional>
+
+class GpgProcess;
+
+/**
+ * Metadata of the public keys in the GnuPG keyring.
+ *
+ * The whole keyring is listed with a single gpg run in the background and
+ * lookups are answered from memory after that. Armored exports are cached
+ * too. When the keyring files change everything is dropped and the keyring
+ * is listed again. Nothing here waits for gpg, the results come with signals
+ * or with callbacks called from them.
+ *
+ * Key ids may be given in any form gpg accepts: short or long ids, or
+ * fingerprints, with or without "0x", of the primary key or a subkey.
+ */
+class PGPKeyService : public QObject {
+    Q_OBJECT
+public:
+    struct Key {
+        QString id;          // long id of the primary key. empty if there is no such key
+        QString fingerprint; // 40 hex digits
+        QString ownerName;   // the first user id
+
+        bool isNull() const { return id.isEmpty(); }
+    };
+
+    PGPKeyService(QObject *parent = nullptr);
+    ~PGPKeyService();
+
+    static PGPKeyService *instance();
+
+    // the keyring was listed and has not changed since
+    bool isReady() const;
+
+    // callback is called once, right away if the keyring is listed already.
+    // it is not called at all if context is destroyed before that
+    void key(const QString &keyId, QObject *context, const std::function<void(const Key &)> &callback);
+    // armored public key, or an empty string if it could not be exported
+    void publicKeyData(const QString &keyId, QObject *context, const std::function<void(const QString &)> &callback);
+
+    // groups of 4 hex digits as gpg prints them. empty if it's not a fingerprint
+    static QString formatFingerprint(const QString &fingerprint);
+    // GNUPGHOME or the default GnuPG home of the platform
+    static QString homeDir();
+
+public slots:
+    void reload();
+
+signals:
+    void keysChanged();
+    void keyReady(const QString &keyId, const PGPKeyService::Key &key);
+    void publicKeyDataReady(const QString &keyId, const QString &data);
+
+private:
+    static QString normalized(const QString &keyId);
+    static QString keyringStamp();
+
+    Key  find(const QString &keyId) const;
+    void parse(const QString &listing);
+    void listed();
+    void exported(GpgProcess *gpg, const QString &keyId, int generation);
+    void watch();
+    void keyringChanged();
+
+    static PGPKeyService *instance_;
+
+    QList<Key>              keys_;
+    QHash<QString, int>     index_;   // upper case ids and fingerprints, of subkeys too
+    QSet<QString>           waiting_; // keys asked for while listing
+    QHash<QString, QString> exports_;
+    QSet<QString>           exporting_;
+    GpgProcess             *listing_    = nullptr;
+    bool                    ready_      = false;
+    bool                    listAgain_  = false;
+    int                     generation_ = 0;
+    QString                 stamp_; // of the keyring files at the last listing
+    QFileSystemWatcher      watcher_;
+    QTimer                  changeTimer_;
+};
+
+#endif // PGPKEYSERVICE_H
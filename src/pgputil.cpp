@@ -48,9 +48,16 @@ PGPUtil &PGPUtil::instance()
 
 bool PGPUtil::pgpAvailable()
 {
+    // asked for every encrypted message and chat menu. gpg is not going anywhere
+    // once found, while a missing one may be installed later
+    if (m_available && (*m_available || m_availableChecked.elapsed() < 30000))
+        return *m_available;
+
     QString    message;
     GpgProcess gpg;
-    return gpg.info(message);
+    m_available = gpg.info(message);
+    m_availableChecked.start();
+    return *m_available;
 }
 
 QString PGPUtil::stripHeaderFooter(const QString &str)
@@ -121,89 +128,6 @@ bool PGPUtil::equals(const QString &k1, const QString &k2)
     }
 }
 
-QString PGPUtil::getKeyOwnerName(const QString &key)
-{
-    if (key.isEmpty())
-        return QString();
-
-    const QStringList &&arguments = { "--list-public-keys", "--with-colons", "--fixed-list-mode", "0x" + key };
-
-    GpgProcess gpg;
-    gpg.start(arguments);
-    gpg.waitForFinished();
-
-    if (!gpg.success())
-        return QString();
-
-    const QString &&rawData = QString::fromUtf8(gpg.readAllStandardOutput());
-    if (rawData.isEmpty())
-        return QString();
-
-    QString             name;
-    const QStringList &&stringsList = rawData.split("\n");
-    for (const QString &line : stringsList) {
-        const QString &&type = line.section(':', 0, 0);
-        if (type == "uid") {
-            name = line.section(':', 9, 9); // Name
-            break;
-        }
-    }
-    return name;
-}
-
-QString PGPUtil::getPublicKeyData(const QString &key)
-{
-    if (key.isEmpty())
-        return QString();
-
-    const QStringList &&arguments = { "--armor", "--export", "0x" + key };
-
-    GpgProcess gpg;
-    gpg.start(arguments);
-    gpg.waitForFinished();
-
-    if (!gpg.success())
-        return QString();
-
-#ifdef Q_OS_WIN
-    QString keyData = QString::fromUtf8(gpg.readAllStandardOutput());
-    keyData.replace("\r", "");
-#else
-    const QString &&keyData = QString::fromUtf8(gpg.readAllStandardOutput());
-#endif
-    return keyData;
-}
-
-QString PGPUtil::getFingerprint(const QString &key)
-{
-    const QStringList &&arguments = { "--with-colons", "--fingerprint", "0x" + key };
-
-    GpgProcess gpg;
-    gpg.start(arguments);
-    gpg.waitForFinished();
-
-    QString             fingerprint;
-    const QString     &&out   = QString::fromUtf8(gpg.readAllStandardOutput());
-    const QStringList &&lines = out.split("\n");
-    for (const QString &line : lines) {
-        const QString &&type = line.section(':', 0, 0);
-        if (type == "fpr") {
-            fingerprint = line.section(':', 9, 9);
-            break;
-        }
-    }
-
-    if (fingerprint.size() == 40) {
-        for (int k = fingerprint.size() - 4; k >= 3; k -= 4) {
-            fingerprint.insert(k, ' ');
-        }
-        fingerprint.insert(24, ' ');
-        return fingerprint;
-    }
-
-    return QString();
-}
-
 QString PGPUtil::chooseKey(PGPKeyDlg::Type type, const QString &key, const QString &title)
 {
     PGPKeyDlg d(type, key, nullptr);
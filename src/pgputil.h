@@ -26,11 +26,14 @@
 #pragma once
 
 #include "pgpkeydlg.h"
+#include <QElapsedTimer>
 #include <QList>
 #include <QMap>
 #include <QSet>
 #include <QString>
 
+#include <optional>
+
 class PGPUtil : public QObject {
     Q_OBJECT
 
@@ -46,9 +49,6 @@ public:
 
     bool equals(const QString &, const QString &);
 
-    static QString getKeyOwnerName(const QString &key);
-    static QString getPublicKeyData(const QString &key);
-    static QString getFingerprint(const QString &key);
     static QString chooseKey(PGPKeyDlg::Type type, const QString &key, const QString &title);
 
     struct SecureMessageSignature {
@@ -73,4 +73,7 @@ protected:
 
 private:
     static PGPUtil *m_instance;
+
+    std::optional<bool> m_available;
+    QElapsedTimer       m_availableChecked;
 };
@@ -103,7 +103,11 @@ PluginManager::PluginManager() : QObject(nullptr), psi_(nullptr)
     _messageViewJSFiltersTimer->setInterval(10); // to be able to restart in case of batch events
     connect(_messageViewJSFiltersTimer, &QTimer::timeout, this, &PluginManager::jsFiltersUpdated);
 
-    connect(PsiOptions::instance(), &PsiOptions::optionChanged, this, &PluginManager::optionChanged);
+    // OptionAccessor plugins are told about every option
+    PsiOptions::instance()->subscribe(QString(), this, [this](const QStringList &changed) {
+        for (const QString &option : changed)
+            optionChanged(option);
+    });
 }
 
 void PluginManager::initNewSession(PsiCon *psi)
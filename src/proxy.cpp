@@ -426,6 +426,7 @@ void ProxyForObject::save()
         QString val = items_.value(obj);
         ot_->setOption(base + obj, QVariant(val));
     }
+    emit saved();
 }
 
 QComboBox *ProxyForObject::getComboBox(ProxyChooser *pc, QWidget *p)
@@ -488,6 +489,7 @@ void ProxyManager::init(OptionsTree *o)
     d->o = o;
     delete d->po;
     d->po = new ProxyForObject(o, this);
+    connect(d->po, &ProxyForObject::saved, this, &ProxyManager::settingsChanged);
 }
 
 ProxyManager::~ProxyManager() { delete d; }
@@ -113,6 +113,9 @@ public:
     void       save();
     QComboBox *getComboBox(ProxyChooser *pc, QWidget *p = nullptr);
 
+signals:
+    void saved(); // the proxy choices are in the options tree now
+
 private slots:
     void currentItemChanged(int);
     void updateCurrentItem();
@@ -73,6 +73,8 @@
 #include "iris/jingle-session.h"
 #include "mood.h"
 #include "mooddlg.h"
+#include "mucautojoiner.h"
+#include "muclastseen.h"
 #include "networkaccessmanager.h"
 #include "passdialog.h"
 #include "pepmanager.h"
@@ -111,6 +113,7 @@
 #include "tabdlg.h"
 #include "tabmanager.h"
 #include "textutil.h"
+#include "tracer.h"
 #include "translationmanager.h"
 #include "tune.h"
 #include "userlist.h"
@@ -118,6 +121,7 @@
 #include "voicecalldlg.h"
 #include "voicecaller.h"
 #include "xmlconsole.h"
+#include "xmlring.h"
 #ifdef FILETRANSFER
 #include "filetransdlg.h"
 #include "iris/filetransfer.h"
@@ -139,6 +143,8 @@
 #endif
 
 #include <QApplication>
+#include <QDir>
+#include <QElapsedTimer>
 #include <QFileDialog>
 #include <QFileInfo>
 #include <QFrame>
@@ -155,6 +161,7 @@
 #include <QPointer>
 #include <QPushButton>
 #include <QQueue>
+#include <QSet>
 #include <QTimer>
 #include <QUrl>
 #include <QtCrypto>
@@ -365,7 +372,7 @@ static QList<ReconnectData> reconnectData()
 class PsiAccount::Private : public Alertable {
     Q_OBJECT
 public:
-    Private(PsiAccount *parent) : Alertable(parent), account(parent), xmlRingbuf(1000)
+    Private(PsiAccount *parent) : Alertable(parent), account(parent)
     {
         reconnectTimeoutTimer_ = new QTimer(this);
         reconnectTimeoutTimer_->setSingleShot(true);
@@ -383,6 +390,11 @@ public:
             client->close(true);
             finishLogout();
         });
+
+        xmlFlushTimer = new QTimer(this);
+        xmlFlushTimer->setInterval(XmlRing::CaptureFlushDelay);
+        xmlFlushTimer->setSingleShot(true);
+        connect(xmlFlushTimer, &QTimer::timeout, this, [this]() { xmlRing.flushCapture(); });
     }
 
     PsiContactList          *contactList          = nullptr;
@@ -391,6 +403,8 @@ public:
     PsiAccount              *account              = nullptr;
     Client                  *client               = nullptr;
     PsiEncryptionController *encryptionController = nullptr;
+    MucLastSeen             *mucLastSeen          = nullptr;
+    MucAutoJoiner           *mucAutoJoiner        = nullptr;
     QVariantMap              clientVersionInfo;
     FileSharingDeviceOpener *fileSharingDeviceOpener = nullptr;
     UserAccount              acc;
@@ -416,6 +430,10 @@ public:
     int                      currentConnectionErrorCondition = -1;
     QTimer                  *updateOnlineContactsCountTimer_ = nullptr;
     QTimer                  *logoutTimer                     = nullptr;
+    QTimer                  *xmlFlushTimer                   = nullptr; // a crash loses at most its interval
+
+    QHash<QString, ConferenceBookmark> autoJoinBookmarks; // bare jid -> bookmark waiting for its turn
+    QElapsedTimer                      loginTimer;        // for the login timing stats
 
     // Tune
     Tune lastTune;
@@ -462,6 +480,7 @@ public:
 
     QList<GCContact *> gcbank;
     QStringList        groupchats;
+    QSet<QString>      injectedJoins; // rooms joined by the stanza replay, there is no join dialog
 
     QPointer<AdvancedConnector> conn;
     QPointer<ClientStream>      stream;
@@ -469,8 +488,7 @@ public:
     QPointer<QCATLSHandler>     tlsHandler;
     bool                        usingSSL = false;
 
-    QVector<xmlRingElem> xmlRingbuf;
-    int                  xmlRingbufWrite = 0;
+    XmlRing xmlRing;
 
     QHostAddress localAddress;
 
@@ -706,19 +724,29 @@ public slots:
         emit account->disconnected();
     }
 
-    void client_xmlIncoming(const QString &s)
+    void client_xmlIncoming(const QString &s) { appendXml(XmlRing::In, s); }
+    void client_xmlOutgoing(const QString &s) { appendXml(XmlRing::Out, s); }
+
+    void appendXml(XmlRing::Type type, const QString &s)
     {
-        xmlRingbuf[xmlRingbufWrite].type = RingXmlIn;
-        xmlRingbuf[xmlRingbufWrite].xml  = s;
-        xmlRingbuf[xmlRingbufWrite].time = QDateTime::currentDateTime();
-        xmlRingbufWrite                  = (xmlRingbufWrite + 1) % xmlRingbuf.count();
+        xmlRing.append(type, s);
+        if (xmlRing.hasUnflushedCapture() && !xmlFlushTimer->isActive())
+            xmlFlushTimer->start();
     }
-    void client_xmlOutgoing(const QString &s)
+
+    void updateXmlRing()
     {
-        xmlRingbuf[xmlRingbufWrite].type = RingXmlOut;
-        xmlRingbuf[xmlRingbufWrite].xml  = s;
-        xmlRingbuf[xmlRingbufWrite].time = QDateTime::currentDateTime();
-        xmlRingbufWrite                  = (xmlRingbufWrite + 1) % xmlRingbuf.count();
+        auto o = PsiOptions::instance();
+        xmlRing.setByteBudget(o->getOption("options.xml-console.ring.size").toLongLong() * 1024);
+        xmlRing.setCompression(o->getOption("options.xml-console.ring.compress").toBool());
+        QString capture;
+        if (o->getOption("options.xml-console.capture.enabled").toBool()) {
+            QString dir = pathToProfile(activeProfile, ApplicationInfo::CacheLocation);
+            QDir().mkpath(dir);
+            capture = dir + "/xml-capture-" + JIDUtil::encode(acc.id).toLower() + ".bin";
+        }
+        xmlRing.setCapture(capture, o->getOption("options.xml-console.capture.file-size").toLongLong() * 1024,
+                           o->getOption("options.xml-console.capture.files").toInt());
     }
 
     void client_stanzaElementOutgoing(QDomElement &s)
@@ -776,14 +804,16 @@ public:
     // implementation for QList<PsiAccount::xmlRingElem> PsiAccount::dumpRingbuf()
     QList<xmlRingElem> dumpRingbuf()
     {
-        xmlRingElem        el;
+        // the capture goes further back than the memory ring
+        xmlRing.flushCapture();
+        const auto records = xmlRing.captureFile().isEmpty()
+            ? xmlRing.records()
+            : XmlRing::readCapture(xmlRing.captureFile(),
+                                   PsiOptions::instance()->getOption("options.xml-console.capture.files").toInt());
         QList<xmlRingElem> ret;
-        for (int i = 0; i < xmlRingbuf.count(); i++) {
-            el = xmlRingbuf[(xmlRingbufWrite + i) % xmlRingbuf.count()];
-            if (!el.xml.isEmpty()) {
-                ret += el;
-            }
-        }
+        ret.reserve(records.size());
+        for (const auto &r : records)
+            ret.append({ int(r.type), r.time, r.xml });
         return ret;
     }
     QWidget *findDialog(const QMetaObject &mo, const Jid &jid, bool compareResource) const
@@ -1067,6 +1097,10 @@ PsiAccount::PsiAccount(const UserAccount &acc, PsiContactList *parent, TabManage
     // create XMPP::Client
     d->client = new Client;
 
+    d->mucLastSeen = new MucLastSeen(pathToProfile(activeProfile, ApplicationInfo::DataLocation) + "/muc-last-seen-"
+                                         + JIDUtil::encode(acc.id).toLower() + ".dat",
+                                     this);
+
     d->encryptionController
         = new PsiEncryptionController(this, d->client, acc.encryptionMethods,
                                       pathToProfile(activeProfile, ApplicationInfo::DataLocation), acc.id, this);
@@ -1186,6 +1220,25 @@ PsiAccount::PsiAccount(const UserAccount &acc, PsiContactList *parent, TabManage
     d->bookmarkManager = new BookmarkManager(this);
     connect(d->bookmarkManager, &BookmarkManager::availabilityChanged, this, &PsiAccount::bookmarksAvailabilityChanged);
 
+    d->mucAutoJoiner = new MucAutoJoiner(this);
+    connect(d->mucAutoJoiner, &MucAutoJoiner::join, this, [this](const QString &room) {
+        auto it = d->autoJoinBookmarks.find(room);
+        if (it == d->autoJoinBookmarks.end() || findDialog<GCMainDlg *>(Jid(room))) {
+            d->mucAutoJoiner->finished(room); // removed or joined by the user meanwhile
+            return;
+        }
+        auto c = it.value();
+        d->autoJoinBookmarks.erase(it);
+        actionJoin(c, true, false);
+    });
+    connect(d->mucAutoJoiner, &MucAutoJoiner::progress, this, [this](int finished, int total) {
+        qDebug("%s: %d of %d rooms are joined", qPrintable(name()), finished, total);
+    });
+    connect(d->mucAutoJoiner, &MucAutoJoiner::done, this, [this](qint64 msecs) {
+        qDebug("%s: rooms are joined in %lld ms, %lld ms since login started", qPrintable(name()), msecs,
+               d->loginTimer.isValid() ? d->loginTimer.elapsed() : -1LL);
+    });
+
 #ifdef USE_PEP
     // Tune Controller
     connect(d->psi->tuneManager(), &TuneControllerManager::stopped, this, &PsiAccount::tuneStopped);
@@ -1219,6 +1272,9 @@ PsiAccount::PsiAccount(const UserAccount &acc, PsiContactList *parent, TabManage
     setUserAccount(acc);
     connect(ProxyManager::instance(), &ProxyManager::proxyRemoved, d, &Private::pm_proxyRemoved);
 
+    d->updateXmlRing();
+    PsiOptions::instance()->subscribe("options.xml-console", d, [this](const QStringList &) { d->updateXmlRing(); });
+
     connect(d->psi, &PsiCon::emitOptionsUpdate, this, &PsiAccount::optionsUpdate);
 
     d->setEnabled(enabled());
@@ -1335,6 +1391,10 @@ void PsiAccount::cleanupStream()
     d->usingSSL = false;
 
     d->localAddress = QHostAddress();
+
+    // the rooms will be scheduled again with the bookmarks of the next session
+    d->mucAutoJoiner->clear();
+    d->autoJoinBookmarks.clear();
 }
 
 void PsiAccount::updateAlwaysVisibleContact(PsiContact *pc)
@@ -1760,6 +1820,7 @@ void PsiAccount::login()
 
     Jid j = d->jid.withResource((d->acc.opt_automatic_resource ? localHostName() : d->acc.resource));
     d->stream->setSMEnabled(d->acc.opt_sm);
+    d->loginTimer.start();
     d->client->connectToServer(d->stream, j);
 }
 
@@ -2025,6 +2086,7 @@ void PsiAccount::sessionStart_finished()
 
 void PsiAccount::sessionStarted()
 {
+    qDebug("%s: session is started in %lld ms", qPrintable(name()), d->loginTimer.elapsed());
 #ifdef IRIS_ENABLE_OMEMO
     if (d->encryptionController)
         d->encryptionController->setUpOmemo(ApplicationInfo::name());
@@ -2389,6 +2451,7 @@ void PsiAccount::client_rosterRequestFinished(bool success, int, const QString &
     // we need to have up-to-date photoHash for initial presence
     d->vcardChanged(jid(), {});
     setStatusDirect(d->loginStatus, d->loginWithPriority);
+    qDebug("%s: roster is received in %lld ms since login started", qPrintable(name()), d->loginTimer.elapsed());
 
     emit rosterRequestFinished();
 }
@@ -2511,13 +2574,26 @@ void PsiAccount::bookmarksAvailabilityChanged()
             auto ul = findRelevant(Jid(QString(), cj.domain()));
             if (ul.isEmpty() || !ul[0]->isTransport()
                 || !ul[0]->resourceList().isEmpty()) { // don't join to MUCs on disconnected transports
-                actionJoin(c, true, false);
+                scheduleAutoJoin(c);
             }
         }
     }
 #endif
 }
 
+void PsiAccount::scheduleAutoJoin(const ConferenceBookmark &c)
+{
+    auto o = PsiOptions::instance();
+    d->mucAutoJoiner->setConcurrency(o->getOption("options.muc.bookmarks.auto-join-concurrency").toInt());
+    d->mucAutoJoiner->setBudget(o->getOption("options.muc.bookmarks.auto-join-budget").toInt());
+
+    // rooms with the latest messages go first. the rest in the order of bookmarks
+    QString   room     = c.jid().bare();
+    QDateTime lastSeen = d->mucLastSeen->lastSeen(room);
+    d->autoJoinBookmarks.insert(room, c);
+    d->mucAutoJoiner->add(room, lastSeen.isValid() ? lastSeen.toSecsSinceEpoch() : 0);
+}
+
 void PsiAccount::incomingHttpAuthRequest(const PsiHttpAuthRequest &req)
 {
     HttpAuthEvent::Ptr e(new HttpAuthEvent(req, this));
@@ -2591,6 +2667,7 @@ void PsiAccount::incomingVoiceCall(const Jid &j)
 
 void PsiAccount::client_resourceAvailable(const Jid &j, const Resource &r)
 {
+    TRACE_SPAN("PsiAccount::client_resourceAvailable");
     // Notification
     enum PopupType { PopupOnline = 0, PopupStatusChange = 1 };
     PopupType popupType = PopupOnline;
@@ -2665,7 +2742,7 @@ void PsiAccount::client_resourceAvailable(const Jid &j, const Resource &r)
                 Jid cj = c.jid().withResource(QString());
                 if (u->jid().domain() == cj.domain() && !findDialog<GCMainDlg *>(cj) && c.needJoin()) {
                     // now join MUCs on connected transport
-                    actionJoin(c, true, false);
+                    scheduleAutoJoin(c);
                 }
             }
         }
@@ -2814,6 +2891,7 @@ void PsiAccount::client_presenceError(const Jid &j, int, const QString &str)
 
 void PsiAccount::client_messageReceived(const Message &m)
 {
+    TRACE_SPAN("PsiAccount::client_messageReceived");
     Message _m(m);
     Message dm = _m.displayMessage();
 
@@ -2941,6 +3019,10 @@ void PsiAccount::processIncomingMessage(const Message &_m)
 
 #ifdef GROUPCHAT
     if (dm.type() == Message::Type::Groupchat) {
+        // rooms send their history on every join. skip the part of it which was already shown
+        if (!dm.body().isEmpty() && !d->mucLastSeen->seen(dm.from().bare(), dm.timeStamp(), dm.id(), dm.spooled())
+            && PsiOptions::instance()->getOption("options.muc.context.only-unseen").toBool())
+            return;
         MessageEvent::Ptr me(new MessageEvent(_m, this));
         me->setOriginLocal(false);
         handleEvent(me, IncomingStanza);
@@ -5921,6 +6003,12 @@ bool PsiAccount::groupChatJoin(const QString &host, const QString &room, const Q
         GCMainDlg *w = findDialog<GCMainDlg *>(Jid(room, host));
         if (w)
             since = w->lastMsgTime();
+        if (PsiOptions::instance()->getOption("options.muc.context.only-unseen").toBool()) {
+            // known after restart as well. and it's never older than the last message shown
+            QDateTime lastSeen = d->mucLastSeen->lastSeen(Jid(room, host).bare());
+            if (lastSeen.isValid() && (!since.isValid() || lastSeen > since))
+                since = lastSeen;
+        }
 
         Status s = d->loginStatus;
         s.setXSigned("");
@@ -6020,17 +6108,22 @@ void PsiAccount::client_groupChatJoined(const Jid &j)
 #ifdef GROUPCHAT
     // d->client->groupChatSetStatus(j.host(), j.user(), d->loginStatus);
 
+    d->mucAutoJoiner->finished(j.bare());
+
     GCMainDlg *m = findDialog<GCMainDlg *>(Jid(j.bare()));
     if (m) {
         m->setPassword(d->client->groupChatPassword(j.domain(), j.node()));
         m->joined();
         return;
     }
-    MUCJoinDlg *w = findDialog<MUCJoinDlg *>(j);
-    if (!w)
+    MUCJoinDlg               *w = findDialog<MUCJoinDlg *>(j);
+    MUCJoinDlg::MucJoinReason r = MUCJoinDlg::MucAutoJoin;
+    if (w) {
+        r = w->getReason();
+        w->joined();
+    } else if (!d->injectedJoins.remove(j.bare())) {
         return;
-    auto r = w->getReason();
-    w->joined();
+    }
 
     GCMainDlg *chat = new GCMainDlg(this, j, d->tabManager);
     chat->setPassword(d->client->groupChatPassword(j.domain(), j.node()));
@@ -6106,6 +6199,7 @@ void PsiAccount::client_groupChatPresence(const Jid &j, const Status &s)
 void PsiAccount::client_groupChatError(const Jid &j, int code, const QString &str)
 {
 #ifdef GROUPCHAT
+    d->mucAutoJoiner->finished(j.bare());
     GCMainDlg *w = findDialog<GCMainDlg *>(Jid(j.bare()));
     if (w) {
         w->error(code, str);
@@ -6610,11 +6704,23 @@ QList<PsiAccount::xmlRingElem> PsiAccount::dumpRingbuf() { return d->dumpRingbuf
 /**
  * Frees ringbuffer memory and makes it compact.
  */
-void PsiAccount::clearRingbuf()
+void PsiAccount::clearRingbuf() { d->xmlRing.clear(); }
+
+void PsiAccount::injectIncomingStanza(const QDomElement &e)
+{
+    // the push tasks handling messages and presences are created on start.
+    // without a stream the client drops whatever it would send in reply
+    if (!d->client->isActive())
+        d->client->start(d->jid.domain(), d->jid.node(), QString(), d->jid.resource());
+    d->client->rootTask()->take(e);
+}
+
+void PsiAccount::injectGroupChatJoin(const Jid &room)
 {
-    d->xmlRingbuf.clear();
-    d->xmlRingbufWrite = 0;
-    d->xmlRingbuf.resize(10);
+    if (!d->client->isActive())
+        d->client->start(d->jid.domain(), d->jid.node(), QString(), d->jid.resource());
+    d->injectedJoins.insert(room.bare());
+    d->client->groupChatJoin(room.domain(), room.node(), room.resource(), QString(), 0);
 }
 
 /**
@@ -62,6 +62,7 @@ class PsiContactList;
 class PsiHttpAuthRequest;
 class PsiEncryptionController;
 class PsiIcon;
+class QDomElement;
 class QHostAddress;
 class QIcon;
 class QMimeData;
@@ -297,6 +298,8 @@ public:
     };
     QList<xmlRingElem> dumpRingbuf();
     void               clearRingbuf();
+    void               injectIncomingStanza(const QDomElement &e); // as if the server sent it. see StanzaReplay
+    void               injectGroupChatJoin(const Jid &room);       // room/nick. joined on the injected self-presence
     void               addMucItem(const Jid &);
     QStringList        groupList() const;
     void               updateEntry(const UserListItem &u);
@@ -553,6 +556,7 @@ private:
     bool          passwordPrompt();
     void          sentInitialPresence();
     void          requestAvatarsForAllContacts();
+    void          scheduleAutoJoin(const ConferenceBookmark &c);
 
     void      processChatsHelper(const Jid &jid, bool removeEvents);
     void      processChats(const Jid &);
@@ -128,7 +128,8 @@ PsiActionList::Private::Private(PsiActionList *_list, PsiCon *_psi)
     });
 #endif
 
-    connect(PsiOptions::instance(), SIGNAL(optionChanged(const QString &)), SLOT(optionsChanged()));
+    for (const char *prefix : { "options.ui.menu.status", "options.shortcuts.alist" })
+        PsiOptions::instance()->subscribe(prefix, this, [this](const QStringList &) { optionsChanged(); });
     optionsChanged();
 }
 
@@ -432,6 +433,8 @@ void PsiActionList::Private::createMainWin()
 
         IconAction *actDiagQCAKeyStore = new IconAction(tr("Key Storage"), tr("&Key Storage"), 0, this);
 
+        IconAction *actDiagEventLoop = new IconAction(tr("Event Loop Latency"), tr("&Event Loop Latency"), 0, this);
+
         ActionNames actions[] = { { "help_readme", actReadme },
                                   { "help_online_wiki", actOnlineWiki },
                                   { "help_online_home", actOnlineHome },
@@ -443,6 +446,7 @@ void PsiActionList::Private::createMainWin()
                                   { "help_about_psimedia", actAboutPsiMedia },
                                   { "help_diag_qcaplugin", actDiagQCAPlugin },
                                   { "help_diag_qcakeystore", actDiagQCAKeyStore },
+                                  { "help_diag_eventloop", actDiagEventLoop },
                                   { "", nullptr } };
 
         createActionList(tr("Help"), Actions_MainWin, actions);
@@ -44,6 +44,7 @@
 #include "lastactivitytask.h"
 #include "messageview.h"
 #include "msgmle.h"
+#include "pgpkeyservice.h"
 #include "pgputil.h"
 #include "psiaccount.h"
 #include "psiencryptioncontroller.h"
@@ -680,11 +681,13 @@ void PsiChatDlg::setContactToolTip(QString text)
 void PsiChatDlg::showOwnFingerprint()
 {
 #ifdef HAVE_PGPUTIL
-    const QString &&fingerprint = PGPUtil::getFingerprint(account()->pgpKeyId());
-    if (!fingerprint.isEmpty()) {
-        const QString &&msg = tr("Fingerprint for account \"%1\": %2").arg(account()->name(), fingerprint);
-        appendSysMsg(msg);
-    }
+    PGPKeyService::instance()->key(account()->pgpKeyId(), this, [this](const PGPKeyService::Key &key) {
+        const QString &&fingerprint = PGPKeyService::formatFingerprint(key.fingerprint);
+        if (!fingerprint.isEmpty()) {
+            const QString &&msg = tr("Fingerprint for account \"%1\": %2").arg(account()->name(), fingerprint);
+            appendSysMsg(msg);
+        }
+    });
 #endif // HAVE_PGPUTIL
 }
 
@@ -694,12 +697,7 @@ void PsiChatDlg::sendOwnPublicKey()
     if (!account()->hasPgp())
         return;
 
-    const auto &&keyData = PGPUtil::getPublicKeyData(account()->pgpKeyId());
-    sendMessage(keyData);
-
-    const auto &&keyOwnerName = PGPUtil::getKeyOwnerName(account()->pgpKeyId());
-    const auto &&shortId      = account()->pgpKeyId().right(8);
-    appendSysMsg(tr("Public key \"%1\" sent").arg(keyOwnerName + " " + shortId));
+    sendPublicKeyData(account()->pgpKeyId());
 #endif // HAVE_PGPUTIL
 }
 
@@ -711,12 +709,24 @@ void PsiChatDlg::sendPublicKey()
     if (keyId.isEmpty())
         return;
 
-    const auto &&keyData = PGPUtil::getPublicKeyData(keyId);
-    sendMessage(keyData);
+    sendPublicKeyData(keyId);
+#endif // HAVE_PGPUTIL
+}
 
-    const auto &&keyOwnerName = PGPUtil::getKeyOwnerName(keyId);
-    const auto &&shortId      = keyId.right(8);
-    appendSysMsg(tr("Public key \"%1\" sent").arg(keyOwnerName + " " + shortId));
+void PsiChatDlg::sendPublicKeyData(const QString &keyId)
+{
+#ifdef HAVE_PGPUTIL
+    auto service = PGPKeyService::instance();
+    service->publicKeyData(keyId, this, [this, service, keyId](const QString &keyData) {
+        if (keyData.isEmpty())
+            return;
+        sendMessage(keyData);
+        service->key(keyId, this, [this, keyId](const PGPKeyService::Key &key) {
+            appendSysMsg(tr("Public key \"%1\" sent").arg(key.ownerName + " " + keyId.right(8)));
+        });
+    });
+#else
+    Q_UNUSED(keyId);
 #endif // HAVE_PGPUTIL
 }
 
@@ -45,6 +45,22 @@ public:
         defineParam("status-message", tr("MSG", "translate in UPPER_CASE with no spaces"),
                     tr("Set status message. Must be used together with --status.", "do not translate --status"));
 
+        defineParam("replay", tr("SOURCE", "translate in UPPER_CASE with no spaces"),
+                    tr("Replay incoming stanzas from SOURCE to the first enabled account offline, report the timings "
+                       "and quit. SOURCE is an XML console capture file, an XML file with stanzas or "
+                       "synthetic:SCENARIO[:COUNT] where SCENARIO is one of `presence', `muc', `chat'.",
+                       "do not translate synthetic, `presence', `muc', `chat'"));
+
+        defineParam("replay-speed", tr("SPEED", "translate in UPPER_CASE with no spaces"),
+                    tr("Speed up the replay SPEED times. 0 replays as fast as possible. Must be used together with "
+                       "--replay.",
+                       "do not translate --replay"));
+
+        defineParam("replay-report", tr("FILE", "translate in UPPER_CASE with no spaces"),
+                    tr("Write the replay report as JSON to FILE and the trace to FILE.trace.json instead of the "
+                       "standard output. Must be used together with --replay.",
+                       "do not translate --replay"));
+
         defineSwitch(
             "swrender",
             tr("Use software widgets rendering. In some cases default hardware rendering may lead to graphical "
@@ -40,6 +40,7 @@
 #include "desktoputil.h"
 #include "edbsqlite.h"
 #include "eventdlg.h"
+#include "eventloopwatchdog.h"
 #include "globalshortcut/globalshortcutmanager.h"
 #include "iris/xmpp-im/xmpp_forwarding.h"
 #ifdef GROUPCHAT
@@ -83,6 +84,7 @@
 #include "systemwatch/systemwatch.h"
 #include "tabdlg.h"
 #include "tabmanager.h"
+#include "tracer.h"
 #include "tunecontrollermanager.h"
 #include "urlobject.h"
 #include "userlist.h"
@@ -106,6 +108,7 @@
 #endif
 #ifdef WEBKIT
 #include "avatars.h"
+#include "chatview.h"
 #include "chatviewthemeprovider.h"
 #endif
 #ifdef HAVE_SPARKLE
@@ -118,6 +121,7 @@
 #include <QApplication>
 #include <QColor>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QIcon>
 #include <QImage>
@@ -130,6 +134,7 @@
 #include <QPixmapCache>
 #include <QPointer>
 #include <QSessionManager>
+#include <QTimer>
 
 static const char *tunePublishOptionPath          = "options.extended-presence.tune.publish";
 static const char *tuneUrlFilterOptionPath        = "options.extended-presence.tune.url-filter";
@@ -269,6 +274,18 @@ public:
         return { nullptr, QString() };
     }
 
+    void updateIdle()
+    {
+        idleSettings_.update();
+        if (idleSettings_.useAway || idleSettings_.useNotAvailable || idleSettings_.useOffline
+            || idleSettings_.useIdleServer)
+            idle.start();
+        else {
+            idle.stop();
+            idleSettings_.secondsIdle = 0;
+        }
+    }
+
 public slots:
     void updateIconSelect()
     {
@@ -378,8 +395,11 @@ PsiCon::~PsiCon()
     delete d;
 }
 
-bool PsiCon::init()
+bool PsiCon::init(bool autoLogin)
 {
+    QElapsedTimer startupTimer;
+    startupTimer.start();
+
     // check active profiles
     if (!ActiveProfiles::instance()->setThisProfile(activeProfile))
         return false;
@@ -436,7 +456,7 @@ bool PsiCon::init()
     QString systemDefaults = ApplicationInfo::resourcesDir();
     systemDefaults += "/options-default.xml";
     // qWarning(qPrintable(QString("Loading system defaults from %1").arg(systemDefaults)));
-    options->load(systemDefaults);
+    options->loadDefaults(systemDefaults);
 
     if (!PsiOptions::exists(optionsFile())) {
         if (!options->newProfile()) {
@@ -498,13 +518,48 @@ bool PsiCon::init()
         proxy->migrateItemList(d->optionsMigration.proxyMigration);
     connect(proxy, SIGNAL(settingsChanged()), SLOT(proxy_settingsChanged()));
 
-    connect(options, &PsiOptions::optionChanged, this, &PsiCon::optionChanged);
+    for (const char *prefix : { "options.shortcuts", "options.plugins" })
+        options->subscribe(prefix, this, [this](const QStringList &) { setShortcuts(); });
+    for (const char *prefix :
+         { "options.status.auto-away", "options.ui.menu.status.xa", "options.service-discovery.last-activity" })
+        options->subscribe(prefix, this, [this](const QStringList &) { d->updateIdle(); });
+    for (const char *prefix : {
+             "options.ui.notifications.alert-style", "options.ui.tabs.use-tabs", "options.ui.tabs.grouping",
+             "options.ui.tabs.show-tab-buttons", "options.p2p.bytestreams", "options.ui.chat.css",
+             "options.ui.spell-check.langs",
+#ifdef USE_PEP
+             "options.extended-presence.tune",
+#endif
+         }) {
+        options->subscribe(prefix, this, [this](const QStringList &changed) {
+            for (const QString &option : changed)
+                optionChanged(option);
+        });
+    }
+
+    // the trace is written when the option is cleared or on exit
+    auto updateTracer = [options]() {
+        QString traceFile = options->getOption("options.debug.trace-file").toString();
+        if (Tracer::isEnabled())
+            Tracer::stop();
+        if (!traceFile.isEmpty())
+            Tracer::start(traceFile);
+    };
+    options->subscribe("options.debug.trace-file", this, [updateTracer](const QStringList &) { updateTracer(); });
+    if (!options->getOption("options.debug.trace-file").toString().isEmpty())
+        updateTracer();
 
     contactUpdatesManager_ = new ContactUpdatesManager(this);
 
+    if (auto watchdog = EventLoopWatchdog::instance())
+        watchdog->setReportFile(pathToProfile(activeProfile, ApplicationInfo::CacheLocation) + "/event-loop.txt");
+
     QDir profileDir(pathToProfile(activeProfile, ApplicationInfo::DataLocation));
     profileDir.rmdir("info"); // remove unused dir
 
+    // iconsets are decoded on the thread pool, so animations have to know where to live
+    Anim::setMainThread(QThread::currentThread());
+
     // first thing, try to load the iconset
     bool result = true;
     if (!PsiIconset::instance()->loadAll()) {
@@ -582,8 +637,6 @@ bool PsiCon::init()
 
     PsiConObject *psiConObject = new PsiConObject(this);
 
-    Anim::setMainThread(QThread::currentThread());
-
     // setup the main window
     d->mainwin = new MainWin(options->getOption("options.ui.contactlist.always-on-top").toBool(),
                              (options->getOption("options.ui.systemtray.enable").toBool()
@@ -744,11 +797,19 @@ bool PsiCon::init()
     // init spellchecker
     optionChanged("options.ui.spell-check.langs");
 
+    d->updateIdle();
+
     // try autologin if needed
-    for (PsiAccount *account : d->contactList->accounts()) {
+    for (PsiAccount *account : autoLogin ? d->contactList->accounts() : QList<PsiAccount *>()) {
         account->autoLogin();
     }
 
+#ifdef WEBKIT
+    // after the main window is shown and the accounts started connecting
+    QTimer::singleShot(3000, this, []() { ChatView::preloadViews(); });
+#endif
+
+    qDebug("PsiCon::init() finished in %lld ms", startupTimer.elapsed());
     return result;
 }
 
@@ -763,6 +824,7 @@ void PsiCon::deinit()
     deleteAllDialogs();
 
 #ifdef WEBKIT
+    ChatView::releasePreloadedViews();
     // unload webkit themes early (before realease of webengine profile)
     delete d->themeManager->unregisterProvider(QString::fromLatin1("groupchatview"));
     delete d->themeManager->unregisterProvider(QString::fromLatin1("chatview"));
@@ -1423,19 +1485,6 @@ void PsiCon::optionChanged(const QString &option)
 {
     // bool notifyRestart = true;
 
-    // Global shortcuts
-    setShortcuts();
-
-    // Idle server
-    d->idleSettings_.update();
-    if (d->idleSettings_.useAway || d->idleSettings_.useNotAvailable || d->idleSettings_.useOffline
-        || d->idleSettings_.useIdleServer)
-        d->idle.start();
-    else {
-        d->idle.stop();
-        d->idleSettings_.secondsIdle = 0;
-    }
-
     if (option == QString::fromLatin1("options.ui.notifications.alert-style")) {
         alertIconUpdateAlertStyle();
     }
@@ -1503,7 +1552,6 @@ void PsiCon::optionChanged(const QString &option)
         }
     }
 #endif
-    updateNAMOptions();
 }
 
 void PsiCon::updateNAMOptions()
@@ -1718,7 +1766,11 @@ void PsiCon::recentNodeAdd(const QString &str)
         d->recentNodeList.takeLast();
 }
 
-void PsiCon::proxy_settingsChanged() { saveAccounts(); }
+void PsiCon::proxy_settingsChanged()
+{
+    saveAccounts();
+    updateNAMOptions();
+}
 
 IconSelectPopup *PsiCon::iconSelectPopup() const { return d->iconSelect; }
 
@@ -71,7 +71,7 @@ public:
     PsiCon();
     ~PsiCon();
 
-    bool init();
+    bool init(bool autoLogin = true);
     void deinit();
     void gracefulDeinit(std::function<void()> callback);
 
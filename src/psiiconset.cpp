@@ -21,89 +21,57 @@
 
 #include "anim.h"
 #include "applicationinfo.h"
+#include "clienticonmatcher.h"
 #include "common.h"
+#include "debug.h"
 #include "fileutil.h"
 #include "psievent.h"
 #include "psioptions.h"
 #include "userlist.h"
 
 #include <QCoreApplication>
+#include <QElapsedTimer>
 #include <QFileInfo>
 #include <QSet>
 #include <QStandardPaths>
 #include <QTextStream>
+#include <QtConcurrentMap>
 
 using namespace XMPP;
 
-struct ClientIconCheck {
-    QString     icon;   // icon name w/o client/ part
-    QStringList inside; // search for texts inside provided name to be sure
-};
-
 /*
- * Main client icon search struct.
- * <left part of caps/clientName> =>  <list of icons with caps/clientName clarifications>
- *
- * Example:
- * client_icons.txt contents:
- *   psi-plus psi+,psi#fork#plus
- *   psi-ny psi#ny
- *
- * The first column is an icon name in the iconpack and the remaining is a set of caps/clientName search spec.
- * This mean for clients with caps node or client name (i.e. taken from disco#info or other sources) starting
- * with: `psi+` and also for nodes/names starting with `psi` and having words "fork" or "plus" somewhere inside,
- * "psi-plus" icons will be used. For psi-ny (New Year edition) icon caps/client-name whould start with "psi"
- * and have "ny" somewhere in the middle.
- *
- * === How to add new icons ===
- * In general you are gonna need to discover the client name and update one of iconpacks.
- *
- * To discover the client do next:
- * 1. Find any alive contact using interested you client
- * 2. Open XMPP Console and insert the current JID together with its current online resource into the filter line
- * 3. Press Dump Ringbuf to see some stanzas.
- * 4. Find <presence....> stanza and remember "ver" attribute from <c> element
- * 5. Open caps.xml file (~/.cache/psi/caps.xml, "C:/Users/<USER>/AppData/Local/psi/cache") and search for
- *    value of `ver`.
- * 6. You should see a line like <identity name="TheClientName 1.0 O_o" category="client" ...>
- * 7. You can take the most important unique part of "TheClientName 1.0 O_o" from the beginning (e.g. TheClient)
- * 8. Come up with an icon name in lower case (e.g. "theclient")
- * 9. Add a line to client_icons.txt with the format described above, all in lower case.
- *    "theclient theclient"
- * 10. If it conflicts with anything else try to add something unique from its name/node to the client lookup spec.
- *     "theclient theclient#O_o"
- * 11. Next you need to update an iconpack. We have at least two iconpacks for icons. One comes in this repo and
- *     it's quite minimal just co cover popular clients. And there is also a larger iconpack in resources repo.
- *     Choose one wisely and and the new "theclient" icon there.
- *
- *
- * The QMap below will look like:
- * {
- *   "psi"  => [
- *                {"psi-plus",["fork", "plus"]}
- *                {"psi-ny",["ny"]}
- *             ]
- *   "psi+" => [{"psi-plus",[]}]
- * }
- *
- * Where psi/psi+        - caps/client name (or its beginning) as it comes from client_icons.txt.
- *       psi-plus/psi-ny - icon name
- *       fork/plus/ny    - parts of caps/client name
- *
- * Now for example we need to lookup icon for caps node "psiplus.com". The most still matching item here is "psi",
- * (psi+ won't match because psiplus.com doesn't start with psi+). And we don't have anything like "psip" or "psipl"..
- * So we review just "psi" (all its items consequently)
- * Both items in "psi" have clarification list. For the first item we take its clarification list ["fork", "plus"]
- * and review if any item is in "psiplus.com". The "plus" will be found, so the icon "psi-plus" will be returned.
- *
- * Note: It's quite regular for caps node to start with "https" but current client_icons.txt almost never have
- * such records. It just means it relies heavily on discovered client names instead of caps nodes.
- * Client name from its side may be taken from caps node when there is no other way to detect.
- * Example:
- * caps node = https://www.psi-im.org/helloworld/caps
- * resulting client name = psi-im.org/helloworld
+ * Iconsets are independent from each other, so on startup they are decoded on the global thread pool.
+ * Workers only read files, parse icondef.xml and decode images to QImage. Everything touching
+ * IconsetFactory or QPixmap is done later on the GUI thread when the preloaded iconset is picked up.
  */
-typedef QMap<QString, QList<ClientIconCheck>> ClientIconMap;
+struct IconsetSource {
+    QString         path;
+    Iconset::Format format = Iconset::Format::Psi;
+};
+
+struct PreloadedIconset {
+    QString         path;
+    Iconset::Format format = Iconset::Format::Psi;
+    Iconset         iconset;
+    bool            ok      = false;
+    qint64          elapsed = 0; // ms spent by a worker
+};
+
+struct IconsetPreloader {
+    typedef PreloadedIconset result_type;
+
+    PreloadedIconset operator()(const IconsetSource &source) const
+    {
+        PreloadedIconset ret;
+        QElapsedTimer    timer;
+        timer.start();
+        ret.path    = source.path;
+        ret.format  = source.format;
+        ret.ok      = ret.iconset.load(source.path, source.format);
+        ret.elapsed = timer.elapsed();
+        return ret;
+    }
+};
 
 //----------------------------------------------------------------------------
 // PsiIconset
@@ -115,7 +83,7 @@ private:
 
 public:
     Iconset                system, moods, clients, activities, affiliations;
-    ClientIconMap          client2icon;
+    ClientIconMatcher      client2icon;
     QString                cur_system, cur_status, cur_moods, cur_clients, cur_activity, cur_affiliations;
     QStringList            cur_emoticons;
     QMap<QString, QString> cur_service_status;
@@ -129,9 +97,114 @@ public:
         QList<IconsetItem> list;
         QList<IconsetItem> customList;
     } status_icons;
+    QHash<QString, PreloadedIconset> preloaded; // path => iconset decoded by the thread pool
 
     Private(PsiIconset *_psi) { psi = _psi; }
 
+    // decodes all the iconsets in parallel. the results are consumed by loadIconsetFile()
+    void preload(const QList<IconsetSource> &sources)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        QFuture<PreloadedIconset> future = QtConcurrent::mapped(sources, IconsetPreloader());
+        future.waitForFinished();
+
+        qint64      busy    = 0;
+        const auto &results = future.results();
+        for (const PreloadedIconset &r : results) {
+            ICONSET_DEBUG() << "decoded" << r.path << "in" << r.elapsed << "ms" << (r.ok ? "" : "(failed)");
+            busy += r.elapsed;
+            preloaded.insert(r.path, r);
+        }
+        ICONSET_DEBUG() << "decoded" << results.size() << "iconsets in" << timer.elapsed() << "ms (" << busy
+                        << "ms of worker time)";
+    }
+
+    // takes the iconset from the preloaded ones or loads it synchronously
+    bool loadIconsetFile(Iconset &is, const QString &path, Iconset::Format format = Iconset::Format::Psi)
+    {
+        auto it = preloaded.find(path);
+        if (it != preloaded.end() && it->format == format) {
+            bool ok = it->ok;
+            is      = it->iconset;
+            preloaded.erase(it);
+            return ok;
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        bool ok = is.load(path, format);
+        if (!path.isEmpty()) {
+            ICONSET_DEBUG() << "loaded" << path << "in" << timer.elapsed() << "ms" << (ok ? "" : "(failed)");
+        }
+        return ok;
+    }
+
+    QString emoticonsPath(const QString &name, Iconset::Format *format)
+    {
+        auto isPath = iconsetPath("emoticons/" + name, Iconset::Format::Psi, true);
+        if (!isPath.isEmpty()) {
+            *format = Iconset::Format::Psi;
+            return isPath;
+        }
+        *format = Iconset::Format::KdeEmoticons;
+        return iconsetPath(name, Iconset::Format::KdeEmoticons);
+    }
+
+    // all the iconsets loadAll() is going to need with current options
+    QList<IconsetSource> startupSources()
+    {
+        QList<IconsetSource> sources;
+        auto                 addSource = [&sources](const QString &path, Iconset::Format format) {
+            if (!path.isEmpty()
+                && std::none_of(sources.begin(), sources.end(), [&](const auto &s) { return s.path == path; })) {
+                sources.append({ path, format });
+            }
+        };
+        auto addWithDefault = [this, &addSource](const QString &type, const QString &defaultPath, const char *option) {
+            addSource(defaultPath, Iconset::Format::Psi);
+            QString name = PsiOptions::instance()->getOption(QLatin1String(option)).toString();
+            if (name != QLatin1String("default")) {
+                addSource(iconsetPath(type + name), Iconset::Format::Psi);
+            }
+        };
+
+        auto o = PsiOptions::instance();
+        addWithDefault("system/", ":/iconsets/system/default", "options.iconsets.system");
+        addWithDefault("roster/", ":/iconsets/roster/default", "options.iconsets.status");
+        addWithDefault("moods/", iconsetPath("moods/default"), "options.iconsets.moods");
+        addWithDefault("activities/", iconsetPath("activities/default"), "options.iconsets.activities");
+        addWithDefault("clients/", iconsetPath("clients/default"), "options.iconsets.clients");
+        addWithDefault("affiliations/", iconsetPath("affiliations/default"), "options.iconsets.affiliations");
+
+        QString     status   = o->getOption("options.iconsets.status").toString();
+        const auto &services = o->mapKeyList("options.iconsets.service-status");
+        for (const QVariant &service : services) {
+            QString val
+                = o->getOption(*o->mapLookup("options.iconsets.service-status", service) + ".iconset").toString();
+            if (!val.isEmpty() && val != status) {
+                addSource(iconsetPath("roster/" + val), Iconset::Format::Psi);
+            }
+        }
+        const auto customicons = o->getChildOptionNames("options.iconsets.custom-status", true, true);
+        for (const QString &base : customicons) {
+            QString val = o->getOption(base + ".iconset").toString();
+            if (!val.isEmpty() && val != status) {
+                addSource(iconsetPath("roster/" + val), Iconset::Format::Psi);
+            }
+        }
+
+        const auto emoticonNames = o->getOption("options.iconsets.emoticons").toStringList();
+        for (const QString &name : emoticonNames) {
+            Iconset::Format format;
+            QString         path = emoticonsPath(name, &format);
+            addSource(path, format);
+        }
+
+        return sources;
+    }
+
     QString iconsetPath(QString name, Iconset::Format format = Iconset::Format::Psi, bool silent = false)
     {
         if (format == Iconset::Format::Psi) {
@@ -231,11 +304,12 @@ public:
     Iconset systemIconset(bool *ok)
     {
         Iconset def;
-        *ok = def.load(":/iconsets/system/default");
+        *ok = loadIconsetFile(def, ":/iconsets/system/default");
 
         if (PsiOptions::instance()->getOption("options.iconsets.system").toString() != "default") {
             Iconset is;
-            is.load(iconsetPath("system/" + PsiOptions::instance()->getOption("options.iconsets.system").toString()));
+            loadIconsetFile(
+                is, iconsetPath("system/" + PsiOptions::instance()->getOption("options.iconsets.system").toString()));
 
             loadIconset(def, is);
         }
@@ -248,11 +322,12 @@ public:
     Iconset defaultRosterIconset(bool *ok)
     {
         Iconset def;
-        *ok = def.load(":/iconsets/roster/default");
+        *ok = loadIconsetFile(def, ":/iconsets/roster/default");
 
         if (PsiOptions::instance()->getOption("options.iconsets.status").toString() != "default") {
             Iconset is;
-            is.load(iconsetPath("roster/" + PsiOptions::instance()->getOption("options.iconsets.status").toString()));
+            loadIconsetFile(
+                is, iconsetPath("roster/" + PsiOptions::instance()->getOption("options.iconsets.status").toString()));
 
             loadIconset(def, is);
         }
@@ -265,11 +340,12 @@ public:
     Iconset moodsIconset(bool *ok)
     {
         Iconset def;
-        *ok = def.load(iconsetPath("moods/default"));
+        *ok = loadIconsetFile(def, iconsetPath("moods/default"));
 
         if (PsiOptions::instance()->getOption("options.iconsets.moods").toString() != "default") {
             Iconset is;
-            is.load(iconsetPath("moods/" + PsiOptions::instance()->getOption("options.iconsets.moods").toString()));
+            loadIconsetFile(
+                is, iconsetPath("moods/" + PsiOptions::instance()->getOption("options.iconsets.moods").toString()));
 
             loadIconset(def, is);
         }
@@ -282,12 +358,12 @@ public:
     Iconset activityIconset(bool *ok)
     {
         Iconset def;
-        *ok = def.load(iconsetPath("activities/default"));
+        *ok = loadIconsetFile(def, iconsetPath("activities/default"));
 
         if (PsiOptions::instance()->getOption("options.iconsets.activities").toString() != "default") {
             Iconset is;
-            is.load(iconsetPath("activities/"
-                                + PsiOptions::instance()->getOption("options.iconsets.activities").toString()));
+            QString name = PsiOptions::instance()->getOption("options.iconsets.activities").toString();
+            loadIconsetFile(is, iconsetPath("activities/" + name));
 
             loadIconset(def, is);
         }
@@ -300,11 +376,12 @@ public:
     Iconset clientsIconset(bool *ok)
     {
         Iconset def;
-        *ok = def.load(iconsetPath("clients/default"));
+        *ok = loadIconsetFile(def, iconsetPath("clients/default"));
 
         if (PsiOptions::instance()->getOption("options.iconsets.clients").toString() != "default") {
             Iconset is;
-            is.load(iconsetPath("clients/" + PsiOptions::instance()->getOption("options.iconsets.clients").toString()));
+            loadIconsetFile(
+                is, iconsetPath("clients/" + PsiOptions::instance()->getOption("options.iconsets.clients").toString()));
 
             loadIconset(def, is);
         }
@@ -317,12 +394,12 @@ public:
     Iconset affiliationsIconset(bool *ok)
     {
         Iconset def;
-        *ok = def.load(iconsetPath("affiliations/default"));
+        *ok = loadIconsetFile(def, iconsetPath("affiliations/default"));
 
         if (PsiOptions::instance()->getOption("options.iconsets.affiliations").toString() != "default") {
             Iconset is;
-            is.load(iconsetPath("affiliations/"
-                                + PsiOptions::instance()->getOption("options.iconsets.affiliations").toString()));
+            QString name = PsiOptions::instance()->getOption("options.iconsets.affiliations").toString();
+            loadIconsetFile(is, iconsetPath("affiliations/" + name));
 
             loadIconset(def, is);
         }
@@ -338,21 +415,20 @@ public:
 
         const auto names = PsiOptions::instance()->getOption("options.iconsets.emoticons").toStringList();
         for (const QString &name : names) {
-            auto isPath = iconsetPath("emoticons/" + name, Iconset::Format::Psi, true);
-
-            if (!isPath.isEmpty()) {
-                Iconset is;
-                if (is.load(iconsetPath("emoticons/" + name))) {
-                    is.addToFactory();
-                    emo.append(is);
-                    continue;
-                }
-            }
+            Iconset::Format format;
+            QString         isPath = emoticonsPath(name, &format);
 
             Iconset is;
-            if (is.load(iconsetPath(name, Iconset::Format::KdeEmoticons), Iconset::Format::KdeEmoticons)) {
+            if (loadIconsetFile(is, isPath, format)) {
                 is.addToFactory();
                 emo.append(is);
+            } else if (format == Iconset::Format::Psi) {
+                Iconset kdeIs;
+                if (loadIconsetFile(kdeIs, iconsetPath(name, Iconset::Format::KdeEmoticons),
+                                    Iconset::Format::KdeEmoticons)) {
+                    kdeIs.addToFactory();
+                    emo.append(kdeIs);
+                }
             }
         }
 
@@ -365,7 +441,12 @@ PsiIconset::PsiIconset() : QObject(QCoreApplication::instance())
     d = new Private(this);
     d->status_icons.useServicesIcons
         = PsiOptions::instance()->getOption("options.ui.contactlist.use-transport-icons").toBool();
-    connect(PsiOptions::instance(), SIGNAL(optionChanged(const QString &)), SLOT(optionChanged(const QString &)));
+    for (const char *path : { "options.iconsets", "options.ui.contactlist.use-transport-icons" }) {
+        PsiOptions::instance()->subscribe(path, this, [this](const QStringList &changed) {
+            for (const QString &option : changed)
+                optionChanged(option);
+        });
+    }
     connect(PsiOptions::instance(), SIGNAL(destroyed()), SLOT(reset()));
 }
 
@@ -444,7 +525,7 @@ bool PsiIconset::loadRoster()
         }
 
         Iconset is;
-        if (is.load(d->iconsetPath("roster/" + it2))) {
+        if (d->loadIconsetFile(is, d->iconsetPath("roster/" + it2))) {
             is.addToFactory();
             d->stripFirstAnimFrame(is);
             roster.insert(it2, is);
@@ -512,54 +593,13 @@ bool PsiIconset::loadClients()
             iconNames.insert(it.next()->name().section('/', 1, 1));
         }
 
-        ClientIconMap cm; // start part, spec[spec2[spec3]]
+        ClientIconMatcher cm;
 
         auto readClientsDesc = [&](const QString &filePath) {
             QStringList lines = FileUtil::readFileLines(filePath);
             if (lines.isEmpty())
                 return false;
-            /* file format: <icon res name> <left_part_of_cap1#inside1#inside2>,<left_part_of_cap2>
-                next line the same.
-            */
-            for (const auto &line : lines) {
-                QString iconName = line.trimmed().section(QLatin1Char(' '), 0, 0);
-                if (iconName.isEmpty() || !iconNames.contains(iconName)) {
-                    continue;
-                }
-                ClientIconCheck ic   = { iconName, QStringList() };
-                QString         caps = line.mid(iconName.length());
-#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
-                const auto &cList = caps.split(QLatin1Char(','), Qt::SkipEmptyParts);
-#else
-                const auto &cList = caps.split(QLatin1Char(','), QString::SkipEmptyParts);
-#endif
-                for (const QString &c : cList) {
-                    QString ct = c.trimmed();
-                    if (ct.length()) {
-                        QStringList spec = ct.split('#');
-                        if (spec.size() > 1) {
-                            ic.inside = spec.mid(1);
-                        } else {
-                            ic.inside.clear();
-                        }
-                        ClientIconMap::Iterator it = cm.find(spec[0]);
-                        if (it == cm.end()) {
-                            cm.insert(spec[0], QList<ClientIconCheck>() << ic);
-                        } else {
-                            it.value().append(ic);
-                        }
-                    }
-                }
-            }
-
-            // do some sorting to keep elements with a lot of # first
-            for (auto &checkList : cm) {
-                std::sort(checkList.begin(), checkList.end(),
-                          [](const auto &a, const auto &b) { return a.inside.size() > b.inside.size(); });
-            }
-
-            // insert end boundary element to make search implementation simple
-            cm.insert(QLatin1String("~"), QList<ClientIconCheck>());
+            cm.addDescriptions(lines, iconNames);
             return true;
         };
 
@@ -663,16 +703,24 @@ void PsiIconset::loadStatusIconDefinitions()
 
 bool PsiIconset::loadAll()
 {
-    if (!loadSystem() || !loadRoster())
-        return false;
-
-    loadEmoticons();
-    loadMoods();
-    loadActivity();
-    loadClients();
-    loadAffiliations();
-    loadStatusIconDefinitions();
-    return true;
+    TRACE_SPAN("PsiIconset::loadAll");
+    QElapsedTimer timer;
+    timer.start();
+    d->preload(d->startupSources());
+
+    bool ok = loadSystem() && loadRoster();
+    if (ok) {
+        loadEmoticons();
+        loadMoods();
+        loadActivity();
+        loadClients();
+        loadAffiliations();
+        loadStatusIconDefinitions();
+    }
+
+    d->preloaded.clear(); // whatever wasn't used (e.g. already loaded iconsets) is just dropped
+    ICONSET_DEBUG() << "all iconsets loaded in" << timer.elapsed() << "ms";
+    return ok;
 }
 
 void PsiIconset::optionChanged(const QString &option)
@@ -875,7 +923,19 @@ QString status2name(int s)
     return name;
 }
 
-PsiIcon *PsiIconset::statusPtr(int s) { return const_cast<PsiIcon *>(IconsetFactory::iconPtr(status2name(s))); }
+// status icon names are interned once, so status icons are resolved without string hashing
+static IconsetFactory::IconId status2id(int s)
+{
+    static QHash<int, IconsetFactory::IconId> ids;
+
+    auto it = ids.constFind(s);
+    if (it == ids.constEnd()) {
+        it = ids.insert(s, IconsetFactory::iconId(status2name(s)));
+    }
+    return it.value();
+}
+
+PsiIcon *PsiIconset::statusPtr(int s) { return const_cast<PsiIcon *>(IconsetFactory::iconPtr(status2id(s))); }
 
 PsiIcon PsiIconset::status(int s)
 {
@@ -997,36 +1057,7 @@ void PsiIconset::removeAnimation(Iconset &is)
     }
 }
 
-QString PsiIconset::caps2client(const QString &name)
-{
-    if (d->client2icon.isEmpty()) {
-        return QString();
-    }
-
-    auto it = d->client2icon.lowerBound(name);
-    // if name starts with found key or with key of previous item
-    if ((it != d->client2icon.end() && name.startsWith(it.key()))
-        || (it != d->client2icon.begin() && name.startsWith((--it).key()))) {
-
-        const auto &ics = it.value();
-        for (const ClientIconCheck &ic : ics) {
-            if (ic.inside.isEmpty()) {
-                return ic.icon;
-            }
-            bool matched = true;
-            for (const QString &s : ic.inside) {
-                if (name.indexOf(s, it.key().size()) == -1) {
-                    matched = false;
-                    break;
-                }
-            }
-            if (matched) {
-                return ic.icon;
-            }
-        }
-    }
-    return QString();
-}
+QString PsiIconset::caps2client(const QString &name) { return d->client2icon.cachedMatch(name); }
 
 PsiIconset *PsiIconset::instance()
 {
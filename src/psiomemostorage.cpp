@@ -27,8 +27,11 @@
 #include <QSqlDatabase>
 #include <QSqlError>
 #include <QSqlQuery>
+#include <QTimer>
 #include <QUuid>
 
+#include <functional>
+
 namespace {
 QString bareJid(const QString &jid)
 {
@@ -50,11 +53,33 @@ QString dateTimeToDb(const QDateTime &value)
 }
 } // namespace
 
+// Pending writes are flushed this long after the first of them, or as soon as
+// there are too many. Automatic trust and device list changes come in bursts,
+// so they end up in a single transaction. A changed session is never left
+// pending: the message encrypted with it may already be on the way, and a
+// session rolled back after a crash can't decrypt the replies. Neither is a
+// trust decision of the user.
+static const int writeDelay       = 500; // ms
+static const int maxPendingWrites = 256;
+
 class PsiOmemoStorage::Private {
 public:
+    using TrustKey = QPair<QString, QByteArray>; // method, key id
+
     QString connectionName;
     QString error;
 
+    QHash<QString, QSharedPointer<QSqlQuery>> statements; // prepared once per connection
+    QHash<QString, QVariant>                  simpleValues;
+    QHash<QString, QHash<TrustKey, int>>      trust;       // bare jid -> level. loaded per jid
+    QHash<QString, QHash<uint32_t, int>>      legacyTrust; // bare jid -> device id -> LegacyTrust
+    QHash<QString, QByteArray>                sessions;    // sessionKey() -> the session in the database
+
+    // write-behind queue. a newer write of the same key replaces the older one
+    QList<std::function<bool()>> pending;
+    QHash<QString, int>          pendingIndex;
+    QTimer                       flushTimer;
+
     QSqlDatabase database() const { return QSqlDatabase::database(connectionName, false); }
 
     bool exec(const QString &sql) const
@@ -66,31 +91,228 @@ public:
         return false;
     }
 
-    QVariant simpleValue(const QString &key) const
+    // Executes a cached prepared statement. A returned SELECT has to be
+    // finish()ed after reading so it doesn't keep the database locked.
+    QSqlQuery *query(const QString &sql, const QVariantList &values = {})
     {
-        QSqlQuery q(database());
-        q.prepare(QStringLiteral("SELECT value FROM simple_store WHERE key = ?"));
-        q.addBindValue(key);
-        if (!q.exec() || !q.next())
-            return {};
-        return q.value(0);
+        auto &q = statements[sql];
+        if (!q) {
+            q = QSharedPointer<QSqlQuery>::create(database());
+            if (!q->prepare(sql)) {
+                qWarning() << "OMEMO storage:" << q->lastError() << sql;
+                statements.remove(sql);
+                return nullptr;
+            }
+        }
+        for (int i = 0; i < values.size(); ++i)
+            q->bindValue(i, values[i]);
+        if (!q->exec()) {
+            qWarning() << "OMEMO storage:" << q->lastError() << sql;
+            return nullptr;
+        }
+        return q.data();
     }
 
-    bool setSimpleValue(const QString &key, const QVariant &value) const
+    bool write(const QString &sql, const QVariantList &values)
     {
-        QSqlQuery q(database());
-        q.prepare(QStringLiteral("INSERT OR REPLACE INTO simple_store (key, value) VALUES (?, ?)"));
-        q.addBindValue(key);
-        q.addBindValue(value);
-        return q.exec();
+        auto q = query(sql, values);
+        if (!q)
+            return false;
+        q->finish();
+        return true;
     }
 
-    bool removeSimpleValue(const QString &key) const
+    QVariant simpleValue(const QString &key)
     {
-        QSqlQuery q(database());
-        q.prepare(QStringLiteral("DELETE FROM simple_store WHERE key = ?"));
-        q.addBindValue(key);
-        return q.exec();
+        auto it = simpleValues.constFind(key);
+        if (it != simpleValues.cend())
+            return *it;
+        QVariant value;
+        if (auto q = query(QStringLiteral("SELECT value FROM simple_store WHERE key = ?"), { key })) {
+            if (q->next())
+                value = q->value(0);
+            q->finish();
+        }
+        simpleValues.insert(key, value);
+        return value;
+    }
+
+    bool setSimpleValue(const QString &key, const QVariant &value)
+    {
+        if (!write(QStringLiteral("INSERT OR REPLACE INTO simple_store (key, value) VALUES (?, ?)"), { key, value })) {
+            simpleValues.remove(key);
+            return false;
+        }
+        simpleValues.insert(key, value);
+        return true;
+    }
+
+    bool removeSimpleValue(const QString &key)
+    {
+        simpleValues.remove(key);
+        return write(QStringLiteral("DELETE FROM simple_store WHERE key = ?"), { key });
+    }
+
+    QHash<TrustKey, int> *trustOf(const QString &owner)
+    {
+        auto it = trust.find(owner);
+        if (it != trust.end())
+            return &it.value();
+        auto q = query(QStringLiteral("SELECT method, key, trust FROM encryption_trust WHERE jid = ?"), { owner });
+        if (!q)
+            return nullptr;
+        QHash<TrustKey, int> levels;
+        while (q->next())
+            levels.insert({ q->value(0).toString(), q->value(1).toByteArray() }, q->value(2).toInt());
+        q->finish();
+        return &trust.insert(owner, levels).value();
+    }
+
+    QHash<uint32_t, int> *legacyTrustOf(const QString &owner)
+    {
+        auto it = legacyTrust.find(owner);
+        if (it != legacyTrust.end())
+            return &it.value();
+        flush();
+        auto q = query(QStringLiteral("SELECT device_id, trust FROM devices WHERE jid = ?"), { owner });
+        if (!q)
+            return nullptr;
+        QHash<uint32_t, int> devices;
+        while (q->next())
+            devices.insert(q->value(0).toUInt(), q->value(1).toInt());
+        q->finish();
+        return &legacyTrust.insert(owner, devices).value();
+    }
+
+    void enqueue(const QString &key, std::function<bool()> &&op)
+    {
+        // moved to the end, so the latest write of a key goes after everything
+        // it may depend on
+        auto it = pendingIndex.find(key);
+        if (it != pendingIndex.end())
+            pending[it.value()] = nullptr;
+        pendingIndex.insert(key, pending.size());
+        pending.append(std::move(op));
+        if (pending.size() >= maxPendingWrites)
+            flush();
+        else if (!flushTimer.isActive())
+            flushTimer.start();
+    }
+
+    bool flush()
+    {
+        flushTimer.stop();
+        if (pending.isEmpty())
+            return true;
+        const auto ops = std::move(pending);
+        pending.clear();
+        pendingIndex.clear();
+
+        auto db = database();
+        bool ok = db.transaction();
+        for (int i = 0; ok && i < ops.size(); ++i)
+            ok = !ops[i] || ops[i]();
+        if (ok && db.commit())
+            return true;
+        db.rollback();
+
+        // do not lose everything because of a single broken write
+        ok = true;
+        for (const auto &op : ops) {
+            if (!op)
+                continue;
+            if (db.transaction() && op() && db.commit())
+                continue;
+            db.rollback();
+            ok = false;
+        }
+        if (!ok) {
+            // the caches may be ahead of the database now
+            qWarning() << "OMEMO storage: some changes were not saved:" << db.lastError().text();
+            dropCaches();
+        }
+        return ok;
+    }
+
+    void dropCaches()
+    {
+        simpleValues.clear();
+        trust.clear();
+        legacyTrust.clear();
+        sessions.clear();
+    }
+
+    static QString sessionKey(const QString &owner, uint32_t deviceId, XMPP::OmemoProtocol protocol)
+    {
+        return owner + QLatin1Char('\n') + QString::number(deviceId) + QLatin1Char('\n')
+            + QString::number(static_cast<int>(protocol));
+    }
+
+    // an unknown session is taken as changed, unless there is none
+    bool hasNewSession(const QString &owner, uint32_t deviceId, const Device &device) const
+    {
+        for (auto it = device.protocols.cbegin(); it != device.protocols.cend(); ++it) {
+            auto stored = sessions.constFind(sessionKey(owner, deviceId, it.key()));
+            if (stored == sessions.cend() ? !it->session.isEmpty() : *stored != it->session)
+                return true;
+        }
+        return false;
+    }
+
+    // addDevice() without a transaction
+    bool writeDevice(const QString &owner, uint32_t deviceId, const Device &device)
+    {
+        if (!write(QStringLiteral("DELETE FROM omemo_protocol_state WHERE jid = ? AND device_id = ?"),
+                   { owner, deviceId }))
+            return false;
+
+        const auto insertState
+            = QStringLiteral("INSERT INTO omemo_protocol_state "
+                             "(jid, device_id, protocol, label, label_signature, label_verified, key_id, session, "
+                             "last_received_ratchet_key, unresponded_sent, unresponded_received, removed_at) "
+                             "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+        for (auto it = device.protocols.cbegin(); it != device.protocols.cend(); ++it) {
+            if (!write(insertState,
+                       { owner, deviceId, static_cast<int>(it.key()), it->label, it->labelSignature,
+                         it->labelVerified ? 1 : 0, it->keyId, it->session, it->lastReceivedRatchetKey,
+                         it->unrespondedSentStanzasCount, it->unrespondedReceivedStanzasCount,
+                         dateTimeToDb(it->removalFromDeviceListDate) }))
+                return false;
+        }
+        for (auto protocol : { XMPP::OmemoProtocol::Legacy, XMPP::OmemoProtocol::Omemo2 })
+            sessions.remove(sessionKey(owner, deviceId, protocol));
+        for (auto it = device.protocols.cbegin(); it != device.protocols.cend(); ++it)
+            sessions.insert(sessionKey(owner, deviceId, it.key()), it->session);
+
+        const auto legacy = device.protocols.constFind(XMPP::OmemoProtocol::Legacy);
+        if (legacy == device.protocols.cend()) {
+            // Do not expose an OMEMO-2-only device to a downgraded legacy plugin.
+            return write(QStringLiteral("DELETE FROM devices WHERE jid = ? AND device_id = ?"), { owner, deviceId });
+        }
+
+        bool ok = legacy->keyId.isEmpty()
+            ? write(QStringLiteral("DELETE FROM identity_key_store WHERE jid = ? AND device_id = ?"),
+                    { owner, deviceId })
+            : write(QStringLiteral("INSERT OR REPLACE INTO identity_key_store (jid, device_id, key) VALUES (?, ?, ?)"),
+                    { owner, deviceId, legacy->keyId });
+        ok = ok
+            && (legacy->session.isEmpty()
+                    ? write(QStringLiteral("DELETE FROM session_store WHERE jid = ? AND device_id = ?"),
+                            { owner, deviceId })
+                    : write(QStringLiteral(
+                                "INSERT OR REPLACE INTO session_store (jid, device_id, session) VALUES (?, ?, ?)"),
+                            { owner, deviceId, legacy->session }));
+        if (!ok)
+            return false;
+
+        if (!legacy->removalFromDeviceListDate.isValid()) {
+            return write(QStringLiteral(
+                             "INSERT OR IGNORE INTO devices (jid, device_id, trust, label) VALUES (?, ?, 0, ?)"),
+                         { owner, deviceId, legacy->label })
+                && write(QStringLiteral("UPDATE devices SET label = ? WHERE jid = ? AND device_id = ?"),
+                         { legacy->label, owner, deviceId });
+        }
+        return write(QStringLiteral("DELETE FROM devices WHERE jid = ? AND device_id = ?"), { owner, deviceId });
     }
 
     bool initialize()
@@ -124,7 +346,9 @@ public:
                 "DEFAULT 0, unresponded_received INTEGER NOT NULL DEFAULT 0, removed_at TEXT, PRIMARY KEY(jid, "
                 "device_id, protocol))"),
             QStringLiteral("CREATE TABLE IF NOT EXISTS encryption_trust (method TEXT NOT NULL, jid TEXT NOT NULL, key "
-                           "BLOB NOT NULL, trust INTEGER NOT NULL, PRIMARY KEY(method, jid, key))")
+                           "BLOB NOT NULL, trust INTEGER NOT NULL, PRIMARY KEY(method, jid, key))"),
+            // trust is loaded per contact
+            QStringLiteral("CREATE INDEX IF NOT EXISTS encryption_trust_jid ON encryption_trust (jid)")
         };
         for (const auto &sql : statements) {
             if (!exec(sql))
@@ -186,6 +410,10 @@ PsiOmemoStorage::PsiOmemoStorage(const QString &dataPath, const QString &account
     if (QFileInfo::exists(oldShared) && !QFileInfo::exists(filePath))
         QFile::rename(oldShared, filePath);
 
+    d->flushTimer.setSingleShot(true);
+    d->flushTimer.setInterval(writeDelay);
+    QObject::connect(&d->flushTimer, &QTimer::timeout, [this]() { d->flush(); });
+
     d->connectionName = QStringLiteral("Psi OMEMO %1 %2").arg(accountId, QUuid::createUuid().toString());
     auto db           = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), d->connectionName);
     db.setDatabaseName(filePath);
@@ -200,6 +428,10 @@ PsiOmemoStorage::PsiOmemoStorage(const QString &dataPath, const QString &account
 
 PsiOmemoStorage::~PsiOmemoStorage()
 {
+    if (isOpen())
+        d->flush();
+    d->statements.clear();
+
     const QString name = d->connectionName;
     {
         auto db = QSqlDatabase::database(name, false);
@@ -212,11 +444,24 @@ PsiOmemoStorage::~PsiOmemoStorage()
 bool    PsiOmemoStorage::isOpen() const { return d->error.isEmpty() && d->database().isOpen(); }
 QString PsiOmemoStorage::errorString() const { return d->error; }
 
+bool PsiOmemoStorage::flush() { return isOpen() && d->flush(); }
+
 XMPP::OmemoStorage::OmemoData PsiOmemoStorage::allData() const
 {
     OmemoData data;
     if (!isOpen())
         return data;
+    d->flush();
+
+    // jids repeat for every device and table, parse each of them once
+    QHash<QString, QString> bareJids;
+    const auto              owner = [&bareJids](const QVariant &value) {
+        const QString jid = value.toString();
+        auto          it  = bareJids.constFind(jid);
+        if (it == bareJids.cend())
+            it = bareJids.insert(jid, bareJid(jid));
+        return *it;
+    };
 
     const auto registrationId = d->simpleValue(QStringLiteral("registration_id"));
     const auto publicKey      = d->simpleValue(QStringLiteral("own_public_key"));
@@ -269,15 +514,20 @@ XMPP::OmemoStorage::OmemoData PsiOmemoStorage::allData() const
         = [](const QString &owner, uint32_t id) { return owner + QLatin1Char('\n') + QString::number(id); };
     {
         QSqlQuery q(d->database());
-        if (q.exec(QStringLiteral("SELECT jid, device_id, label FROM devices"))) {
+        QHash<QString, QHash<uint32_t, int>> legacyTrust;
+        if (q.exec(QStringLiteral("SELECT jid, device_id, label, trust FROM devices"))) {
             while (q.next()) {
-                const QString owner = bareJid(q.value(0).toString());
+                const QString jid   = owner(q.value(0));
                 const auto    id    = q.value(1).toUInt();
-                auto         &state = data.devices[owner][id].protocols[XMPP::OmemoProtocol::Legacy];
+                auto         &state = data.devices[jid][id].protocols[XMPP::OmemoProtocol::Legacy];
                 state.label         = q.value(2).toString();
                 // Active legacy record: invalid removal date.
-                activeLegacyDevices.insert(legacyDeviceKey(owner, id));
+                activeLegacyDevices.insert(legacyDeviceKey(jid, id));
+                if (jid == q.value(0).toString())
+                    legacyTrust[jid].insert(id, q.value(3).toInt());
             }
+            // the plugin trust is looked up for every device right after this
+            d->legacyTrust = legacyTrust;
         }
     }
 
@@ -287,11 +537,11 @@ XMPP::OmemoStorage::OmemoData PsiOmemoStorage::allData() const
         QSqlQuery q(d->database());
         if (q.exec(QStringLiteral("SELECT jid, device_id, key FROM identity_key_store"))) {
             while (q.next()) {
-                const QString owner = bareJid(q.value(0).toString());
+                const QString jid   = owner(q.value(0));
                 const auto    id    = q.value(1).toUInt();
-                auto         &state = data.devices[owner][id].protocols[XMPP::OmemoProtocol::Legacy];
+                auto         &state = data.devices[jid][id].protocols[XMPP::OmemoProtocol::Legacy];
                 state.keyId         = q.value(2).toByteArray();
-                if (!activeLegacyDevices.contains(legacyDeviceKey(owner, id)))
+                if (!activeLegacyDevices.contains(legacyDeviceKey(jid, id)))
 #if QT_VERSION < QT_VERSION_CHECK(6, 9, 0)
                     state.removalFromDeviceListDate = QDateTime::fromMSecsSinceEpoch(0, Qt::UTC);
 #else
@@ -304,11 +554,11 @@ XMPP::OmemoStorage::OmemoData PsiOmemoStorage::allData() const
         QSqlQuery q(d->database());
         if (q.exec(QStringLiteral("SELECT jid, device_id, session FROM session_store"))) {
             while (q.next()) {
-                const QString owner = bareJid(q.value(0).toString());
+                const QString jid   = owner(q.value(0));
                 const auto    id    = q.value(1).toUInt();
-                auto         &state = data.devices[owner][id].protocols[XMPP::OmemoProtocol::Legacy];
+                auto         &state = data.devices[jid][id].protocols[XMPP::OmemoProtocol::Legacy];
                 state.session       = q.value(2).toByteArray();
-                if (!activeLegacyDevices.contains(legacyDeviceKey(owner, id)))
+                if (!activeLegacyDevices.contains(legacyDeviceKey(jid, id)))
 #if QT_VERSION < QT_VERSION_CHECK(6, 9, 0)
                     state.removalFromDeviceListDate = QDateTime::fromMSecsSinceEpoch(0, Qt::UTC);
 #else
@@ -335,8 +585,7 @@ XMPP::OmemoStorage::OmemoData PsiOmemoStorage::allData() const
         if (q.exec(QStringLiteral(
                 "SELECT jid, device_id, label, label_signature, label_verified FROM omemo_device_meta"))) {
             while (q.next()) {
-                const QString owner = bareJid(q.value(0).toString());
-                oldModernMeta.insert(metaKey(owner, q.value(1).toUInt()),
+                oldModernMeta.insert(metaKey(owner(q.value(0)), q.value(1).toUInt()),
                                      { q.value(2).toString(), q.value(3).toByteArray(), q.value(4).toBool() });
             }
         }
@@ -351,12 +600,12 @@ XMPP::OmemoStorage::OmemoData PsiOmemoStorage::allData() const
                 const auto protocol = static_cast<XMPP::OmemoProtocol>(q.value(2).toUInt());
                 if (protocol != XMPP::OmemoProtocol::Legacy && protocol != XMPP::OmemoProtocol::Omemo2)
                     continue;
-                auto &state = data.devices[bareJid(q.value(0).toString())][q.value(1).toUInt()].protocols[protocol];
+                const QString jid   = owner(q.value(0));
+                auto         &state = data.devices[jid][q.value(1).toUInt()].protocols[protocol];
                 // Rows created before this schema change expose NULL in these
                 // columns. Preserve the OMEMO 2 migration fallback in that
                 // case, but only for a real protocol-state row.
-                const auto oldMeta
-                    = oldModernMeta.constFind(metaKey(bareJid(q.value(0).toString()), q.value(1).toUInt()));
+                const auto oldMeta = oldModernMeta.constFind(metaKey(jid, q.value(1).toUInt()));
                 if (!q.value(3).isNull())
                     state.label = q.value(3).toString();
                 else if (protocol == XMPP::OmemoProtocol::Omemo2 && oldMeta != oldModernMeta.cend())
@@ -378,6 +627,15 @@ XMPP::OmemoStorage::OmemoData PsiOmemoStorage::allData() const
             }
         }
     }
+
+    // addDevice() writes a session right away only when it differs from these
+    d->sessions.clear();
+    for (auto contact = data.devices.cbegin(); contact != data.devices.cend(); ++contact) {
+        for (auto device = contact->cbegin(); device != contact->cend(); ++device) {
+            for (auto it = device->protocols.cbegin(); it != device->protocols.cend(); ++it)
+                d->sessions.insert(Private::sessionKey(contact.key(), device.key(), it.key()), it->session);
+        }
+    }
     return data;
 }
 
@@ -464,131 +722,43 @@ bool PsiOmemoStorage::removePreKeyPair(uint32_t keyId)
 
 bool PsiOmemoStorage::addDevice(const QString &jid, uint32_t deviceId, const Device &device)
 {
-    const QString owner = bareJid(jid);
-    auto          db    = d->database();
-    if (!db.transaction())
-        return false;
-
-    QSqlQuery clear(db);
-    clear.prepare(QStringLiteral("DELETE FROM omemo_protocol_state WHERE jid = ? AND device_id = ?"));
-    clear.addBindValue(owner);
-    clear.addBindValue(deviceId);
-    if (!clear.exec()) {
-        db.rollback();
+    if (!isOpen())
         return false;
-    }
-
-    QSqlQuery stateQuery(db);
-    stateQuery.prepare(
-        QStringLiteral("INSERT INTO omemo_protocol_state "
-                       "(jid, device_id, protocol, label, label_signature, label_verified, key_id, session, "
-                       "last_received_ratchet_key, unresponded_sent, unresponded_received, removed_at) "
-                       "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"));
-    for (auto it = device.protocols.cbegin(); it != device.protocols.cend(); ++it) {
-        stateQuery.bindValue(0, owner);
-        stateQuery.bindValue(1, deviceId);
-        stateQuery.bindValue(2, static_cast<int>(it.key()));
-        stateQuery.bindValue(3, it->label);
-        stateQuery.bindValue(4, it->labelSignature);
-        stateQuery.bindValue(5, it->labelVerified ? 1 : 0);
-        stateQuery.bindValue(6, it->keyId);
-        stateQuery.bindValue(7, it->session);
-        stateQuery.bindValue(8, it->lastReceivedRatchetKey);
-        stateQuery.bindValue(9, it->unrespondedSentStanzasCount);
-        stateQuery.bindValue(10, it->unrespondedReceivedStanzasCount);
-        stateQuery.bindValue(11, dateTimeToDb(it->removalFromDeviceListDate));
-        if (!stateQuery.exec()) {
-            db.rollback();
-            return false;
-        }
-        stateQuery.finish();
-    }
-
-    const auto legacy = device.protocols.constFind(XMPP::OmemoProtocol::Legacy);
-    if (legacy != device.protocols.cend()) {
-        QSqlQuery identity(db);
-        if (legacy->keyId.isEmpty()) {
-            identity.prepare(QStringLiteral("DELETE FROM identity_key_store WHERE jid = ? AND device_id = ?"));
+    const QString owner  = bareJid(jid);
+    const auto    legacy = device.protocols.constFind(XMPP::OmemoProtocol::Legacy);
+    // 0 - no legacy protocol, 1 - removed from the legacy device list, 2 - active legacy device.
+    // Writes of the same kind touch the same rows the same way, so only the latest one matters
+    const int kind = legacy == device.protocols.cend() ? 0 : (legacy->removalFromDeviceListDate.isValid() ? 1 : 2);
+
+    auto devices = d->legacyTrust.find(owner);
+    if (devices != d->legacyTrust.end()) {
+        if (kind == 2) {
+            if (!devices->contains(deviceId))
+                devices->insert(deviceId, static_cast<int>(LegacyTrust::Undecided));
         } else {
-            identity.prepare(
-                QStringLiteral("INSERT OR REPLACE INTO identity_key_store (jid, device_id, key) VALUES (?, ?, ?)"));
-        }
-        identity.addBindValue(owner);
-        identity.addBindValue(deviceId);
-        if (!legacy->keyId.isEmpty())
-            identity.addBindValue(legacy->keyId);
-        if (!identity.exec()) {
-            db.rollback();
-            return false;
-        }
-
-        QSqlQuery session(db);
-        if (legacy->session.isEmpty()) {
-            session.prepare(QStringLiteral("DELETE FROM session_store WHERE jid = ? AND device_id = ?"));
-        } else {
-            session.prepare(
-                QStringLiteral("INSERT OR REPLACE INTO session_store (jid, device_id, session) VALUES (?, ?, ?)"));
-        }
-        session.addBindValue(owner);
-        session.addBindValue(deviceId);
-        if (!legacy->session.isEmpty())
-            session.addBindValue(legacy->session);
-        if (!session.exec()) {
-            db.rollback();
-            return false;
-        }
-
-        if (!legacy->removalFromDeviceListDate.isValid()) {
-            QSqlQuery insertDevice(db);
-            insertDevice.prepare(
-                QStringLiteral("INSERT OR IGNORE INTO devices (jid, device_id, trust, label) VALUES (?, ?, 0, ?)"));
-            insertDevice.addBindValue(owner);
-            insertDevice.addBindValue(deviceId);
-            insertDevice.addBindValue(legacy->label);
-            if (!insertDevice.exec()) {
-                db.rollback();
-                return false;
-            }
-            QSqlQuery label(db);
-            label.prepare(QStringLiteral("UPDATE devices SET label = ? WHERE jid = ? AND device_id = ?"));
-            label.addBindValue(legacy->label);
-            label.addBindValue(owner);
-            label.addBindValue(deviceId);
-            if (!label.exec()) {
-                db.rollback();
-                return false;
-            }
-        } else {
-            QSqlQuery removeActive(db);
-            removeActive.prepare(QStringLiteral("DELETE FROM devices WHERE jid = ? AND device_id = ?"));
-            removeActive.addBindValue(owner);
-            removeActive.addBindValue(deviceId);
-            if (!removeActive.exec()) {
-                db.rollback();
-                return false;
-            }
-        }
-    } else {
-        // Do not expose an OMEMO-2-only device to a downgraded legacy plugin.
-        QSqlQuery removeLegacyActive(db);
-        removeLegacyActive.prepare(QStringLiteral("DELETE FROM devices WHERE jid = ? AND device_id = ?"));
-        removeLegacyActive.addBindValue(owner);
-        removeLegacyActive.addBindValue(deviceId);
-        if (!removeLegacyActive.exec()) {
-            db.rollback();
-            return false;
+            devices->remove(deviceId);
         }
     }
 
-    return db.commit();
+    const bool newSession = d->hasNewSession(owner, deviceId, device);
+    auto       p          = d.get();
+    d->enqueue(QStringLiteral("device\n%1\n%2\n%3").arg(owner, QString::number(deviceId), QString::number(kind)),
+               [p, owner, deviceId, device]() { return p->writeDevice(owner, deviceId, device); });
+    // together with everything queued before, so an older write can't overwrite it later
+    return !newSession || d->flush();
 }
 
 bool PsiOmemoStorage::removeDevice(const QString &jid, uint32_t deviceId)
 {
     const QString owner = bareJid(jid);
     auto          db    = d->database();
-    if (!db.transaction())
+    if (!d->flush() || !db.transaction())
         return false;
+    auto devices = d->legacyTrust.find(owner);
+    if (devices != d->legacyTrust.end())
+        devices->remove(deviceId);
+    for (auto protocol : { XMPP::OmemoProtocol::Legacy, XMPP::OmemoProtocol::Omemo2 })
+        d->sessions.remove(Private::sessionKey(owner, deviceId, protocol));
     const QStringList tables { QStringLiteral("omemo_device_meta"), QStringLiteral("omemo_protocol_state"),
                                QStringLiteral("devices"), QStringLiteral("identity_key_store"),
                                QStringLiteral("session_store") };
@@ -609,8 +779,11 @@ bool PsiOmemoStorage::removeDevices(const QString &jid)
 {
     const QString owner = bareJid(jid);
     auto          db    = d->database();
-    if (!db.transaction())
+    if (!d->flush() || !db.transaction())
         return false;
+    d->legacyTrust.remove(owner);
+    for (auto it = d->sessions.begin(); it != d->sessions.end();)
+        it = it.key().startsWith(owner + QLatin1Char('\n')) ? d->sessions.erase(it) : std::next(it);
     const QStringList tables { QStringLiteral("omemo_device_meta"), QStringLiteral("omemo_protocol_state"),
                                QStringLiteral("devices"), QStringLiteral("identity_key_store"),
                                QStringLiteral("session_store") };
@@ -629,6 +802,8 @@ bool PsiOmemoStorage::removeDevices(const QString &jid)
 bool PsiOmemoStorage::resetAll()
 {
     auto db = d->database();
+    d->flush();
+    d->dropCaches();
     if (!db.transaction())
         return false;
     const QStringList tables { QStringLiteral("omemo_signed_pre_key_store"),
@@ -660,36 +835,57 @@ bool PsiOmemoStorage::resetAll()
 XMPP::EncryptionTrustLevel PsiOmemoStorage::trustLevel(const QString &methodId, const XMPP::Jid &owner,
                                                        const QByteArray &keyId) const
 {
-    QSqlQuery q(d->database());
-    q.prepare(QStringLiteral("SELECT trust FROM encryption_trust WHERE method = ? AND jid = ? AND key = ?"));
-    q.addBindValue(methodId);
-    q.addBindValue(owner.bare());
-    q.addBindValue(keyId);
-    if (!q.exec() || !q.next())
+    const auto levels = d->trustOf(owner.bare());
+    if (!levels)
         return XMPP::EncryptionTrustLevel::Undecided;
-    return static_cast<XMPP::EncryptionTrustLevel>(q.value(0).toUInt());
+    const auto it = levels->constFind({ methodId, keyId });
+    if (it == levels->cend())
+        return XMPP::EncryptionTrustLevel::Undecided;
+    return static_cast<XMPP::EncryptionTrustLevel>(*it);
 }
 
 bool PsiOmemoStorage::setTrustLevel(const QString &methodId, const XMPP::Jid &owner, const QByteArray &keyId,
                                     XMPP::EncryptionTrustLevel level)
 {
-    QSqlQuery q(d->database());
-    q.prepare(QStringLiteral("INSERT OR REPLACE INTO encryption_trust (method, jid, key, trust) VALUES (?, ?, ?, ?)"));
-    q.addBindValue(methodId);
-    q.addBindValue(owner.bare());
-    q.addBindValue(keyId);
-    q.addBindValue(static_cast<int>(level));
-    return q.exec();
+    const QString jid    = owner.bare();
+    const auto    levels = d->trustOf(jid);
+    if (!levels)
+        return false;
+    const auto it = levels->constFind({ methodId, keyId });
+    if (it != levels->cend() && *it == static_cast<int>(level))
+        return true;
+    levels->insert({ methodId, keyId }, static_cast<int>(level));
+
+    auto p = d.get();
+    d->enqueue(QStringLiteral("trust\n%1\n%2\n").arg(methodId, jid) + QString::fromLatin1(keyId.toHex()),
+               [p, methodId, jid, keyId, level]() {
+                   return p->write(QStringLiteral("INSERT OR REPLACE INTO encryption_trust (method, jid, key, trust) "
+                                                  "VALUES (?, ?, ?, ?)"),
+                                   { methodId, jid, keyId, static_cast<int>(level) });
+               });
+    // a decision of the user. the automatic levels are simply decided again
+    const bool manual = level == XMPP::EncryptionTrustLevel::ManuallyTrusted
+        || level == XMPP::EncryptionTrustLevel::Distrusted || level == XMPP::EncryptionTrustLevel::Authenticated;
+    return !manual || d->flush();
 }
 
 bool PsiOmemoStorage::removeTrust(const QString &methodId, const XMPP::Jid &owner, const QByteArray &keyId)
 {
-    QSqlQuery q(d->database());
-    q.prepare(QStringLiteral("DELETE FROM encryption_trust WHERE method = ? AND jid = ? AND key = ?"));
-    q.addBindValue(methodId);
-    q.addBindValue(owner.bare());
-    q.addBindValue(keyId);
-    return q.exec();
+    const QString jid    = owner.bare();
+    const auto    levels = d->trustOf(jid);
+    if (!levels)
+        return false;
+    if (!levels->remove({ methodId, keyId }))
+        return true;
+
+    auto p = d.get();
+    d->enqueue(QStringLiteral("trust\n%1\n%2\n").arg(methodId, jid) + QString::fromLatin1(keyId.toHex()),
+               [p, methodId, jid, keyId]() {
+                   return p->write(
+                       QStringLiteral("DELETE FROM encryption_trust WHERE method = ? AND jid = ? AND key = ?"),
+                       { methodId, jid, keyId });
+               });
+    return d->flush(); // a forgotten key must not come back trusted
 }
 
 QSet<QString> PsiOmemoStorage::legacyEnabledJids() const
@@ -734,26 +930,36 @@ bool PsiOmemoStorage::setLegacyDisabled(const QString &jid, bool disabled)
 
 std::optional<PsiOmemoStorage::LegacyTrust> PsiOmemoStorage::legacyTrust(const QString &jid, uint32_t deviceId) const
 {
-    QSqlQuery q(d->database());
-    q.prepare(QStringLiteral("SELECT trust FROM devices WHERE jid = ? AND device_id = ?"));
-    q.addBindValue(bareJid(jid));
-    q.addBindValue(deviceId);
-    if (!q.exec() || !q.next())
+    const auto devices = d->legacyTrustOf(bareJid(jid));
+    if (!devices)
         return std::nullopt;
-    const int value = q.value(0).toInt();
-    if (value < 0 || value > 2)
+    const auto it = devices->constFind(deviceId);
+    if (it == devices->cend() || *it < 0 || *it > 2)
         return std::nullopt;
-    return static_cast<LegacyTrust>(value);
+    return static_cast<LegacyTrust>(*it);
 }
 
 bool PsiOmemoStorage::setLegacyTrust(const QString &jid, uint32_t deviceId, LegacyTrust trust)
 {
-    QSqlQuery q(d->database());
-    q.prepare(QStringLiteral("UPDATE devices SET trust = ? WHERE jid = ? AND device_id = ?"));
-    q.addBindValue(static_cast<int>(trust));
-    q.addBindValue(bareJid(jid));
-    q.addBindValue(deviceId);
-    return q.exec();
+    // the row may be still waiting in the write queue
+    if (!d->flush())
+        return false;
+    const QString owner   = bareJid(jid);
+    const auto    devices = d->legacyTrustOf(owner);
+    if (!devices)
+        return false;
+    auto it = devices->find(deviceId);
+    if (it == devices->end())
+        return true; // nothing to update, as with the plain UPDATE
+    if (*it == static_cast<int>(trust))
+        return true;
+    if (!d->write(QStringLiteral("UPDATE devices SET trust = ? WHERE jid = ? AND device_id = ?"),
+                  { static_cast<int>(trust), owner, deviceId })) {
+        d->legacyTrust.remove(owner);
+        return false;
+    }
+    *it = static_cast<int>(trust);
+    return true;
 }
 
 #endif // IRIS_ENABLE_OMEMO
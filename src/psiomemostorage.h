@@ -34,6 +34,10 @@ public:
     bool    isOpen() const;
     QString errorString() const;
 
+    // Device state and trust changes are kept in memory and written shortly
+    // after in one transaction. Writes everything still pending right now.
+    bool flush();
+
     OmemoData allData() const override;
     bool      setOwnDevice(const std::optional<OwnDevice> &device) override;
     bool      addSignedPreKeyPair(uint32_t keyId, const SignedPreKeyPair &keyPair) override;
@@ -28,11 +28,13 @@
 #include "iris/xmpp_jid.h"
 #include "iris/xmpp_task.h"
 #include "iris/xmpp_xmlcommon.h"
+#include "optionscache.h"
 #include "psitoolbar.h"
 #include "statuspreset.h"
 
 #include <QCoreApplication>
 #include <QTimer>
+#include <QtConcurrent>
 
 using namespace XMPP;
 
@@ -212,7 +214,46 @@ bool PsiOptions::exists(QString fileName) { return OptionsTree::exists(fileName)
  * \param file Name of the xml config file to load
  * \return Success
  */
-bool PsiOptions::load(QString file) { return loadOptions(file, "options", ApplicationInfo::optionsNS()); }
+bool PsiOptions::load(QString file)
+{
+    if (loadCache(file)) {
+        return true;
+    }
+    return loadOptions(file, "options", ApplicationInfo::optionsNS());
+}
+
+/**
+ * Loads system-wide defaults overriding the built-in ones. Unlike options
+ * loaded with load() they are defaults too, so options equal to them are
+ * not saved and resetOption() restores them.
+ * \param file Name of the xml file with the defaults
+ * \return Success
+ */
+bool PsiOptions::loadDefaults(const QString &file)
+{
+    defaults(); // to init defaults_
+    if (defaults_ != this) {
+        defaults_->loadOptions(file, "options", ApplicationInfo::optionsNS());
+    }
+    return loadOptions(file, "options", ApplicationInfo::optionsNS());
+}
+
+/**
+ * Loads the binary cache written along with \a file if it's still valid for it.
+ * \return false if there is no usable cache and the xml has to be parsed.
+ */
+bool PsiOptions::loadCache(const QString &file)
+{
+    QVariantMap options;
+    if (!OptionsCache::read(file, options)) {
+        return false;
+    }
+    for (auto it = options.cbegin(); it != options.cend(); ++it) {
+        setOption(it.key(), it.value());
+    }
+    return true;
+}
+
 
 /**
  * Loads the options stored in the private storage of
@@ -264,8 +305,9 @@ PsiOptions::~PsiOptions()
     // since we queue connection to saveToAutoFile, so if some option was saved prior
     // to program termination, the PsiOptions is never given the chance to save
     // the changed option
+    saving_.waitForFinished();
     if (!autoFile_.isEmpty()) {
-        saveToAutoFile();
+        write(autoFile_, changedOptions(), ApplicationInfo::optionsNS(), ApplicationInfo::version());
     }
 }
 
@@ -287,12 +329,35 @@ void PsiOptions::autoSave(bool autoSave, QString autoFile)
 }
 
 /**
- * Saves to the previously set file, if automatic saving is enabled
+ * Saves to the previously set file, if automatic saving is enabled.
+ * Only the options differing from the defaults are saved. They are copied
+ * here and written by a pool thread, so the gui doesn't wait for the disk.
  */
 void PsiOptions::saveToAutoFile()
 {
-    if (!autoFile_.isEmpty()) {
-        save(autoFile_);
+    if (autoFile_.isEmpty()) {
+        return;
+    }
+    if (saving_.isRunning()) {
+        autoSaveTimer_->start(); // the previous snapshot is still being written
+        return;
+    }
+    saving_ = QtConcurrent::run([file = autoFile_, options = changedOptions(), ns = ApplicationInfo::optionsNS(),
+                                 version = ApplicationInfo::version()]() { write(file, options, ns, version); });
+}
+
+/**
+ * Options with values differing from the built-in and system-wide defaults, including the ones missing in them
+ */
+QVariantMap PsiOptions::changedOptions() const { return OptionsCache::changedOptions(*this, *defaults()); }
+
+/**
+ * Writes \a options to the xml \a file and to its binary cache. Safe to call from any thread.
+ */
+void PsiOptions::write(const QString &file, const QVariantMap &options, const QString &ns, const QString &version)
+{
+    if (!OptionsCache::write(file, options, ns, version)) {
+        qWarning("psioptions: failed to save %s", qPrintable(file));
     }
 }
 
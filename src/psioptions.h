@@ -22,6 +22,8 @@
 
 #include "optionstree.h"
 
+#include <QFuture>
+
 // Some hard coded options
 #define MINIMUM_OPACITY 10
 
@@ -43,6 +45,7 @@ public:
     static bool exists(QString fileName);
     ~PsiOptions();
     bool load(QString file);
+    bool loadDefaults(const QString &file);
     void load(XMPP::Client *client);
     bool newProfile();
     bool save(QString file);
@@ -57,8 +60,13 @@ private slots:
     void getOptionsStorage_finished();
 
 private:
+    QVariantMap changedOptions() const;
+    bool        loadCache(const QString &file);
+    static void write(const QString &file, const QVariantMap &options, const QString &ns, const QString &version);
+
     QString            autoFile_;
     QTimer            *autoSaveTimer_;
+    QFuture<void>      saving_;
     static PsiOptions *instance_;
     static PsiOptions *defaults_;
 };
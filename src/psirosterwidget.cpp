@@ -31,6 +31,8 @@
 #include "psicontactlistview.h"
 #include "psifilteredcontactlistview.h"
 #include "psioptions.h"
+#include "rostersearchindex.h"
+#include "vcardfactory.h"
 #include "widgets/actionlineedit.h"
 #include "widgets/iconaction.h"
 
@@ -40,6 +42,7 @@
 #include <QMimeData>
 #include <QSortFilterProxyModel>
 #include <QStackedWidget>
+#include <QTimer>
 #include <QVBoxLayout>
 
 static const QString contactSortStyleOptionPath   = "options.ui.contactlist.contact-sort-style";
@@ -62,32 +65,33 @@ public:
     PsiRosterFilterProxyModel(QObject *parent) : QSortFilterProxyModel(parent)
     {
         sort(0, Qt::AscendingOrder);
-        setFilterCaseSensitivity(Qt::CaseInsensitive);
         setSortLocaleAware(true);
     }
 
+    void setSearchResults(const QString &query, const QList<RosterSearchIndex::Match> &matches)
+    {
+        query_ = query;
+        scores_.clear();
+        scores_.reserve(matches.size());
+        for (const auto &m : matches)
+            scores_.insert(m.key, m.score);
+        invalidate();
+    }
+
 protected:
     // reimplemented
     bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
     {
-        QModelIndex index = sourceModel()->index(sourceRow, 0, sourceParent);
-
-        QStringList data;
-        if (index.isValid()) {
-            // TODO: also check for vCard value
-            data << index.data(Qt::DisplayRole).toString() << index.data(ContactListModel::JidRole).toString();
-        }
-
-        for (const QString &str : std::as_const(data)) {
-#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
-            if (str.contains(filterRegExp()))
-#else
-            if (str.contains(filterRegularExpression()))
-#endif
-                return true;
-        }
+        if (query_.isEmpty())
+            return true;
 
-        return false;
+        QModelIndex      index = sourceModel()->index(sourceRow, 0, sourceParent);
+        ContactListItem *item  = static_cast<ContactListItem *>(index.internalPointer());
+        if (!item)
+            return false;
+        if (item->isContact())
+            return scores_.contains(item->contact());
+        return item->name().contains(query_, Qt::CaseInsensitive);
     }
 
     // reimplemented
@@ -97,8 +101,18 @@ protected:
         ContactListItem *item2 = static_cast<ContactListItem *>(right.internalPointer());
         if (!item1 || !item2)
             return false;
+        if (item1->isContact() && item2->isContact()) {
+            int score1 = scores_.value(item1->contact());
+            int score2 = scores_.value(item2->contact());
+            if (score1 != score2)
+                return score1 > score2; // most relevant first
+        }
         return item1->lessThan(item2);
     }
+
+private:
+    QString               query_;
+    QHash<QObject *, int> scores_;
 };
 
 //----------------------------------------------------------------------------
@@ -161,7 +175,14 @@ void PsiRosterWidget::setContactList(PsiContactList *contactList)
     Q_ASSERT(contactList);
     Q_ASSERT(!contactList_);
     contactList_ = contactList;
-    connect(PsiOptions::instance(), SIGNAL(optionChanged(const QString &)), SLOT(optionChanged(const QString &)));
+    for (const QString &option : { contactSortStyleOptionPath, showOfflineOptionPath, showHiddenOptionPath,
+                                   showAgentsOptionPath, showSelfOptionPath, allowAutoResizeOptionPath,
+                                   showScrollBarOptionPath, enableGroupsOptionPath }) {
+        PsiOptions::instance()->subscribe(option, this, [this](const QStringList &changed) {
+            for (const QString &option : changed)
+                optionChanged(option);
+        });
+    }
 
     connect(contactList_, SIGNAL(showAgentsChanged(bool)), SLOT(showAgentsChanged(bool)));
     connect(contactList_, SIGNAL(showHiddenChanged(bool)), SLOT(showHiddenChanged(bool)));
@@ -243,12 +264,97 @@ void PsiRosterWidget::setShowStatusMsg(bool enabled)
 
 void PsiRosterWidget::filterEditTextChanged(const QString &text)
 {
+    if (!filterModel_)
+        return;
+    ensureSearchIndex();
+    filterModel_->setSearchResults(text, searchIndex_->search(text));
+}
+
+void PsiRosterWidget::ensureSearchIndex()
+{
+    if (searchIndex_)
+        return;
+
+    SLOW_TIMER(100);
+    searchIndex_.reset(new RosterSearchIndex);
+    searchUpdateTimer_ = new QTimer(this);
+    searchUpdateTimer_->setSingleShot(true);
+    searchUpdateTimer_->setInterval(200);
+    connect(searchUpdateTimer_, &QTimer::timeout, this, [this]() {
+        if (filterModel_)
+            filterEditTextChanged(filterEdit_->text());
+    });
+
+    if (!contactList_)
+        return;
+    const auto &contacts = contactList_->contacts();
+    for (PsiContact *contact : contacts)
+        indexContact(contact);
+    connect(contactList_, &PsiContactList::addedContact, this, &PsiRosterWidget::indexContact);
+    connect(contactList_, &PsiContactList::removedContact, this, &PsiRosterWidget::unindexContact);
+    connect(VCardFactory::instance(), &VCardFactory::vcardChanged, this, &PsiRosterWidget::searchVCardChanged);
+}
+
+RosterSearchIndex::Fields PsiRosterWidget::searchFields(PsiContact *contact)
+{
+    RosterSearchIndex::Fields fields { { RosterSearchIndex::NameField, contact->name() },
+                                       { RosterSearchIndex::JidField, contact->jid().full() } };
+    const auto groups = contact->groups();
+    for (const QString &group : groups)
+        fields.append({ RosterSearchIndex::GroupField, group });
+
+    // VCardFactory keeps just a few vcards in memory, so remember the names from those seen
+    QString bare = contact->jid().bare();
+    auto    it   = vcardNames_.constFind(bare);
+    if (it == vcardNames_.constEnd()) {
+        auto vcard = VCardFactory::instance()->cachedVcard(contact->jid());
+        if (!vcard)
+            return fields;
+        it = vcardNames_.insert(bare, { vcard.nickName().preferred().data.value(0), vcard.fullName().preferred() });
+    }
+    fields.append({ RosterSearchIndex::NickField, it->first });
+    fields.append({ RosterSearchIndex::VCardField, it->second });
+    return fields;
+}
+
+void PsiRosterWidget::indexContact(PsiContact *contact)
+{
+    if (!searchIndex_->setEntry(contact, searchFields(contact)))
+        return;
+    connect(contact, &PsiContact::updated, this, &PsiRosterWidget::searchContactUpdated, Qt::UniqueConnection);
+    connect(contact, &PsiContact::groupsChanged, this, &PsiRosterWidget::searchContactUpdated,
+            Qt::UniqueConnection);
+    connect(contact, &QObject::destroyed, this, &PsiRosterWidget::unindexContact, Qt::UniqueConnection);
     if (filterModel_)
-#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
-        filterModel_->setFilterRegExp(QRegularExpression::escape(text));
-#else
-        filterModel_->setFilterRegularExpression(QRegularExpression::escape(text));
-#endif
+        searchUpdateTimer_->start();
+}
+
+void PsiRosterWidget::unindexContact(QObject *contact)
+{
+    disconnect(contact, nullptr, this, nullptr);
+    searchIndex_->removeEntry(contact);
+    if (filterModel_)
+        searchUpdateTimer_->start();
+}
+
+void PsiRosterWidget::searchContactUpdated()
+{
+    PsiContact *contact = qobject_cast<PsiContact *>(sender());
+    if (contact && searchIndex_->setEntry(contact, searchFields(contact)) && filterModel_)
+        searchUpdateTimer_->start();
+}
+
+void PsiRosterWidget::searchVCardChanged(const XMPP::Jid &jid)
+{
+    if (!contactList_)
+        return;
+    vcardNames_.remove(jid.bare());
+    const auto &accounts = contactList_->enabledAccounts();
+    for (PsiAccount *account : accounts) {
+        PsiContact *contact = account->findContact(jid.bare());
+        if (contact && searchIndex_->setEntry(contact, searchFields(contact)) && filterModel_)
+            searchUpdateTimer_->start();
+    }
 }
 
 void PsiRosterWidget::quitFilteringMode()
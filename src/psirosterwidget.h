@@ -20,18 +20,28 @@
 #ifndef PSIROSTERWIDGET_H
 #define PSIROSTERWIDGET_H
 
+#include "rostersearchindex.h"
+
+#include <QHash>
 #include <QPointer>
 #include <QWidget>
 
+#include <memory>
+
 class ContactListDragModel;
 class PsiContactList;
 class PsiContactListView;
 class PsiFilteredContactListView;
 class PsiContact;
+class PsiRosterFilterProxyModel;
 class QLineEdit;
 class QMimeData;
-class QSortFilterProxyModel;
 class QStackedWidget;
+class QTimer;
+
+namespace XMPP {
+class Jid;
+}
 
 class PsiRosterWidget : public QWidget {
     Q_OBJECT
@@ -60,11 +70,19 @@ private slots:
     void showHiddenChanged(bool);
     void showSelfChanged(bool);
     void showOfflineChanged(bool);
+    void indexContact(PsiContact *contact);
+    void unindexContact(QObject *contact);
+    void searchContactUpdated();
+    void searchVCardChanged(const XMPP::Jid &jid);
 
 protected:
     bool eventFilter(QObject *obj, QEvent *e);
 
 private:
+    // built on the first search and kept up to date after that
+    void                      ensureSearchIndex();
+    RosterSearchIndex::Fields searchFields(PsiContact *contact);
+
     QPointer<PsiContactList>    contactList_;
     QStackedWidget             *stackedWidget_;
     QWidget                    *contactListPage_;
@@ -73,9 +91,12 @@ private:
     PsiFilteredContactListView *filterPageView_;
     QLineEdit                  *filterEdit_;
 
-    ContactListDragModel  *contactListModel_;
-    QSortFilterProxyModel *filterModel_;
-    bool                   pickContactMode_ = false;
+    ContactListDragModel                   *contactListModel_;
+    PsiRosterFilterProxyModel              *filterModel_;
+    std::unique_ptr<RosterSearchIndex>      searchIndex_;
+    QTimer                                 *searchUpdateTimer_ = nullptr;
+    QHash<QString, QPair<QString, QString>> vcardNames_; // bare jid -> nick, full name
+    bool                                    pickContactMode_ = false;
 };
 
 #endif // PSIROSTERWIDGET_H
@@ -38,7 +38,14 @@ RosterAvatarFrame::RosterAvatarFrame(QWidget *parent) : QFrame(parent), statusMe
     connect(ui_.le_status_text, SIGNAL(returnPressed()), this, SLOT(statusMessageReturnPressed()));
     connect(ui_.tb_mood, SIGNAL(pressed()), this, SIGNAL(setMood()));
     connect(ui_.tb_activity, SIGNAL(pressed()), this, SIGNAL(setActivity()));
-    connect(PsiOptions::instance(), SIGNAL(optionChanged(QString)), this, SLOT(optionChanged(QString)));
+    for (const char *option :
+         { "options.ui.contactlist.avatars.radius", "options.ui.contactlist.roster-avatar-frame.avatar",
+           "options.ui.look.font.contactlist", "options.extended-presence.tune.publish" }) {
+        PsiOptions::instance()->subscribe(option, this, [this](const QStringList &changed) {
+            for (const QString &option : changed)
+                optionChanged(option);
+        });
+    }
 
     bool publishingEnabled = PsiOptions::instance()->getOption("options.extended-presence.tune.publish").toBool();
     ui_.tb_tune->setChecked(publishingEnabled);
@@ -0,0 +1,198 @@
+/*
+ * rostersearchindex.cpp - quick search index for the roster
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "rostersearchindex.h"
+
+#include <algorithm>
+
+static const int fieldWeight[] = { 100, 80, 60, 30, 20 }; // see RosterSearchIndex::Field
+
+bool RosterSearchIndex::setEntry(QObject *key, const Fields &fields)
+{
+    QVector<QPair<Field, QString>> folded;
+    folded.reserve(fields.size());
+    for (const auto &f : fields) {
+        if (!f.second.isEmpty())
+            folded.append({ f.first, f.second.toCaseFolded() });
+    }
+
+    int id = ids_.value(key, -1);
+    if (id != -1) {
+        if (entries_[id].fields == folded)
+            return false;
+        unindex(id);
+    } else if (!freeIds_.isEmpty()) {
+        id = freeIds_.takeLast();
+    } else {
+        id = entries_.size();
+        entries_.append(Entry());
+    }
+    ids_.insert(key, id);
+
+    Entry &e = entries_[id];
+    e.key    = key;
+    e.fields = folded;
+    for (const auto &f : std::as_const(e.fields)) {
+        auto g = trigrams(f.second);
+        e.grams.insert(e.grams.end(), g.begin(), g.end());
+    }
+    std::sort(e.grams.begin(), e.grams.end());
+    e.grams.erase(std::unique(e.grams.begin(), e.grams.end()), e.grams.end());
+    for (auto g : e.grams) {
+        auto &list = postings_[g];
+        list.insert(std::lower_bound(list.begin(), list.end(), id), id);
+    }
+
+    lastValid_ = false;
+    return true;
+}
+
+void RosterSearchIndex::removeEntry(QObject *key)
+{
+    auto it = ids_.find(key);
+    if (it == ids_.end())
+        return;
+    int id = it.value();
+    ids_.erase(it);
+    unindex(id);
+    entries_[id] = Entry();
+    freeIds_.append(id);
+    lastValid_ = false;
+}
+
+void RosterSearchIndex::clear()
+{
+    entries_.clear();
+    freeIds_.clear();
+    ids_.clear();
+    postings_.clear();
+    lastValid_ = false;
+}
+
+int RosterSearchIndex::count() const { return ids_.size(); }
+
+void RosterSearchIndex::unindex(int id)
+{
+    Entry &e = entries_[id];
+    for (auto g : e.grams) {
+        auto it = postings_.find(g);
+        if (it == postings_.end())
+            continue;
+        auto &list = it.value();
+        auto  pos  = std::lower_bound(list.begin(), list.end(), id);
+        if (pos != list.end() && *pos == id)
+            list.erase(pos);
+        if (list.empty())
+            postings_.erase(it);
+    }
+    e.grams.clear();
+}
+
+std::vector<quint64> RosterSearchIndex::trigrams(const QString &text)
+{
+    std::vector<quint64> ret;
+    if (text.size() < 3)
+        return ret;
+    ret.reserve(size_t(text.size() - 2));
+    const QChar *c = text.constData();
+    for (int i = 0; i + 2 < text.size(); ++i)
+        ret.push_back(quint64(c[i].unicode()) << 32 | quint64(c[i + 1].unicode()) << 16 | c[i + 2].unicode());
+    return ret;
+}
+
+int RosterSearchIndex::score(const Entry &entry, const QString &query)
+{
+    int best = 0;
+    for (const auto &f : entry.fields) {
+        int pos = f.second.indexOf(query);
+        if (pos == -1)
+            continue;
+        int s = fieldWeight[f.first];
+        if (f.second.size() == query.size())
+            s += 60;
+        else if (pos == 0)
+            s += 40;
+        else if (!f.second.at(pos - 1).isLetterOrNumber())
+            s += 20;
+        best = std::max(best, s);
+    }
+    return best;
+}
+
+QList<RosterSearchIndex::Match> RosterSearchIndex::search(const QString &query)
+{
+    QList<Match> ret;
+    QString      q = query.toCaseFolded();
+    if (q.isEmpty()) {
+        for (const auto &e : std::as_const(entries_)) {
+            if (e.key)
+                ret.append({ e.key, 0 });
+        }
+        lastValid_ = false;
+        return ret;
+    }
+
+    std::vector<int> candidates;
+    if (lastValid_ && q.contains(lastQuery_)) {
+        // narrowing search. everything matching the new query matched the previous one
+        candidates = lastMatches_;
+    } else if (q.size() >= 3) {
+        auto grams = trigrams(q);
+        std::sort(grams.begin(), grams.end());
+        grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+
+        std::vector<const std::vector<int> *> lists;
+        for (auto g : grams) {
+            auto it = postings_.constFind(g);
+            if (it == postings_.constEnd())
+                return ret; // not a single entry has this trigram
+            lists.push_back(&it.value());
+        }
+        std::sort(lists.begin(), lists.end(), [](auto a, auto b) { return a->size() < b->size(); });
+        candidates = *lists.front();
+        for (size_t i = 1; i < lists.size() && !candidates.empty(); ++i) {
+            std::vector<int> tmp;
+            std::set_intersection(candidates.begin(), candidates.end(), lists[i]->begin(), lists[i]->end(),
+                                  std::back_inserter(tmp));
+            candidates.swap(tmp);
+        }
+    } else {
+        candidates.reserve(size_t(entries_.size()));
+        for (int i = 0; i < entries_.size(); ++i) {
+            if (entries_[i].key)
+                candidates.push_back(i);
+        }
+    }
+
+    // trigrams only narrow the set down. the query still has to be found as a whole
+    std::vector<int> matches;
+    for (int id : candidates) {
+        int s = score(entries_[id], q);
+        if (s) {
+            matches.push_back(id);
+            ret.append({ entries_[id].key, s });
+        }
+    }
+    lastQuery_   = q;
+    lastMatches_ = std::move(matches);
+    lastValid_   = true;
+
+    std::stable_sort(ret.begin(), ret.end(), [](const Match &a, const Match &b) { return a.score > b.score; });
+    return ret;
+}
@@ -0,0 +1,86 @@
+/*
+ * rostersearchindex.h - quick search index for the roster
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ROSTERSEARCHINDEX_H
+#define ROSTERSEARCHINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+#include <vector>
+
+class QObject;
+
+/**
+ * Substring search over a set of entries (roster contacts) with a few text
+ * fields each.
+ *
+ * Case folded trigrams of all the fields are indexed, so a query of three or
+ * more characters only verifies entries having all its trigrams. When the
+ * query is just extended (the user types more characters) only the previous
+ * matches are checked. Entries are updated one by one as the roster changes.
+ *
+ * Matches are ranked by the field they were found in and by position: an
+ * exact match goes before a prefix match, which goes before a word start
+ * match, which goes before any other substring match.
+ */
+class RosterSearchIndex {
+public:
+    enum Field : quint8 { NameField, NickField, JidField, GroupField, VCardField };
+    using Fields = QList<QPair<Field, QString>>;
+
+    struct Match {
+        QObject *key;
+        int      score;
+    };
+
+    // returns false if nothing has changed for the entry
+    bool setEntry(QObject *key, const Fields &fields);
+    void removeEntry(QObject *key);
+    void clear();
+    int  count() const;
+
+    // best matches first. an empty query matches everything with zero score
+    QList<Match> search(const QString &query);
+
+private:
+    struct Entry {
+        QObject                       *key = nullptr;
+        QVector<QPair<Field, QString>> fields; // case folded
+        std::vector<quint64>           grams;
+    };
+
+    static std::vector<quint64> trigrams(const QString &text);
+    static int                  score(const Entry &entry, const QString &query);
+
+    void unindex(int id);
+
+    QVector<Entry>                   entries_;
+    QVector<int>                     freeIds_;
+    QHash<QObject *, int>            ids_;
+    QHash<quint64, std::vector<int>> postings_; // sorted entry ids
+    QString                          lastQuery_;
+    std::vector<int>                 lastMatches_;
+    bool                             lastValid_ = false;
+};
+
+#endif // ROSTERSEARCHINDEX_H
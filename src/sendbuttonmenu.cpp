@@ -307,7 +307,9 @@ SendButtonTemplatesMenu::SendButtonTemplatesMenu(QWidget *parent) : QMenu(parent
 {
     setSeparatorsCollapsible(true);
     update();
-    connect(PsiOptions::instance(), SIGNAL(optionChanged(const QString &)), SLOT(optionChanged(const QString &)));
+    for (const char *option : { "options.ui.chat.disable-paste-send", "options.ui.chat.css" }) {
+        PsiOptions::instance()->subscribe(option, this, [this, option](const QStringList &) { optionChanged(option); });
+    }
 }
 
 void SendButtonTemplatesMenu::setParams(bool ps)
@@ -0,0 +1,78 @@
+/*
+ * sqlitetuning.cpp - pragmas and maintenance of the SQLite databases
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "sqlitetuning.h"
+
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QVariant>
+
+namespace SqliteTuning {
+
+static bool exec(QSqlQuery &query, const QString &sql)
+{
+    if (query.exec(sql))
+        return true;
+    qWarning("SqliteTuning: \"%s\" failed: %s", qUtf8Printable(sql), qUtf8Printable(query.lastError().text()));
+    return false;
+}
+
+QString apply(QSqlDatabase &db, const Settings &settings)
+{
+    QSqlQuery query(db);
+    QString   mode;
+    if (exec(query, QString("PRAGMA journal_mode = %1;").arg(settings.wal ? "WAL" : "DELETE")) && query.next())
+        mode = query.value(0).toString().toLower();
+
+    // in WAL mode NORMAL is still safe against corruption, the last commits may be lost on power failure only
+    exec(query, QString("PRAGMA synchronous = %1;").arg(mode == QLatin1String("wal") ? "NORMAL" : "FULL"));
+    exec(query, QString("PRAGMA mmap_size = %1;").arg(qint64(qMax(0, settings.mmapSize)) * 1024 * 1024));
+    exec(query, QString("PRAGMA cache_size = -%1;").arg(qMax(64, settings.cacheSize))); // negative is KiB
+    exec(query, "PRAGMA temp_store = MEMORY;");
+    return mode;
+}
+
+void enableIncrementalVacuum(QSqlDatabase &db)
+{
+    QSqlQuery query(db);
+    exec(query, "PRAGMA auto_vacuum = INCREMENTAL;");
+}
+
+void maintain(QSqlDatabase &db, int maxPages)
+{
+    QSqlQuery query(db);
+    exec(query, "PRAGMA optimize;");
+
+    int pages = 0;
+    if (exec(query, "PRAGMA auto_vacuum;") && query.next() && query.value(0).toInt() == 2 // incremental
+        && exec(query, "PRAGMA freelist_count;") && query.next())
+        pages = qMin(query.value(0).toInt(), maxPages);
+    query.finish();
+    if (pages > 0 && db.transaction()) {
+        // the pragma frees one page per step, but the driver steps a statement without columns only once
+        query.prepare("PRAGMA incremental_vacuum(1);");
+        for (int i = 0; i < pages && query.exec(); ++i) { }
+        query.finish();
+        db.commit();
+    }
+    exec(query, "PRAGMA wal_checkpoint(PASSIVE);");
+}
+
+} // namespace SqliteTuning
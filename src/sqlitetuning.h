@@ -0,0 +1,47 @@
+/*
+ * sqlitetuning.h - pragmas and maintenance of the SQLite databases
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SQLITETUNING_H
+#define SQLITETUNING_H
+
+#include <QString>
+
+class QSqlDatabase;
+
+namespace SqliteTuning {
+
+struct Settings {
+    bool wal       = true; // write-ahead log with synchronous=NORMAL. otherwise rollback journal with full sync
+    int  mmapSize  = 64;   // MiB, 0 - no memory mapped I/O
+    int  cacheSize = 8192; // KiB
+};
+
+// has to be called right after the database is opened. returns the journal mode actually set
+QString apply(QSqlDatabase &db, const Settings &settings);
+
+// switches a new database to incremental vacuum. has to go before apply() and before any table is created
+void enableIncrementalVacuum(QSqlDatabase &db);
+
+// cheap enough to run periodically: updates statistics, returns up to maxPages free pages
+// to the file system and checkpoints the write-ahead log
+void maintain(QSqlDatabase &db, int maxPages = 1000);
+
+} // namespace SqliteTuning
+
+#endif // SQLITETUNING_H
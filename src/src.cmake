@@ -109,6 +109,7 @@ list(APPEND HEADERS
     chatsplitter.h
     chatview.h
     chatviewcommon.h
+    clienticonmatcher.h
     coloropt.h
     common.h
     conferencebookmark.h
@@ -135,13 +136,16 @@ list(APPEND HEADERS
     edbsqlite.h
     eventdb.h
     eventdlg.h
+    eventloopwatchdog.h
     filecache.h
+    filehasher.h
     filesharedlg.h
     filesharingdownloader.h
     filesharingitem.h
     filesharingmanager.h
     filesharingproxy.h
     filetransdlg.h
+    filetransferio.h
     fileutil.h
     gcuserview.h
     geolocation.h
@@ -153,8 +157,10 @@ list(APPEND HEADERS
     groupchatdlg.h
     groupchattopicdlg.h
     groupmenu.h
+    highlightmatcher.h
     historycontactlistmodel.h
     historydlg.h
+    historyexporter.h
     historyimp.h
     hoverabletreeview.h
     htmltextcontroller.h
@@ -179,8 +185,11 @@ list(APPEND HEADERS
     mucaffiliationsmodel.h
     mucaffiliationsproxymodel.h
     mucaffiliationsview.h
+    mucautojoiner.h
     mucconfigdlg.h
+    muchighlighter.h
     mucjoindlg.h
+    muclastseen.h
     mucmanager.h
     mucreasonseditor.h
     multifiletransferdelegate.h
@@ -191,6 +200,7 @@ list(APPEND HEADERS
     passdialog.h
     pepmanager.h
     pgpkeydlg.h
+    pgpkeyservice.h
     pgputil.h
     pixmaputil.h
     pluginhost.h
@@ -233,12 +243,15 @@ list(APPEND HEADERS
     resourcemenu.h
     rosteravatarframe.h
     rosteritemexchangetask.h
+    rostersearchindex.h
     rtparse.h
     searchdlg.h
     sendbuttonmenu.h
     serverlistquerier.h
     shortcutmanager.h
     showtextdlg.h
+    sqlitetuning.h
+    stanzareplay.h
     statuscombobox.h
     statusdlg.h
     statusmenu.h
@@ -250,6 +263,8 @@ list(APPEND HEADERS
     textutil.h
     theme.h
     theme_p.h
+    thumbnailservice.h
+    tracer.h
     translationmanager.h
     urlbookmark.h
     userlist.h
@@ -258,8 +273,10 @@ list(APPEND HEADERS
     vcardphotodlg.h
     voicecalldlg.h
     voicecaller.h
+    webassetcache.h
     xdata_widget.h
     xmlconsole.h
+    xmlring.h
     )
 
 if(UNIX OR IS_WEBENGINE)
@@ -357,6 +374,7 @@ list(APPEND SOURCES
     chateditproxy.cpp
     chatsplitter.cpp
     chatviewcommon.cpp
+    clienticonmatcher.cpp
     coloropt.cpp
     common.cpp
     conferencebookmark.cpp
@@ -380,13 +398,16 @@ list(APPEND SOURCES
     edbsqlite.cpp
     eventdb.cpp
     eventdlg.cpp
+    eventloopwatchdog.cpp
     filecache.cpp
+    filehasher.cpp
     filesharedlg.cpp
     filesharingdownloader.cpp
     filesharingitem.cpp
     filesharingmanager.cpp
     filesharingproxy.cpp
     filetransdlg.cpp
+    filetransferio.cpp
     fileutil.cpp
     gcuserview.cpp
     geolocation.cpp
@@ -398,8 +419,10 @@ list(APPEND SOURCES
     groupchatdlg.cpp
     groupchattopicdlg.cpp
     groupmenu.cpp
+    highlightmatcher.cpp
     historycontactlistmodel.cpp
     historydlg.cpp
+    historyexporter.cpp
     historyimp.cpp
     hoverabletreeview.cpp
     htmltextcontroller.cpp
@@ -424,8 +447,11 @@ list(APPEND SOURCES
     mucaffiliationsmodel.cpp
     mucaffiliationsproxymodel.cpp
     mucaffiliationsview.cpp
+    mucautojoiner.cpp
     mucconfigdlg.cpp
+    muchighlighter.cpp
     mucjoindlg.cpp
+    muclastseen.cpp
     mucmanager.cpp
     mucreasonseditor.cpp
     multifiletransferdelegate.cpp
@@ -436,6 +462,7 @@ list(APPEND SOURCES
     passdialog.cpp
     pepmanager.cpp
     pgpkeydlg.cpp
+    pgpkeyservice.cpp
     pgputil.cpp
     pixmaputil.cpp
     pluginhost.cpp
@@ -473,12 +500,15 @@ list(APPEND SOURCES
     resourcemenu.cpp
     rosteravatarframe.cpp
     rosteritemexchangetask.cpp
+    rostersearchindex.cpp
     rtparse.cpp
     searchdlg.cpp
     sendbuttonmenu.cpp
     serverlistquerier.cpp
     shortcutmanager.cpp
     showtextdlg.cpp
+    sqlitetuning.cpp
+    stanzareplay.cpp
     statuscombobox.cpp
     statusdlg.cpp
     statusmenu.cpp
@@ -489,6 +519,8 @@ list(APPEND SOURCES
     textutil.cpp
     theme.cpp
     theme_p.cpp
+    thumbnailservice.cpp
+    tracer.cpp
     translationmanager.cpp
     urlbookmark.cpp
     userlist.cpp
@@ -496,8 +528,10 @@ list(APPEND SOURCES
     vcardfactory.cpp
     vcardphotodlg.cpp
     voicecalldlg.cpp
+    webassetcache.cpp
     xdata_widget.cpp
     xmlconsole.cpp
+    xmlring.cpp
     )
 
 include(${PROJECT_SOURCE_DIR}/3rdparty/qite/libqite/libqite.cmake)
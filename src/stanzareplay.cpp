@@ -0,0 +1,360 @@
+/*
+ * stanzareplay.cpp - offline replay of incoming stanzas
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "stanzareplay.h"
+
+#include "xmlring.h"
+
+#include <QDomDocument>
+#include <QFile>
+#include <QJsonDocument>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <limits>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+namespace {
+
+// one slice of stanzas at most, so timers and painting get their share like with a real connection
+const qint64 sliceMsecs = 50;
+
+// the room of the "muc" scenario and our nick in it
+const QString syntheticRoom = QStringLiteral("room@conference.replay.example");
+const QString syntheticNick = QStringLiteral("replay");
+
+bool isStanza(const QDomElement &e)
+{
+    return e.tagName() == QLatin1String("message") || e.tagName() == QLatin1String("presence")
+        || e.tagName() == QLatin1String("iq");
+}
+
+QDomElement appendChild(QDomDocument &doc, QDomElement &parent, const QString &ns, const QString &name,
+                        const QString &text)
+{
+    auto e = doc.createElementNS(ns, name);
+    if (!text.isEmpty())
+        e.appendChild(doc.createTextNode(text));
+    parent.appendChild(e);
+    return e;
+}
+
+// room/nick of every self-presence (status 110) in a capture, so the rooms can be joined before the replay
+QStringList selfPresences(const QList<StanzaReplay::Item> &items)
+{
+    static const QString mucUser = QStringLiteral("http://jabber.org/protocol/muc#user");
+
+    QStringList ret;
+    for (const auto &item : items) {
+        if (item.stanza.tagName() != QLatin1String("presence")
+            || item.stanza.attribute("type") == QLatin1String("unavailable"))
+            continue;
+        for (auto x = item.stanza.firstChildElement("x"); !x.isNull(); x = x.nextSiblingElement("x")) {
+            if (x.namespaceURI() != mucUser)
+                continue;
+            for (auto st = x.firstChildElement("status"); !st.isNull(); st = st.nextSiblingElement("status")) {
+                if (st.attribute("code") == QLatin1String("110") && !ret.contains(item.stanza.attribute("from")))
+                    ret << item.stanza.attribute("from");
+            }
+        }
+    }
+    return ret;
+}
+
+QJsonObject toJson(const QHash<QString, Tracer::SpanStats> &stats)
+{
+    QJsonObject ret;
+    for (auto it = stats.cbegin(); it != stats.cend(); ++it) {
+        ret.insert(it.key(),
+                   QJsonObject { { "count", it->count },
+                                 { "totalMsecs", double(it->total) / 1e6 },
+                                 { "maxMsecs", double(it->max) / 1e6 } });
+    }
+    return ret;
+}
+
+} // namespace
+
+StanzaReplay::StanzaReplay(const Sink &sink, QObject *parent) : QObject(parent), sink_(sink)
+{
+    timer_.setSingleShot(true);
+    connect(&timer_, &QTimer::timeout, this, &StanzaReplay::next);
+}
+
+StanzaReplay::~StanzaReplay()
+{
+    if (ownTrace_)
+        Tracer::stop();
+}
+
+bool StanzaReplay::load(const QString &source, const QString &self)
+{
+    source_ = source;
+    joins_.clear();
+    if (source.startsWith(QLatin1String("synthetic:"))) {
+        const auto parts = source.split(':');
+        int        count = parts.value(2, "1000").toInt();
+        items_           = synthetic(parts.value(1), count, self);
+        if (parts.value(1) == QLatin1String("muc"))
+            joins_ << syntheticRoom + '/' + syntheticNick;
+    } else {
+        items_ = readCapture(source);
+        if (items_.isEmpty())
+            items_ = readXml(source);
+        joins_ = selfPresences(items_);
+    }
+    if (items_.isEmpty()) {
+        qWarning("replay: no stanzas in %s", qPrintable(source));
+        return false;
+    }
+    return true;
+}
+
+void StanzaReplay::setItems(const QList<Item> &items) { items_ = items; }
+
+int StanzaReplay::count() const { return items_.size(); }
+
+void StanzaReplay::setSpeed(double speed) { speed_ = std::max(0.0, speed); }
+
+void StanzaReplay::setTraceFile(const QString &fileName) { traceFile_ = fileName; }
+
+void StanzaReplay::setSettleTime(int msecs) { settleMsecs_ = msecs; }
+
+void StanzaReplay::setJoinHandler(const JoinHandler &join) { join_ = join; }
+
+QStringList StanzaReplay::joins() const { return joins_; }
+
+void StanzaReplay::start()
+{
+    pos_       = 0;
+    finished_  = false;
+    rssBefore_ = residentMemory();
+    kinds_.clear();
+    stages_.clear();
+    if (!Tracer::isEnabled() && !traceFile_.isEmpty()) {
+        Tracer::start(traceFile_);
+        ownTrace_ = true;
+    }
+    qDebug("replay: %d stanzas at speed %g", int(items_.size()), speed_);
+    if (join_) {
+        for (const QString &room : std::as_const(joins_))
+            join_(room);
+    }
+    clock_.start();
+    next();
+}
+
+bool StanzaReplay::isFinished() const { return finished_; }
+
+void StanzaReplay::next()
+{
+    const qint64 now = speed_ > 0 ? qint64(double(clock_.elapsed()) * speed_) : std::numeric_limits<qint64>::max();
+
+    QElapsedTimer slice;
+    slice.start();
+    while (pos_ < items_.size() && items_[pos_].msecs <= now && slice.elapsed() < sliceMsecs) {
+        const auto &stanza = items_[pos_++].stanza;
+        const auto  begin  = Tracer::now();
+        {
+            TRACE_SPAN("StanzaReplay::inject");
+            sink_(stanza);
+        }
+        const auto elapsed = Tracer::now() - begin;
+        auto      &s       = kinds_[stanza.tagName()];
+        ++s.count;
+        s.total += elapsed;
+        s.max = std::max(s.max, elapsed);
+    }
+
+    if (pos_ < items_.size()) {
+        const qint64 wait = speed_ > 0 ? qint64(double(items_[pos_].msecs - now) / speed_) : 0;
+        timer_.start(int(qBound(qint64(0), wait, qint64(std::numeric_limits<int>::max()))));
+        return;
+    }
+    injectMsecs_ = clock_.elapsed();
+    QTimer::singleShot(settleMsecs_, this, &StanzaReplay::finish);
+}
+
+void StanzaReplay::finish()
+{
+    rssAfter_ = residentMemory();
+    stages_   = Tracer::summary();
+    if (ownTrace_) {
+        Tracer::stop();
+        ownTrace_ = false;
+    }
+    finished_ = true;
+    qDebug("replay: %d stanzas in %lld ms", int(items_.size()), injectMsecs_);
+    emit finished();
+}
+
+QJsonObject StanzaReplay::report() const
+{
+    QJsonObject ret { { "source", source_ },
+                      { "speed", speed_ },
+                      { "stanzas", int(items_.size()) },
+                      { "injectMsecs", injectMsecs_ },
+                      { "kinds", toJson(kinds_) },
+                      { "stages", toJson(stages_) } };
+    if (injectMsecs_ > 0)
+        ret.insert("stanzasPerSecond", double(items_.size()) * 1000 / double(injectMsecs_));
+    if (rssBefore_ >= 0)
+        ret.insert("rssBeforeKiB", rssBefore_);
+    if (rssAfter_ >= 0)
+        ret.insert("rssAfterKiB", rssAfter_);
+    return ret;
+}
+
+bool StanzaReplay::writeReport(const QString &fileName) const
+{
+    QSaveFile f(fileName);
+    if (!f.open(QIODevice::WriteOnly)) {
+        qWarning("replay: failed to write %s: %s", qPrintable(fileName), qPrintable(f.errorString()));
+        return false;
+    }
+    f.write(QJsonDocument(report()).toJson());
+    return f.commit();
+}
+
+QList<StanzaReplay::Item> StanzaReplay::readCapture(const QString &fileName)
+{
+    QList<Item> ret;
+    QDateTime   first;
+    const auto  records = XmlRing::readCapture(fileName);
+    for (const auto &r : records) {
+        if (r.type != XmlRing::In)
+            continue;
+        QDomDocument doc;
+        if (!doc.setContent(r.xml, true))
+            continue;
+        const auto e = doc.documentElement();
+        if (!isStanza(e))
+            continue; // stream features, sasl and such
+        if (!first.isValid())
+            first = r.time;
+        ret.append({ first.msecsTo(r.time), e });
+    }
+    return ret;
+}
+
+QList<StanzaReplay::Item> StanzaReplay::readXml(const QString &fileName)
+{
+    QList<Item>  ret;
+    QFile        f(fileName);
+    QDomDocument doc;
+    if (!f.open(QIODevice::ReadOnly) || !doc.setContent(&f, true))
+        return ret;
+
+    qint64 msecs = 0;
+    for (auto e = doc.documentElement().firstChildElement(); !e.isNull(); e = e.nextSiblingElement()) {
+        if (e.hasAttribute("replay-ms")) {
+            msecs = e.attribute("replay-ms").toLongLong();
+            e.removeAttribute("replay-ms");
+        }
+        if (isStanza(e))
+            ret.append({ msecs, e });
+    }
+    return ret;
+}
+
+QList<StanzaReplay::Item> StanzaReplay::synthetic(const QString &scenario, int count, const QString &self)
+{
+    static const QString ns      = QStringLiteral("jabber:client");
+    static const char   *shows[] = { nullptr, "away", "chat", "dnd", "xa" };
+
+    QList<Item>  ret;
+    QDomDocument doc;
+    if (scenario == QLatin1String("presence")) {
+        // a fresh profile has no roster, and presences of unknown contacts are dropped early.
+        // the same roster push a server would send, 100 contacts at a time
+        for (int first = 0; first < count; first += 100) {
+            auto iq = doc.createElementNS(ns, "iq");
+            iq.setAttribute("type", "set");
+            iq.setAttribute("id", QString("push%1").arg(first));
+            iq.setAttribute("to", self);
+            auto query = appendChild(doc, iq, "jabber:iq:roster", "query", QString());
+            for (int i = first; i < qMin(first + 100, count); ++i) {
+                auto item = appendChild(doc, query, query.namespaceURI(), "item", QString());
+                item.setAttribute("jid", QString("contact%1@replay.example").arg(i));
+                item.setAttribute("name", QString("Contact %1").arg(i, 4, 10, QChar('0')));
+                item.setAttribute("subscription", "both");
+                appendChild(doc, item, query.namespaceURI(), "group", QString("Group %1").arg(i % 20));
+            }
+            ret.append({ 0, iq });
+        }
+    }
+    for (int i = 0; i < count; ++i) {
+        QDomElement e;
+        qint64      msecs;
+        if (scenario == QLatin1String("presence")) {
+            e = doc.createElementNS(ns, "presence");
+            e.setAttribute("from", QString("contact%1@replay.example/psi").arg(i));
+            if (auto show = shows[i % 5])
+                appendChild(doc, e, ns, "show", show);
+            appendChild(doc, e, ns, "status", QString("Status message %1").arg(i));
+            appendChild(doc, e, ns, "priority", "5");
+            auto c = appendChild(doc, e, "http://jabber.org/protocol/caps", "c", QString());
+            c.setAttribute("hash", "sha-1");
+            c.setAttribute("node", "https://psi-im.org");
+            c.setAttribute("ver", QString("replay%1=").arg(i % 7)); // a few clients share caps
+            msecs = i * 2;
+        } else if (scenario == QLatin1String("muc")) {
+            // the self-presence first. it completes the join, presences before it would be dropped
+            e = doc.createElementNS(ns, "presence");
+            e.setAttribute("from", syntheticRoom + '/' + (i ? QString("nick%1").arg(i) : syntheticNick));
+            auto x    = appendChild(doc, e, "http://jabber.org/protocol/muc#user", "x", QString());
+            auto item = appendChild(doc, x, x.namespaceURI(), "item", QString());
+            item.setAttribute("affiliation", i % 50 ? "none" : "member");
+            item.setAttribute("role", i ? "participant" : "moderator");
+            if (!i)
+                appendChild(doc, x, x.namespaceURI(), "status", QString()).setAttribute("code", "110");
+            msecs = i;
+        } else if (scenario == QLatin1String("chat")) {
+            e = doc.createElementNS(ns, "message");
+            e.setAttribute("from", "friend@replay.example/psi");
+            e.setAttribute("type", "chat");
+            e.setAttribute("id", QString("replay%1").arg(i));
+            appendChild(doc, e, ns, "body",
+                        QString("Message %1 with a link https://psi-im.org/ and a smiley :-)").arg(i));
+            msecs = i * 10;
+        } else {
+            qWarning("replay: unknown scenario %s", qPrintable(scenario));
+            break;
+        }
+        e.setAttribute("to", self);
+        ret.append({ msecs, e });
+    }
+    return ret;
+}
+
+qint64 StanzaReplay::residentMemory()
+{
+#ifdef Q_OS_LINUX
+    QFile f(QStringLiteral("/proc/self/statm"));
+    if (f.open(QIODevice::ReadOnly)) {
+        const auto fields = f.readAll().split(' ');
+        if (fields.size() > 1)
+            return fields[1].toLongLong() * sysconf(_SC_PAGESIZE) / 1024;
+    }
+#endif
+    return -1;
+}
@@ -0,0 +1,126 @@
+/*
+ * stanzareplay.h - offline replay of incoming stanzas
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STANZAREPLAY_H
+#define STANZAREPLAY_H
+
+#include "tracer.h"
+
+#include <QDomElement>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+
+#include <functional>
+
+/**
+ * Feeds a recorded or generated stream of incoming stanzas to a sink
+ * (normally PsiAccount::injectIncomingStanza()), so the cost of handling
+ * them can be measured and compared between builds without a server.
+ *
+ * A source is one of:
+ *  - an XmlRing capture file. Its incoming records are replayed with their
+ *    original timing
+ *  - an xml file with stanzas as children of the root element. An optional
+ *    "replay-ms" attribute gives the offset of a stanza from the start
+ *  - "synthetic:<scenario>[:<count>]" with the scenarios "presence" (a
+ *    roster coming online), "muc" (a crowded room being joined) and "chat"
+ *    (a burst of messages from one contact). "presence" pushes its contacts
+ *    to the roster first and the room of "muc" answers with the self-presence
+ *
+ * Rooms are joined through the join handler before the first stanza: the
+ * room of "muc" and every room of a file with our self-presence (status 110)
+ * in it. Stanzas of rooms which are not joined are dropped by the account.
+ *
+ * Delays are divided by the speed. With zero speed everything is sent as
+ * fast as the event loop allows. Unless the tracer is already running it's
+ * started for the replay, and the report holds the timings of every trace
+ * span (the processing stages), of each kind of stanza and the resident
+ * memory before and after.
+ */
+class StanzaReplay : public QObject {
+    Q_OBJECT
+public:
+    using Sink        = std::function<void(const QDomElement &stanza)>;
+    using JoinHandler = std::function<void(const QString &roomWithNick)>;
+
+    struct Item {
+        qint64      msecs; // since the start of the replay
+        QDomElement stanza;
+    };
+
+    explicit StanzaReplay(const Sink &sink, QObject *parent = nullptr);
+    ~StanzaReplay();
+
+    bool load(const QString &source, const QString &self); // self is the recipient of synthetic stanzas
+    void setItems(const QList<Item> &items);
+    int  count() const;
+
+    void setSpeed(double speed);
+    void setTraceFile(const QString &fileName); // written when the replay started the tracer
+    void setSettleTime(int msecs);              // for timers and queued work after the last stanza
+    void setJoinHandler(const JoinHandler &join);
+
+    QStringList joins() const; // rooms joined on start() before the first stanza
+
+    void start();
+    bool isFinished() const;
+
+    QJsonObject report() const;
+    bool        writeReport(const QString &fileName) const;
+
+    static QList<Item> readCapture(const QString &fileName);
+    static QList<Item> readXml(const QString &fileName);
+    static QList<Item> synthetic(const QString &scenario, int count, const QString &self);
+
+    static qint64 residentMemory(); // KiB or -1 if unknown
+
+signals:
+    void finished();
+
+private slots:
+    void next();
+    void finish();
+
+private:
+    Sink                              sink_;
+    JoinHandler                       join_;
+    QStringList                       joins_;
+    QString                           source_;
+    QList<Item>                       items_;
+    int                               pos_   = 0;
+    double                            speed_ = 1.0;
+    QString                           traceFile_;
+    int                               settleMsecs_ = 1000;
+    bool                              ownTrace_    = false;
+    bool                              finished_    = false;
+    QTimer                            timer_;
+    QElapsedTimer                     clock_;
+    qint64                            injectMsecs_ = 0;
+    qint64                            rssBefore_   = -1;
+    qint64                            rssAfter_    = -1;
+    QHash<QString, Tracer::SpanStats> kinds_;
+    QHash<QString, Tracer::SpanStats> stages_;
+};
+
+#endif // STANZAREPLAY_H
@@ -50,11 +50,28 @@ TabbableWidget::TabbableWidget(const Jid &jid, PsiAccount *pa, TabManager *tabMa
         // the idea is to not call activated/deactivated virtual methods immediatelly
         // what makes trackbar working better in some cases
         if (state_ == ActivationState::Activated) {
+            hibernateTimer_.stop();
+            if (hibernated_) {
+                hibernated_ = false;
+                wakeUp();
+            }
             activated();
         } else {
+            int minutes = PsiOptions::instance()->getOption("options.ui.tabs.hibernate-after").toInt();
+            if (minutes > 0 && !hibernated_) {
+                hibernateTimer_.start(minutes * 60 * 1000);
+            }
             deactivated();
         }
     });
+
+    hibernateTimer_.setSingleShot(true);
+    connect(&hibernateTimer_, &QTimer::timeout, this, [this]() {
+        // a tab of an inactive but visible window is still looked at
+        if (state_ == ActivationState::Deactivated && (!isVisible() || window()->isMinimized())) {
+            hibernated_ = hibernate();
+        }
+    });
     // QTimer::singleShot(0, this, SLOT(ensureTabbedCorrectly()));
 }
 
@@ -177,6 +194,12 @@ void TabbableWidget::deactivated() { }
 
 void TabbableWidget::activated() { }
 
+bool TabbableWidget::hibernate() { return false; }
+
+void TabbableWidget::wakeUp() { }
+
+bool TabbableWidget::isHibernated() const { return hibernated_; }
+
 /**
  * Returns true if this tab is active in the active window.
  */
@@ -227,6 +250,16 @@ void TabbableWidget::changeEvent(QEvent *event)
     }
 }
 
+bool TabbableWidget::event(QEvent *e)
+{
+    // the tab may be shown without being activated (e.g. in an inactive window)
+    if (e->type() == QEvent::Show && hibernated_) {
+        hibernated_ = false;
+        wakeUp();
+    }
+    return AdvancedWidget<QWidget>::event(e);
+}
+
 /**
  * Set the icon of the tab.
  */
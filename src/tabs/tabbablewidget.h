@@ -56,6 +56,7 @@ public:
     bool isTabbed();
     bool isActiveTab();
     bool isGroupChat();
+    bool isHibernated() const;
 
     // reimplemented
     virtual void doFlash(bool on);
@@ -89,14 +90,21 @@ protected:
     virtual void setJid(const Jid &);
     virtual void deactivated();
     virtual void activated();
+    // frees what can be restored later (e.g. the chat view) when the tab is hidden for a long time.
+    // returns false if there is nothing to free
+    virtual bool hibernate();
+    virtual void wakeUp();
 
     // reimplemented
     void changeEvent(QEvent *e);
+    bool event(QEvent *e);
 
 private:
     enum class ActivationState : char { Activated, Deactivated };
     ActivationState state_;
     QTimer          stateCommitTimer_;
+    QTimer          hibernateTimer_;
+    bool            hibernated_ = false;
 
     Jid         jid_;
     PsiAccount *pa_;
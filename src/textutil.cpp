@@ -5,6 +5,7 @@
 #include "psiiconset.h"
 #include "psioptions.h"
 #include "rtparse.h"
+#include "tracer.h"
 
 #include <QTextDocument> // for escape()
 
@@ -549,6 +550,7 @@ QString TextUtil::linkify(const QString &in)
 // sickening
 QString TextUtil::emoticonify(const QString &in)
 {
+    TRACE_SPAN("TextUtil::emoticonify");
     RTParse p(in);
     while (!p.atEnd()) {
         // returns us the first chunk as a plaintext string
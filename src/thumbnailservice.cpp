@@ -0,0 +1,146 @@
+/*
+ * thumbnailservice.cpp - background thumbnails and previews of local images
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "thumbnailservice.h"
+
+#include "filecache.h"
+
+#include <QBuffer>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QPainter>
+#include <QThread>
+#include <QtConcurrent>
+
+static const int          memoryCacheSize = 32 * 1024; // KiB
+static const unsigned int diskMaxAge      = 30 * 24 * 3600;
+
+ThumbnailService::ThumbnailService(const QString &cacheDir, QObject *parent) :
+    QObject(parent), memoryCache_(memoryCacheSize)
+{
+    QDir().mkpath(cacheDir);
+    diskCache_ = new FileCache(cacheDir, this);
+    pool_.setMaxThreadCount(qBound(1, QThread::idealThreadCount() - 1, 4));
+}
+
+ThumbnailService::~ThumbnailService()
+{
+    pool_.clear();
+    pool_.waitForDone();
+}
+
+QString ThumbnailService::key(const QString &fileName, const XMPP::Hash &contentId, const QSize &maxSize) const
+{
+    QString id;
+    if (contentId.isValid()) {
+        id = contentId.toString();
+    } else {
+        QFileInfo fi(fileName);
+        id = QString("%1:%2:%3")
+                 .arg(fi.absoluteFilePath(), QString::number(fi.size()),
+                      QString::number(fi.lastModified().toMSecsSinceEpoch()));
+    }
+    return QString("%1@%2x%3").arg(id, QString::number(maxSize.width()), QString::number(maxSize.height()));
+}
+
+QImage ThumbnailService::image(const QString &fileName, const XMPP::Hash &contentId, const QSize &maxSize,
+                               bool *pending)
+{
+    if (pending)
+        *pending = false;
+
+    auto k = key(fileName, contentId, maxSize);
+    if (auto img = memoryCache_.object(k))
+        return *img;
+    if (failed_.contains(k))
+        return QImage();
+
+    if (pending)
+        *pending = true;
+    if (running_.contains(k))
+        return QImage();
+    running_.insert(k);
+
+    XMPP::Hash diskId;
+    QByteArray cached;
+    if (contentId.isValid()) {
+        diskId = XMPP::Hash::from(XMPP::Hash::Sha1, k.toUtf8());
+        cached = diskCache_->getData(diskId, true);
+    }
+
+    QtConcurrent::run(&pool_, [this, k, fileName, diskId, maxSize, cached]() {
+        QImage     img;
+        QByteArray png;
+        if (cached.size())
+            img.loadFromData(cached, "PNG");
+        if (img.isNull()) {
+            img = load(fileName, maxSize);
+            if (!img.isNull() && diskId.isValid()) {
+                QBuffer buffer(&png);
+                buffer.open(QIODevice::WriteOnly);
+                img.save(&buffer, "PNG");
+            }
+        }
+        QMetaObject::invokeMethod(
+            this, [=]() { finish(k, fileName, diskId, maxSize, img, png); }, Qt::QueuedConnection);
+    });
+    return QImage();
+}
+
+void ThumbnailService::finish(const QString &key, const QString &fileName, const XMPP::Hash &diskId,
+                              const QSize &maxSize, const QImage &image, const QByteArray &png)
+{
+    running_.remove(key);
+    if (image.isNull()) {
+        failed_.insert(key);
+    } else {
+        memoryCache_.insert(key, new QImage(image), qMax(1, int(image.sizeInBytes() / 1024)));
+        if (png.size())
+            diskCache_->append(diskId, png, QVariantMap { { QLatin1String("type"), QLatin1String("image/png") } },
+                               diskMaxAge);
+    }
+    emit ready(fileName, maxSize, image);
+}
+
+QImage ThumbnailService::load(const QString &fileName, const QSize &maxSize)
+{
+    QImageReader reader(fileName);
+    auto         size = reader.size();
+    if (size.isValid() && (size.width() > maxSize.width() || size.height() > maxSize.height()))
+        reader.setScaledSize(size.scaled(maxSize, Qt::KeepAspectRatio));
+
+    QImage img = reader.read();
+    // not every image format plugin is able to scale while reading
+    if (img.width() > maxSize.width() || img.height() > maxSize.height())
+        img = img.scaled(maxSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    return img;
+}
+
+QImage ThumbnailService::framed(const QImage &image, const QSize &size)
+{
+    QImage back(size, QImage::Format_ARGB32_Premultiplied);
+    back.fill(Qt::transparent);
+    QPainter painter(&back);
+    auto     imgRect = image.rect();
+    imgRect.moveCenter(back.rect().center());
+    painter.drawImage(imgRect, image);
+    return back;
+}
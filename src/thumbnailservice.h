@@ -0,0 +1,78 @@
+/*
+ * thumbnailservice.h - background thumbnails and previews of local images
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef THUMBNAILSERVICE_H
+#define THUMBNAILSERVICE_H
+
+#include "iris/xmpp_hash.h"
+
+#include <QCache>
+#include <QImage>
+#include <QObject>
+#include <QSet>
+#include <QThreadPool>
+
+class FileCache;
+
+/**
+ * Makes scaled down copies of images in a thread pool.
+ *
+ * Images are decoded right at the requested size when the format supports it
+ * (e.g. JPEG), so a big photo is never fully decoded just to get an icon.
+ * Results are kept in memory and, if the content hash of the file is known,
+ * in a FileCache on disk, so the same thumbnail is never made twice.
+ */
+class ThumbnailService : public QObject {
+    Q_OBJECT
+public:
+    ThumbnailService(const QString &cacheDir, QObject *parent = nullptr);
+    ~ThumbnailService();
+
+    /**
+     * @brief image returns a copy of the image scaled to fit into maxSize (never scaled up)
+     * @param fileName - local image file
+     * @param contentId - hash of the file content. if valid, the result is cached on disk too
+     * @param maxSize - bounding size
+     * @param pending - set to true if the image is not ready yet and ready() will be emitted later
+     * @return the image or a null image if it's not ready yet or the file is not an image
+     */
+    QImage image(const QString &fileName, const XMPP::Hash &contentId, const QSize &maxSize, bool *pending = nullptr);
+
+    // synchronous version of image() without any caching. safe to call from any thread
+    static QImage load(const QString &fileName, const QSize &maxSize);
+    // centers the image in a transparent square of the given size
+    static QImage framed(const QImage &image, const QSize &size);
+
+signals:
+    // image is null if the file could not be decoded
+    void ready(const QString &fileName, const QSize &maxSize, const QImage &image);
+
+private:
+    QString key(const QString &fileName, const XMPP::Hash &contentId, const QSize &maxSize) const;
+    void    finish(const QString &key, const QString &fileName, const XMPP::Hash &diskId, const QSize &maxSize,
+                   const QImage &image, const QByteArray &png);
+
+    FileCache              *diskCache_;
+    QCache<QString, QImage> memoryCache_;
+    QSet<QString>           running_;
+    QSet<QString>           failed_;
+    QThreadPool             pool_;
+};
+
+#endif // THUMBNAILSERVICE_H
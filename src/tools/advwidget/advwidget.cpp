@@ -261,7 +261,8 @@ void GAdvancedWidget::Private::updateGeometry()
 
 void GAdvancedWidget::Private::saveGeometry()
 {
-    bool isMaximized = bool(parentWidget_->windowState() & Qt::WindowMaximized);
+    bool               isMaximized = bool(parentWidget_->windowState() & Qt::WindowMaximized);
+    OptionsTree::Batch batch(PsiOptions::instance());
     // if window is maximized normalGeometry() returns null rect. So in this case we use cached geometry
     PsiOptions::instance()->setOption(geometryOptionPath_,
                                       isMaximized ? normalGeometry_ : parentWidget_->normalGeometry());
@@ -35,6 +35,7 @@
 #include "svgiconengine.h"
 
 #include <QApplication>
+#include <QAtomicInt>
 #include <QBuffer>
 #include <QCoreApplication>
 #include <QDomDocument>
@@ -51,6 +52,7 @@
 #include <QSvgRenderer>
 #include <QThread>
 #include <QTimer>
+#include <QVector>
 #ifdef ICONSET_SOUND
 #include <QDataStream>
 #include <qca_basic.h>
@@ -716,6 +718,8 @@ bool PsiIcon::loadFromData(const QString &mime, const QByteArray &ba, bool isAni
         if (!d->svgRenderer->isValid()) {
             d->svgRenderer.reset();
             d->svgRenderer = nullptr;
+        } else {
+            moveToMainThread(d->svgRenderer.get());
         }
     }
     if (d->svgRenderer) {
@@ -827,20 +831,43 @@ class IconsetFactoryPrivate : public QObject {
 private:
     IconsetFactoryPrivate() : QObject(QCoreApplication::instance()), emptyPixmap_(nullptr) { }
 
-    ~IconsetFactoryPrivate()
-    {
-        iconsets_.clear();
-
-        if (emptyPixmap_) {
-            delete emptyPixmap_;
-            emptyPixmap_ = nullptr;
-        }
-    }
+    ~IconsetFactoryPrivate();
 
     static IconsetFactoryPrivate *instance_;
     QList<Iconset>                iconsets_;
     mutable QPixmap              *emptyPixmap_;
 
+    // Merged index of all the registered iconsets. The first registered iconset having
+    // an icon wins, the same way as the linear search over iconsets_ used to work.
+    // Names are interned globally, so ids survive factory resets.
+    static QHash<QString, int>       nameIds_;
+    static QStringList               names_;
+    mutable QVector<const PsiIcon *> index_;
+    mutable bool                     indexDirty_ = false;
+
+    static int internName(const QString &name)
+    {
+        auto it = nameIds_.constFind(name);
+        if (it != nameIds_.constEnd()) {
+            return it.value();
+        }
+        int id = names_.size();
+        names_.append(name);
+        nameIds_.insert(name, id);
+        return id;
+    }
+
+    void indexIconset(const Iconset &iconset) const;
+
+    void rebuildIndex() const
+    {
+        index_.fill(nullptr, names_.size());
+        for (const Iconset &iconset : iconsets_) {
+            indexIconset(iconset);
+        }
+        indexDirty_ = false;
+    }
+
 public:
     const QPixmap &emptyPixmap() const
     {
@@ -877,6 +904,17 @@ public:
     }
 
     const PsiIcon *icon(const QString &name) const;
+    const PsiIcon *icon(int id) const;
+
+    static int iconId(const QString &name) { return internName(name); }
+
+    // called when icons of a registered iconset were added or removed
+    static void invalidateIndex()
+    {
+        if (instance_) {
+            instance_->indexDirty_ = true;
+        }
+    }
 
     static void reset()
     {
@@ -887,30 +925,65 @@ public:
 //! \endif
 
 IconsetFactoryPrivate *IconsetFactoryPrivate::instance_ = nullptr;
+QHash<QString, int>    IconsetFactoryPrivate::nameIds_;
+QStringList            IconsetFactoryPrivate::names_;
 
-void IconsetFactoryPrivate::registerIconset(const Iconset &i)
+const PsiIcon *IconsetFactoryPrivate::icon(const QString &name) const
 {
-    if (!iconsets_.contains(i)) {
-        iconsets_.append(i);
+    if (indexDirty_) {
+        rebuildIndex(); // new names could be added to the registered iconsets
     }
+    auto it = nameIds_.constFind(name);
+    return it == nameIds_.constEnd() ? nullptr : icon(it.value());
 }
 
-void IconsetFactoryPrivate::unregisterIconset(const Iconset &i) { iconsets_.removeAll(i); }
-
-const PsiIcon *IconsetFactoryPrivate::icon(const QString &name) const
+const PsiIcon *IconsetFactoryPrivate::icon(int id) const
 {
-    const PsiIcon *out = nullptr;
-    for (const Iconset &iconset : iconsets_) {
-        out = iconset.icon(name);
-        if (out) {
-            break;
-        }
+    if (indexDirty_) {
+        rebuildIndex();
     }
-    return out;
+    return id >= 0 && id < index_.size() ? index_[id] : nullptr;
 }
 
 void IconsetFactory::reset() { IconsetFactoryPrivate::reset(); }
 
+/**
+ * Returns interned id of the icon \a name. The id may be resolved before the icon is
+ * actually loaded and stays valid for the whole application lifetime.
+ * \sa iconPtr(IconId)
+ */
+IconsetFactory::IconId IconsetFactory::iconId(const QString &name)
+{
+    if (name.isEmpty()) {
+        return IconId();
+    }
+    return IconId(IconsetFactoryPrivate::iconId(name));
+}
+
+/**
+ * Returns pointer to PsiIcon with interned \a id, or \a 0 if there is no such icon
+ * in IconsetFactory. This is the fastest way to find an icon.
+ */
+const PsiIcon *IconsetFactory::iconPtr(IconId id)
+{
+    return IconsetFactoryPrivate::instance()->icon(id.toInt());
+}
+
+/**
+ * The same as iconPixmap(const QString &, const QSize) but takes the interned icon id.
+ */
+QPixmap IconsetFactory::iconPixmap(IconId id, const QSize desiredSize)
+{
+    const PsiIcon *i = iconPtr(id);
+    if (i) {
+        if (!desiredSize.isEmpty() && i->isScalable())
+            return i->pixmap(desiredSize);
+        return i->impix().pixmap();
+    }
+
+    return IconsetFactoryPrivate::instance()->emptyPixmap();
+}
+
 /**
  * Returns pointer to PsiIcon with name \a name, or \a 0 if PsiIcon with that name wasn't
  * found in IconsetFactory.
@@ -1014,6 +1087,7 @@ public:
     QHash<QString, QString>    info;
     int                        iconSize_;
     QHash<QString, QByteArray> zipCache;
+    bool                       inFactory = false; // registered iconsets keep IconsetFactory's index up to date
 
 public:
     Private() { init(); }
@@ -1039,6 +1113,9 @@ public:
         remove(dict.find(n));
         dict[n] = icon;
         list.append(icon);
+        if (inFactory) {
+            IconsetFactoryPrivate::invalidateIndex();
+        }
     }
 
     void clear()
@@ -1047,6 +1124,9 @@ public:
         while (!list.isEmpty()) {
             delete list.takeFirst();
         }
+        if (inFactory) {
+            IconsetFactoryPrivate::invalidateIndex();
+        }
     }
 
     void remove(QString name) { remove(dict.find(name)); }
@@ -1058,6 +1138,9 @@ public:
             dict.erase(it);
             list.removeAll(i);
             delete i;
+            if (inFactory) {
+                IconsetFactoryPrivate::invalidateIndex();
+            }
         }
     }
 
@@ -1137,7 +1220,7 @@ public:
         }
     }
 
-    static int icon_counter; // used to give unique names to icons
+    static QAtomicInt icon_counter; // used to give unique names to icons. iconsets may be loaded in parallel
 
     // will return 'true' when icon is loaded ok
     bool loadKdeEmoticon(const QDomElement &emot, const QString &dir, QSize &size)
@@ -1230,7 +1313,7 @@ public:
         QList<PsiIcon::IconText> text;
         QHash<QString, QString>  graphic, sound, object; // mime => filename
 
-        QString name       = QString::asprintf("icon_%04d", icon_counter++);
+        QString name       = QString::asprintf("icon_%04d", icon_counter.fetchAndAddRelaxed(1));
         bool    isAnimated = false;
         bool    isImage    = false;
         bool    isScalable = false;
@@ -1486,7 +1569,52 @@ public:
 };
 //! \endif
 
-int Iconset::Private::icon_counter = 0;
+QAtomicInt Iconset::Private::icon_counter = 0;
+
+IconsetFactoryPrivate::~IconsetFactoryPrivate()
+{
+    for (const Iconset &i : std::as_const(iconsets_)) {
+        i.d->inFactory = false;
+    }
+    iconsets_.clear();
+
+    if (emptyPixmap_) {
+        delete emptyPixmap_;
+        emptyPixmap_ = nullptr;
+    }
+}
+
+void IconsetFactoryPrivate::indexIconset(const Iconset &iconset) const
+{
+    for (auto it = iconset.d->dict.cbegin(); it != iconset.d->dict.cend(); ++it) {
+        int id = internName(it.key());
+        if (id >= index_.size()) {
+            index_.resize(names_.size());
+        }
+        if (!index_[id]) {
+            index_[id] = it.value();
+        }
+    }
+}
+
+void IconsetFactoryPrivate::registerIconset(const Iconset &i)
+{
+    if (!iconsets_.contains(i)) {
+        iconsets_.append(i);
+        i.d->inFactory = true;
+        if (!indexDirty_) {
+            indexIconset(i); // it has the lowest priority, so it's enough to fill the gaps
+        }
+    }
+}
+
+void IconsetFactoryPrivate::unregisterIconset(const Iconset &i)
+{
+    if (iconsets_.removeAll(i)) {
+        i.d->inFactory = false;
+        indexDirty_    = true;
+    }
+}
 
 // static int iconset_counter = 0;
 
@@ -1571,6 +1699,9 @@ bool Iconset::isEmpty() const { return d->list.isEmpty(); }
 /**
  * Loads Icons and additional information from directory \a dir. Directory can usual directory,
  * or a .zip/.jisp archive. There must exist file named \c icondef.xml in that directory.
+ * It's safe to call this function from a worker thread as long as Anim::setMainThread() was called
+ * and the iconset isn't registered in IconsetFactory until it's handed back to the main thread.
+ * Images are kept as QImage until their pixmaps are requested.
  */
 bool Iconset::load(const QString &dir, Format format)
 {
@@ -239,12 +239,33 @@ public:
 private:
     class Private;
     QExplicitlySharedDataPointer<Private> d;
+
+    friend class IconsetFactoryPrivate;
 };
 
 class IconsetFactory {
 public:
+    // Interned icon name. Resolve it once with iconId() and keep it for fast lookups.
+    // Ids stay valid while the application runs, even when iconsets are reloaded.
+    class IconId {
+    public:
+        IconId() = default;
+        explicit IconId(int id) : id_(id) { }
+
+        bool        isValid() const { return id_ >= 0; }
+        int         toInt() const { return id_; }
+        inline bool operator==(const IconId &other) const { return id_ == other.id_; }
+
+    private:
+        int id_ = -1;
+    };
+
     static void reset();
 
+    static IconId         iconId(const QString &name);
+    static const PsiIcon *iconPtr(IconId id);
+    static QPixmap        iconPixmap(IconId id, const QSize desiredSize = QSize());
+
     static PsiIcon        icon(const QString &name);
     static inline PsiIcon icon(const char *name) { return icon(QString(QLatin1String(name))); } // optimization
     static QPixmap        iconPixmap(const QString &name, const QSize desiredSize = QSize());
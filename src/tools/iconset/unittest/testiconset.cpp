@@ -195,6 +195,82 @@ private slots:
         delete is;
     }
 
+    void testIconIdPrecedence()
+    {
+        Iconset *small = new Iconset();
+        QVERIFY(small->load("iconsets/roster/small.jisp"));
+        const PsiIcon *smallIcon = small->iterator().next();
+
+        // registered later iconsets have lower priority
+        const PsiIcon *registered = IconsetFactory::iconPtr(smallIcon->name());
+        small->addToFactory();
+        IconsetFactory::IconId id = IconsetFactory::iconId(smallIcon->name());
+        QVERIFY(id.isValid());
+        QCOMPARE(IconsetFactory::iconPtr(id), registered ? registered : smallIcon);
+        QCOMPARE(IconsetFactory::iconPtr(smallIcon->name()), IconsetFactory::iconPtr(id));
+
+        // ids may be resolved before the icon is available
+        IconsetFactory::IconId lateId = IconsetFactory::iconId("unittest/late");
+        QVERIFY(!IconsetFactory::iconPtr(lateId));
+        small->setIcon("unittest/late", *smallIcon);
+        QVERIFY(IconsetFactory::iconPtr(lateId));
+
+        small->removeFromFactory();
+        QVERIFY(!IconsetFactory::iconPtr(lateId));
+        QCOMPARE(IconsetFactory::iconPtr(id), registered);
+
+        delete small;
+    }
+
+    void benchmarkIconLookup_data()
+    {
+        QTest::addColumn<int>("mode");
+        QTest::newRow("linear") << 0;
+        QTest::newRow("name") << 1;
+        QTest::newRow("id") << 2;
+    }
+
+    void benchmarkIconLookup()
+    {
+        QFETCH(int, mode);
+
+        const QStringList files { "iconsets/system/crystal_system.jisp", "iconsets/roster/small.jisp" };
+        QList<Iconset>    iconsets;
+        for (int i = 0; i < 12; i++) {
+            Iconset is;
+            QVERIFY(is.load(i == 11 ? QString("iconsets/emoticons/puz.jisp") : files[i % files.size()]));
+            is.addToFactory();
+            iconsets.append(is);
+        }
+
+        // the icon only the last registered iconset has, i.e. the worst case for the linear search
+        const QString                name = iconsets.last().iterator().next()->name();
+        const IconsetFactory::IconId id   = IconsetFactory::iconId(name);
+        QList<Iconset>               all  = QList<Iconset>() << *iconset << iconsets;
+
+        const PsiIcon *found = nullptr;
+        QBENCHMARK
+        {
+            for (int i = 0; i < 1000; i++) {
+                if (mode == 0) {
+                    for (const Iconset &is : std::as_const(all)) {
+                        if ((found = is.icon(name)))
+                            break;
+                    }
+                } else if (mode == 1) {
+                    found = IconsetFactory::iconPtr(name);
+                } else {
+                    found = IconsetFactory::iconPtr(id);
+                }
+            }
+        }
+        QVERIFY(found);
+
+        for (const Iconset &is : std::as_const(iconsets)) {
+            is.removeFromFactory();
+        }
+    }
+
     void testCreateQIcon()
     {
         const PsiIcon *chat = IconsetFactory::iconPtr("psi/chat");
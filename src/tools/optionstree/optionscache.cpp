@@ -0,0 +1,98 @@
+/*
+ * optionscache.cpp - binary cache of saved options
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "optionscache.h"
+
+#include "optionstree.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+static const quint32 cacheMagic   = 0x50534f43; // PSOC
+static const quint32 cacheVersion = 1;
+
+QString OptionsCache::fileName(const QString &xmlFile) { return xmlFile + QLatin1String(".cache"); }
+
+bool OptionsCache::read(const QString &xmlFile, QVariantMap &options)
+{
+    QFileInfo fi(xmlFile);
+    if (!fi.isFile()) {
+        return false;
+    }
+    QFile f(fileName(xmlFile));
+    if (!f.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream in(&f);
+    quint32     magic, version, qtVersion;
+    qint64      size, modified;
+    in >> magic >> version >> qtVersion >> size >> modified;
+    if (magic != cacheMagic || version != cacheVersion || qtVersion != QT_VERSION || size != fi.size()
+        || modified != fi.lastModified().toMSecsSinceEpoch()) {
+        return false;
+    }
+    in >> options;
+    return in.status() == QDataStream::Ok;
+}
+
+bool OptionsCache::write(const QString &xmlFile, const QVariantMap &options, const QString &configNS,
+                         const QString &configVersion)
+{
+    OptionsTree tree;
+    for (auto it = options.cbegin(); it != options.cend(); ++it) {
+        tree.setOption(it.key(), it.value());
+    }
+    if (!tree.saveOptions(xmlFile, "options", configNS, configVersion)) {
+        QFile::remove(fileName(xmlFile));
+        return false;
+    }
+
+    // a missing cache only costs parsing the xml on the next start
+    QFileInfo fi(xmlFile);
+    QSaveFile f(fileName(xmlFile));
+    if (!f.open(QIODevice::WriteOnly)) {
+        return true;
+    }
+    QDataStream out(&f);
+    out << cacheMagic << cacheVersion << quint32(QT_VERSION) << qint64(fi.size())
+        << qint64(fi.lastModified().toMSecsSinceEpoch()) << options;
+    if (out.status() == QDataStream::Ok) {
+        f.commit();
+    } else {
+        f.cancelWriting();
+        QFile::remove(fileName(xmlFile));
+    }
+    return true;
+}
+
+QVariantMap OptionsCache::changedOptions(const OptionsTree &tree, const OptionsTree &defaults)
+{
+    QVariantMap ret;
+    const auto  names = tree.allOptionNames();
+    for (const QString &name : names) {
+        const QVariant &value = tree.getOption(name);
+        if (value != defaults.getOption(name, VariantTree::missingValue)) {
+            ret.insert(name, value);
+        }
+    }
+    return ret;
+}
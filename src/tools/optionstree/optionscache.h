@@ -0,0 +1,46 @@
+/*
+ * optionscache.h - binary cache of saved options
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef OPTIONSCACHE_H
+#define OPTIONSCACHE_H
+
+#include <QString>
+#include <QVariantMap>
+
+class OptionsTree;
+
+/**
+ * Saves options as xml along with a binary copy of them. The copy is
+ * loaded instead of the xml while the xml has the same size and mtime and
+ * Qt is of the same version. Safe to use from any thread.
+ */
+class OptionsCache {
+public:
+    static QString fileName(const QString &xmlFile);
+
+    // false if there is no cache valid for xmlFile
+    static bool read(const QString &xmlFile, QVariantMap &options);
+    static bool write(const QString &xmlFile, const QVariantMap &options, const QString &configNS,
+                      const QString &configVersion);
+
+    // options of tree with values differing from defaults, including the ones missing in them
+    static QVariantMap changedOptions(const OptionsTree &tree, const OptionsTree &defaults);
+};
+
+#endif // OPTIONSCACHE_H
@@ -25,12 +25,33 @@
 
 #include <QDomDocument>
 #include <QDomElement>
+#include <QPointer>
 #include <QStringList>
 
+#include <algorithm>
+#include <vector>
+
+/**
+ * Node of the subscription trie. Children are keyed by a single path component,
+ * so looking up everyone interested in "options.ui.chat.css" takes four hash lookups
+ * no matter how many subscriptions there are.
+ */
+struct OptionsTree::SubscriptionNode {
+    struct Subscription {
+        QPointer<QObject> context;
+        Callback          callback;
+    };
+
+    ~SubscriptionNode() { qDeleteAll(children); }
+
+    QHash<QString, SubscriptionNode *> children;
+    QList<Subscription>                subscribers;
+};
+
 /**
  * Default constructor
  */
-OptionsTree::OptionsTree(QObject *parent) : QObject(parent) { }
+OptionsTree::OptionsTree(QObject *parent) : QObject(parent), subscriptions_(new SubscriptionNode) { }
 
 /**
  * Destructor
@@ -78,8 +99,127 @@ void OptionsTree::setOption(const QString &name, const QVariant &value)
         emit optionInserted(name);
     }
     emit optionChanged(name);
+
+    if (subscriptions_->children.isEmpty() && subscriptions_->subscribers.isEmpty()) {
+        return;
+    }
+    if (batchDepth_) {
+        if (!batched_.contains(name)) {
+            batched_.append(name);
+        }
+    } else {
+        notifySubscribers({ name });
+    }
+}
+
+/**
+ * \brief Subscribes to changes of the option \a path and of all the options below it.
+ * \a callback gets the names of the changed options. Outside of a Batch it's always one name.
+ * The subscription is removed automatically when \a context is destroyed.
+ */
+void OptionsTree::subscribe(const QString &path, QObject *context, const Callback &callback)
+{
+    SubscriptionNode *node = subscriptions_.get();
+    if (!path.isEmpty()) {
+        const auto parts = path.split(QLatin1Char('.'));
+        for (const QString &part : parts) {
+            auto &child = node->children[part];
+            if (!child) {
+                child = new SubscriptionNode;
+            }
+            node = child;
+        }
+    }
+    node->subscribers.append({ context, callback });
+    connect(context, &QObject::destroyed, this, [this, context]() { unsubscribe(context); });
+}
+
+/**
+ * \brief Removes all the subscriptions made with \a context.
+ */
+void OptionsTree::unsubscribe(QObject *context)
+{
+    std::function<bool(SubscriptionNode *)> prune = [&prune, context](SubscriptionNode *node) {
+        node->subscribers.erase(std::remove_if(node->subscribers.begin(), node->subscribers.end(),
+                                               [context](const SubscriptionNode::Subscription &s) {
+                                                   return !s.context || s.context == context;
+                                               }),
+                                node->subscribers.end());
+        for (auto it = node->children.begin(); it != node->children.end();) {
+            if (prune(it.value())) {
+                delete it.value();
+                it = node->children.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        return node->subscribers.isEmpty() && node->children.isEmpty();
+    };
+    prune(subscriptions_.get());
+}
+
+void OptionsTree::beginBatch() { ++batchDepth_; }
+
+void OptionsTree::endBatch()
+{
+    if (--batchDepth_ || batched_.isEmpty()) {
+        return;
+    }
+    QStringList changed;
+    changed.swap(batched_);
+    notifySubscribers(changed);
+}
+
+/**
+ * Invokes every subscriber interested in any of \a changed exactly once,
+ * passing only the options it's interested in.
+ */
+void OptionsTree::notifySubscribers(const QStringList &changed)
+{
+    struct Pending {
+        SubscriptionNode::Subscription subscription;
+        QStringList                    changed;
+    };
+    std::vector<Pending>                                       pending;
+    QHash<const SubscriptionNode::Subscription *, std::size_t> index;
+
+    auto collect = [&](const SubscriptionNode *node, const QString &name) {
+        for (const auto &s : node->subscribers) {
+            auto it = index.constFind(&s);
+            if (it == index.constEnd()) {
+                index.insert(&s, pending.size());
+                pending.push_back({ s, { name } });
+            } else {
+                pending[it.value()].changed.append(name);
+            }
+        }
+    };
+
+    for (const QString &name : changed) {
+        const SubscriptionNode *node = subscriptions_.get();
+        collect(node, name);
+        const auto parts = name.split(QLatin1Char('.'));
+        for (const QString &part : parts) {
+            node = node->children.value(part);
+            if (!node) {
+                break;
+            }
+            collect(node, name);
+        }
+    }
+
+    // callbacks are free to (un)subscribe, so they are called only after the trie walk is done
+    for (const auto &p : pending) {
+        if (p.subscription.context) {
+            p.subscription.callback(p.changed);
+        }
+    }
 }
 
+OptionsTree::Batch::Batch(OptionsTree *tree) : tree_(tree) { tree_->beginBatch(); }
+
+OptionsTree::Batch::~Batch() { tree_->endBatch(); }
+
 /**
  * @brief returns true if the node @a node is an internal node.
  */
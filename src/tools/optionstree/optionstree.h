@@ -22,6 +22,8 @@
 
 #include "varianttree.h"
 
+#include <functional>
+#include <memory>
 #include <optional>
 
 /**
@@ -33,6 +35,25 @@
 class OptionsTree : public QObject {
     Q_OBJECT
 public:
+    using Callback = std::function<void(const QStringList &changed)>;
+
+    /**
+     * \brief Scope coalescing change notifications of subscribers.
+     * While at least one Batch exists, subscribe()d callbacks are not invoked.
+     * When the last one is destroyed every interested subscriber is called
+     * once with all the changed options it is interested in.
+     * optionChanged is still emitted right away for every option.
+     */
+    class Batch {
+    public:
+        explicit Batch(OptionsTree *tree);
+        ~Batch();
+
+    private:
+        Q_DISABLE_COPY(Batch)
+        OptionsTree *tree_;
+    };
+
     OptionsTree(QObject *parent = nullptr);
     ~OptionsTree();
 
@@ -72,6 +93,11 @@ public:
                             const QString &configVersion = "");
     static bool exists(QString fileName);
 
+    // Calls callback when the option at path or anything below it changes.
+    // The subscription is dropped when context is destroyed.
+    void subscribe(const QString &path, QObject *context, const Callback &callback);
+    void unsubscribe(QObject *context);
+
 signals:
     void optionChanged(const QString &option);
     void optionAboutToBeInserted(const QString &option);
@@ -80,7 +106,17 @@ signals:
     void optionRemoved(const QString &option);
 
 private:
+    struct SubscriptionNode;
+
+    void beginBatch();
+    void endBatch();
+    void notifySubscribers(const QStringList &changed);
+
     VariantTree tree_;
+
+    std::unique_ptr<SubscriptionNode> subscriptions_;
+    int                               batchDepth_ = 0;
+    QStringList                       batched_;
     friend class OptionsTreeReader;
     friend class OptionsTreeWriter;
 };
@@ -1,11 +1,13 @@
 INCLUDEPATH += $$PWD
 DEPENDPATH  += $$PWD
 
-HEADERS += $$PWD/optionstree.h \
+HEADERS += $$PWD/optionscache.h \
+            $$PWD/optionstree.h \
             $$PWD/varianttree.h \
             $$PWD/optionstreereader.h \
             $$PWD/optionstreewriter.h
-SOURCES += $$PWD/optionstree.cpp \
+SOURCES += $$PWD/optionscache.cpp \
+            $$PWD/optionstree.cpp \
             $$PWD/varianttree.cpp \
             $$PWD/optionstreereader.cpp \
             $$PWD/optionstreewriter.cpp
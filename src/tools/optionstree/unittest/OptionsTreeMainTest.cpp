@@ -96,6 +96,50 @@ private slots:
         verifyTree(&tree2);
     }
 
+    void subscribeTest()
+    {
+        OptionsTree tree;
+        QObject     context;
+        QStringList exact, subtree, other;
+        tree.subscribe("options.ui.chat.css", &context, [&](const QStringList &c) { exact += c; });
+        tree.subscribe("options.ui", &context, [&](const QStringList &c) { subtree += c; });
+        tree.subscribe("options.ui.chatx", &context, [&](const QStringList &c) { other += c; });
+
+        tree.setOption("options.ui.chat.css", "a");
+        tree.setOption("options.ui.chat.font", "b");
+        tree.setOption("options.uix", 1);
+        QCOMPARE(exact, QStringList({ "options.ui.chat.css" }));
+        QCOMPARE(subtree, QStringList({ "options.ui.chat.css", "options.ui.chat.font" }));
+        QVERIFY(other.isEmpty());
+
+        tree.unsubscribe(&context);
+        tree.setOption("options.ui.chat.css", "c");
+        QCOMPARE(exact.size(), 1);
+    }
+
+    void batchTest()
+    {
+        OptionsTree        tree;
+        QList<QStringList> calls;
+        {
+            QObject context;
+            tree.subscribe("a", &context, [&](const QStringList &c) { calls.append(c); });
+            {
+                OptionsTree::Batch batch(&tree);
+                tree.setOption("a.x", 1);
+                tree.setOption("a.y", 2);
+                tree.setOption("a.x", 3);
+                tree.setOption("b", 4);
+                QVERIFY(calls.isEmpty());
+            }
+            QCOMPARE(calls.size(), 1);
+            QCOMPARE(calls.first(), QStringList({ "a.x", "a.y" }));
+        }
+        // context is gone, so is the subscription
+        tree.setOption("a.x", 5);
+        QCOMPARE(calls.size(), 1);
+    }
+
 #if 0
     void stressTest() {
         bench_.startIteration();
@@ -0,0 +1,216 @@
+/*
+ * tracer.cpp - low overhead tracing of where the time goes
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "tracer.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QSaveFile>
+#include <QThread>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace {
+
+// a few minutes of a busy gui thread. the rest is counted as dropped
+const std::size_t maxEventsPerThread = 1 << 20;
+
+struct Event {
+    const char *name;
+    qint64      ts;
+    qint64      value; // duration of a span or value of a counter
+    char        phase;
+};
+
+struct ThreadBuffer {
+    QMutex             mutex; // only contended while the trace is written
+    std::vector<Event> events;
+    quint64            dropped = 0;
+    int                tid;
+    QString            name;
+};
+
+struct Registry {
+    Registry() { clock.start(); }
+
+    QMutex                                     mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    QString                                    fileName;
+    QElapsedTimer                              clock;
+};
+
+Registry &registry()
+{
+    static Registry r;
+    return r;
+}
+
+ThreadBuffer *threadBuffer()
+{
+    // owned by the registry too, so the events outlive the thread
+    thread_local std::shared_ptr<ThreadBuffer> buffer;
+    if (!buffer) {
+        auto thread = QThread::currentThread();
+        auto app    = QCoreApplication::instance();
+        auto b      = std::make_shared<ThreadBuffer>();
+        b->name     = app && app->thread() == thread ? QStringLiteral("main") : thread->objectName();
+
+        auto        &r = registry();
+        QMutexLocker locker(&r.mutex);
+        b->tid = int(r.buffers.size()) + 1;
+        if (b->name.isEmpty())
+            b->name = QString("thread %1").arg(b->tid);
+        r.buffers.push_back(b);
+        buffer = b;
+    }
+    return buffer.get();
+}
+
+void append(const Event &e)
+{
+    auto         b = threadBuffer();
+    QMutexLocker locker(&b->mutex);
+    if (b->events.size() < maxEventsPerThread)
+        b->events.push_back(e);
+    else
+        ++b->dropped;
+}
+
+QByteArray jsonString(const QString &s)
+{
+    QByteArray ret = s.toUtf8();
+    ret.replace('\\', "\\\\").replace('"', "\\\"");
+    return '"' + ret + '"';
+}
+
+QByteArray micros(qint64 ns) { return QByteArray::number(double(ns) / 1000, 'f', 3); }
+
+} // namespace
+
+void Tracer::start(const QString &fileName)
+{
+    auto        &r = registry();
+    QMutexLocker locker(&r.mutex);
+    for (const auto &b : r.buffers) {
+        QMutexLocker bufferLocker(&b->mutex);
+        b->events.clear();
+        b->dropped = 0;
+    }
+    r.fileName = fileName;
+    enabled_   = true;
+    qDebug("tracer: recording to %s", qPrintable(fileName));
+}
+
+bool Tracer::stop()
+{
+    if (!enabled_.exchange(false))
+        return false;
+
+    auto        &r = registry();
+    QMutexLocker locker(&r.mutex);
+    QSaveFile    f(r.fileName);
+    if (!f.open(QIODevice::WriteOnly)) {
+        qWarning("tracer: failed to write %s: %s", qPrintable(r.fileName), qPrintable(f.errorString()));
+        return false;
+    }
+
+    const QByteArray pid     = QByteArray::number(QCoreApplication::applicationPid());
+    quint64          dropped = 0;
+    bool             first   = true;
+    f.write("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    for (const auto &b : r.buffers) {
+        std::vector<Event> events;
+        {
+            QMutexLocker bufferLocker(&b->mutex);
+            events.swap(b->events);
+            dropped += b->dropped;
+            b->dropped = 0;
+        }
+        const QByteArray ids = ",\"pid\":" + pid + ",\"tid\":" + QByteArray::number(b->tid);
+        f.write(first ? "\n" : ",\n");
+        first = false;
+        f.write("{\"name\":\"thread_name\",\"ph\":\"M\"" + ids + ",\"args\":{\"name\":" + jsonString(b->name) + "}}");
+
+        QByteArray chunk;
+        for (const auto &e : events) {
+            chunk += ",\n{\"name\":" + jsonString(QString::fromUtf8(e.name)) + ",\"ph\":\"" + e.phase
+                + "\",\"ts\":" + micros(e.ts) + ids;
+            if (e.phase == 'X')
+                chunk += ",\"dur\":" + micros(e.value) + '}';
+            else
+                chunk += ",\"args\":{\"value\":" + QByteArray::number(e.value) + "}}";
+            if (chunk.size() > 64 * 1024) {
+                f.write(chunk);
+                chunk.clear();
+            }
+        }
+        f.write(chunk);
+    }
+    f.write("\n]}\n");
+
+    if (dropped)
+        qWarning("tracer: %llu events didn't fit into the buffers", dropped);
+    if (!f.commit()) {
+        qWarning("tracer: failed to write %s: %s", qPrintable(r.fileName), qPrintable(f.errorString()));
+        return false;
+    }
+    qDebug("tracer: trace written to %s", qPrintable(r.fileName));
+    return true;
+}
+
+QHash<QString, Tracer::SpanStats> Tracer::summary()
+{
+    QHash<const char *, SpanStats> byName;
+    auto                          &r = registry();
+    QMutexLocker                   locker(&r.mutex);
+    for (const auto &b : r.buffers) {
+        QMutexLocker bufferLocker(&b->mutex);
+        for (const auto &e : b->events) {
+            if (e.phase != 'X')
+                continue;
+            auto &s = byName[e.name];
+            ++s.count;
+            s.total += e.value;
+            s.max = std::max(s.max, e.value);
+        }
+    }
+
+    // the same literal may have a few addresses
+    QHash<QString, SpanStats> ret;
+    for (auto it = byName.cbegin(); it != byName.cend(); ++it) {
+        auto &s = ret[QString::fromUtf8(it.key())];
+        s.count += it->count;
+        s.total += it->total;
+        s.max = std::max(s.max, it->max);
+    }
+    return ret;
+}
+
+qint64 Tracer::now() { return registry().clock.nsecsElapsed(); }
+
+void Tracer::complete(const char *name, qint64 begin, qint64 end)
+{
+    if (isEnabled())
+        append({ name, begin, end - begin, 'X' });
+}
+
+void Tracer::counter(const char *name, qint64 value) { append({ name, now(), value, 'C' }); }
@@ -0,0 +1,103 @@
+/*
+ * tracer.h - low overhead tracing of where the time goes
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QHash>
+#include <QString>
+
+#include <atomic>
+
+/**
+ * Collects scoped spans and counters from any thread and writes them as
+ * Chrome trace event JSON, which both chrome://tracing and the Perfetto UI
+ * open directly.
+ *
+ * Tracing is off by default. Then a span only notes itself as the current
+ * scope of its thread, which EventLoopWatchdog reports for stalls. When
+ * it's on, events go to a buffer of the calling thread, so threads don't
+ * wait for each other. The buffers are merged only when the trace is
+ * written. Names are not copied, so they have to be string literals.
+ */
+class Tracer {
+public:
+    struct SpanStats {
+        qint64 count = 0;
+        qint64 total = 0; // nanoseconds
+        qint64 max   = 0;
+    };
+
+    static bool isEnabled() { return enabled_.load(std::memory_order_relaxed); }
+
+    // starts collecting. whatever was collected before is dropped
+    static void start(const QString &fileName);
+    // stops collecting and writes the trace to the file passed to start()
+    static bool stop();
+    // spans collected so far, aggregated by name
+    static QHash<QString, SpanStats> summary();
+
+    static qint64 now(); // nanoseconds since the first use of the tracer
+    static void   complete(const char *name, qint64 begin, qint64 end);
+    static void   counter(const char *name, qint64 value);
+
+    // innermost span of the calling thread, tracked even when tracing is off.
+    // other threads may read it through the returned reference
+    static std::atomic<const char *> &currentScope()
+    {
+        thread_local std::atomic<const char *> scope { nullptr };
+        return scope;
+    }
+
+private:
+    static inline std::atomic<bool> enabled_ { false };
+};
+
+class TraceSpan {
+public:
+    explicit TraceSpan(const char *name) :
+        name_(name), scope_(Tracer::currentScope()), parent_(scope_.load(std::memory_order_relaxed)),
+        begin_(Tracer::isEnabled() ? Tracer::now() : -1)
+    {
+        scope_.store(name, std::memory_order_relaxed); // only this thread writes it
+    }
+    ~TraceSpan()
+    {
+        scope_.store(parent_, std::memory_order_relaxed);
+        if (begin_ >= 0)
+            Tracer::complete(name_, begin_, Tracer::now());
+    }
+
+private:
+    Q_DISABLE_COPY(TraceSpan)
+
+    const char                *name_;
+    std::atomic<const char *> &scope_;
+    const char                *parent_;
+    qint64                     begin_;
+};
+
+#define TRACE_SPAN(name) TraceSpan traceSpan(name)
+#define TRACE_COUNTER(name, value)                                                                                     \
+    do {                                                                                                               \
+        if (Tracer::isEnabled())                                                                                       \
+            Tracer::counter(name, value);                                                                              \
+    } while (0)
+
+#endif // TRACER_H
@@ -0,0 +1,200 @@
+#include "clienticonmatcher.h"
+
+#include <QFile>
+#include <QMap>
+#include <QSet>
+#include <QStringList>
+#include <QtTest/QtTest>
+
+// The matcher PsiIconset::caps2client() used before the trie. Kept here as a reference.
+class LegacyClientIconMatcher {
+public:
+    struct ClientIconCheck {
+        QString     icon;
+        QStringList inside;
+    };
+
+    void addDescriptions(const QStringList &lines, const QSet<QString> &iconNames)
+    {
+        for (const auto &line : lines) {
+            QString iconName = line.trimmed().section(QLatin1Char(' '), 0, 0);
+            if (iconName.isEmpty() || !iconNames.contains(iconName)) {
+                continue;
+            }
+            ClientIconCheck ic   = { iconName, QStringList() };
+            QString         caps = line.mid(iconName.length());
+            const auto     &cList = caps.split(QLatin1Char(','), Qt::SkipEmptyParts);
+            for (const QString &c : cList) {
+                QString ct = c.trimmed();
+                if (ct.length()) {
+                    QStringList spec = ct.split('#');
+                    ic.inside        = spec.mid(1);
+                    cm[spec[0]].append(ic);
+                }
+            }
+        }
+        // the original used std::sort. stable sort is used by both to get comparable results
+        for (auto &checkList : cm) {
+            std::stable_sort(checkList.begin(), checkList.end(),
+                             [](const auto &a, const auto &b) { return a.inside.size() > b.inside.size(); });
+        }
+        cm.insert(QLatin1String("~"), QList<ClientIconCheck>());
+    }
+
+    QString match(const QString &name) const
+    {
+        auto it = cm.lowerBound(name);
+        if ((it != cm.end() && name.startsWith(it.key())) || (it != cm.begin() && name.startsWith((--it).key()))) {
+            for (const ClientIconCheck &ic : it.value()) {
+                bool matched = true;
+                for (const QString &s : ic.inside) {
+                    if (name.indexOf(s, it.key().size()) == -1) {
+                        matched = false;
+                        break;
+                    }
+                }
+                if (matched) {
+                    return ic.icon;
+                }
+            }
+        }
+        return QString();
+    }
+
+    QMap<QString, QList<ClientIconCheck>> cm;
+};
+
+class TestClientIconMatcher : public QObject {
+    Q_OBJECT
+private:
+    QStringList             lines;
+    QSet<QString>           icons;
+    QStringList             names;
+    ClientIconMatcher       matcher;
+    LegacyClientIconMatcher legacy;
+
+    // true if the icon's spec really describes the name
+    bool specMatches(const QString &icon, const QString &name) const
+    {
+        for (const QString &line : lines) {
+            if (line.trimmed().section(QLatin1Char(' '), 0, 0) != icon) {
+                continue;
+            }
+            const auto specs = line.mid(icon.length()).split(QLatin1Char(','), Qt::SkipEmptyParts);
+            for (const QString &spec : specs) {
+                QStringList parts = spec.trimmed().split('#');
+                if (!name.startsWith(parts[0])) {
+                    continue;
+                }
+                bool all = std::all_of(parts.begin() + 1, parts.end(),
+                                       [&](const QString &s) { return name.indexOf(s, parts[0].size()) != -1; });
+                if (all) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QFile f(CLIENT_ICONS_TXT);
+        QVERIFY(f.open(QIODevice::ReadOnly));
+        lines = QString::fromUtf8(f.readAll()).split('\n');
+        lines += QStringList { "psi-plus psi+,psi#fork#plus", "psi-ny psi#ny", "psi-im psi-im" };
+        for (const QString &line : std::as_const(lines)) {
+            QString icon = line.trimmed().section(QLatin1Char(' '), 0, 0);
+            if (!icon.isEmpty()) {
+                icons.insert(icon);
+            }
+        }
+        matcher.addDescriptions(lines, icons);
+        legacy.addDescriptions(lines, icons);
+
+        // every spec itself, its variations and some noise
+        for (const QString &line : std::as_const(lines)) {
+            const auto specs = line.trimmed().section(QLatin1Char(' '), 1).split(QLatin1Char(','), Qt::SkipEmptyParts);
+            for (const QString &spec : specs) {
+                QStringList parts = spec.trimmed().split('#');
+                names << parts[0] << parts.join("") << parts.join("-") << parts[0] + ".example.com"
+                      << parts[0].left(parts[0].size() - 1) << parts.mid(1).join("") + parts[0];
+            }
+        }
+        names << "psiplus.com" << "psi-fork-plus" << "psi.ny" << "psi.example" << "" << "~" << "zzz"
+              << "psi-im.org/helloworld";
+    }
+
+    void testAgainstLegacy()
+    {
+        for (const QString &name : std::as_const(names)) {
+            QString expected = legacy.match(name);
+            QString actual   = matcher.match(name);
+            if (!expected.isEmpty()) {
+                // whatever the old matcher found is found by the trie as well
+                QCOMPARE(actual, expected);
+            } else if (!actual.isEmpty()) {
+                // the old one checked just the nearest key, the trie falls back to shorter beginnings
+                QVERIFY2(specMatches(actual, name), qPrintable(name + " => " + actual));
+            }
+        }
+    }
+
+    void testFallbackToShorterPrefix()
+    {
+        // "psi-plus" is the nearest key, but "psi" is a prefix as well
+        QCOMPARE(legacy.match("psi.ny"), QString());
+        QCOMPARE(matcher.match("psi.ny"), QString("psi-ny"));
+        QCOMPARE(matcher.match("psi-fork-plus"), QString("psi-plus"));
+        QCOMPARE(matcher.match("psi+"), legacy.match("psi+"));
+    }
+
+    void testUnknownIcons()
+    {
+        ClientIconMatcher m;
+        m.addDescriptions(lines, QSet<QString>());
+        QVERIFY(m.isEmpty());
+        QCOMPARE(m.match("psi+"), QString());
+    }
+
+    void testCache()
+    {
+        for (const QString &name : std::as_const(names)) {
+            QCOMPARE(matcher.cachedMatch(name), matcher.match(name));
+            QCOMPARE(matcher.cachedMatch(name), matcher.match(name));
+        }
+    }
+
+    void benchmarkLegacy()
+    {
+        QBENCHMARK
+        {
+            for (const QString &name : std::as_const(names)) {
+                legacy.match(name);
+            }
+        }
+    }
+
+    void benchmarkTrie()
+    {
+        QBENCHMARK
+        {
+            for (const QString &name : std::as_const(names)) {
+                matcher.match(name);
+            }
+        }
+    }
+
+    void benchmarkCached()
+    {
+        QBENCHMARK
+        {
+            for (const QString &name : std::as_const(names)) {
+                matcher.cachedMatch(name);
+            }
+        }
+    }
+};
+
+QTEST_MAIN(TestClientIconMatcher)
+#include "testclienticonmatcher.moc"
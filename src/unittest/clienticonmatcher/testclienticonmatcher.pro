@@ -0,0 +1,11 @@
+TARGET = testclienticonmatcher
+CONFIG += unittest
+include($$PWD/../../../qa/oldtest/unittest.pri)
+
+QT -= gui
+INCLUDEPATH += ../..
+DEFINES += CLIENT_ICONS_TXT=\\\"$$PWD/../../../client_icons.txt\\\"
+
+HEADERS += ../../clienticonmatcher.h
+SOURCES += testclienticonmatcher.cpp \
+    ../../clienticonmatcher.cpp
@@ -0,0 +1,51 @@
+#include "eventloopwatchdog.h"
+
+#include "tracer.h"
+
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+class TestEventLoopWatchdog : public QObject {
+    Q_OBJECT
+
+    QTemporaryDir dir;
+
+private slots:
+    void testIdle()
+    {
+        EventLoopWatchdog watchdog;
+        QCOMPARE(EventLoopWatchdog::instance(), &watchdog);
+        QTest::qWait(500);
+
+        auto    histogram = watchdog.histogram();
+        quint64 total     = 0;
+        for (auto n : histogram)
+            total += n;
+        QVERIFY(total >= 2);
+        QVERIFY(watchdog.stalls().isEmpty());
+    }
+
+    void testStall()
+    {
+        EventLoopWatchdog watchdog;
+        watchdog.setReportFile(dir.filePath("report.txt"));
+        QTest::qWait(200); // let a heartbeat be on its way
+        {
+            TRACE_SPAN("blocking");
+            QThread::msleep(watchdog.stallThreshold() + 500);
+        }
+        QTRY_COMPARE(watchdog.stalls().size(), 1);
+
+        auto stall = watchdog.stalls().first();
+        QVERIFY(stall.msecs >= watchdog.stallThreshold());
+        QVERIFY(!stall.scopes.isEmpty());
+        QCOMPARE(stall.scopes.first().first, QString("blocking"));
+
+        QFile f(dir.filePath("report.txt"));
+        QVERIFY(f.open(QIODevice::ReadOnly));
+        QVERIFY(f.readAll().contains("blocking"));
+    }
+};
+
+QTEST_MAIN(TestEventLoopWatchdog)
+#include "testeventloopwatchdog.moc"
@@ -0,0 +1,12 @@
+TARGET = testeventloopwatchdog
+CONFIG += unittest
+include($$PWD/../../../qa/oldtest/unittest.pri)
+
+QT -= gui
+INCLUDEPATH += ../..
+
+HEADERS += ../../eventloopwatchdog.h \
+    ../../tracer.h
+SOURCES += testeventloopwatchdog.cpp \
+    ../../eventloopwatchdog.cpp \
+    ../../tracer.cpp
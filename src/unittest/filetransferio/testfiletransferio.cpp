@@ -0,0 +1,251 @@
+#include "filetransferio.h"
+
+#include <QCryptographicHash>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+#include <functional>
+
+// the send window of iris' FileTransfer (SENDBUFSIZE). dataSizeNeeded() never returns more than what is free of it
+static const int sendWindow = 64 * 1024;
+
+static QByteArray fileHash(const QString &fileName)
+{
+    QFile f(fileName);
+    if (!f.open(QIODevice::ReadOnly))
+        return QByteArray();
+    QCryptographicHash h(QCryptographicHash::Sha1);
+    h.addData(&f);
+    return h.result();
+}
+
+static void createFile(const QString &fileName, qint64 size)
+{
+    QFile f(fileName);
+    QVERIFY(f.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    QByteArray block(1024 * 1024, 0);
+    quint32    x = 1;
+    for (qint64 written = 0; written < size; written += block.size()) {
+        for (char &c : block) {
+            x = x * 1103515245 + 12345;
+            c = char(x >> 24);
+        }
+        f.write(block.constData(), int(qMin<qint64>(block.size(), size - written)));
+    }
+}
+
+class TestFileTransferIO : public QObject {
+    Q_OBJECT
+
+private:
+    QTemporaryDir dir;
+
+    struct LoopbackResult {
+        qint64 msecs           = 0;
+        int    progressUpdates = 0;
+        bool   ok              = false;
+    };
+
+    // Sends src to dst over a loopback TCP connection the way FileTransferHandler does it.
+    //   legacy:    one freshly allocated block per bytesWritten(), next block scheduled with
+    //              singleShot(0) every time, progress on every block, receiver writes synchronously.
+    //   pipelined: the free window is filled with several blocks from FileBlockReader, sending is
+    //              scheduled once per event loop pass, progress is throttled, receiver writes with
+    //              AsyncFileWriter.
+    LoopbackResult runLoopback(bool pipelined, const QString &src, const QString &dst)
+    {
+        LoopbackResult res;
+        QTcpServer     server;
+        if (!server.listen(QHostAddress::LocalHost))
+            return res;
+        QTcpSocket client;
+        client.connectToHost(server.serverAddress(), server.serverPort());
+        if (!server.waitForNewConnection(5000) || !client.waitForConnected(5000))
+            return res;
+        QTcpSocket *in = server.nextPendingConnection();
+
+        QFile source(src);
+        if (!source.open(QIODevice::ReadOnly))
+            return res;
+        const qint64 total = source.size();
+
+        QFile           sink(dst);
+        AsyncFileWriter writer;
+        if (pipelined) {
+            if (!writer.open(dst, 0))
+                return res;
+        } else if (!sink.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            return res;
+        }
+
+        QEventLoop       loop;
+        QObject          ctx;
+        FileBlockReader  reader;
+        ProgressThrottle throttle;
+        qint64           queued = 0, sent = 0, stored = 0;
+        bool             scheduled = false;
+        reader.setDevice(&source);
+
+        auto dataSizeNeeded = [&]() {
+            qint64 free = sendWindow - client.bytesToWrite();
+            return int(qMax<qint64>(0, qMin(free, total - queued)));
+        };
+        std::function<void()> trySend;
+        if (pipelined) {
+            trySend = [&]() {
+                scheduled = false;
+                int needed;
+                while ((needed = dataSizeNeeded()) > 0) {
+                    QByteArray a = reader.read(needed);
+                    queued += a.size();
+                    client.write(a);
+                }
+            };
+        } else {
+            trySend = [&]() {
+                int        blockSize = dataSizeNeeded();
+                QByteArray a(blockSize, 0);
+                int        r = int(source.read(a.data(), a.size()));
+                a.resize(r);
+                queued += r;
+                client.write(a);
+            };
+        }
+
+        connect(&client, &QTcpSocket::bytesWritten, &ctx, [&](qint64 x) {
+            sent += x;
+            if (sent < total) {
+                if (!pipelined)
+                    QTimer::singleShot(0, &ctx, trySend);
+                else if (!scheduled) {
+                    scheduled = true;
+                    QTimer::singleShot(0, &ctx, trySend);
+                }
+            }
+            if (!pipelined || throttle.isDue())
+                ++res.progressUpdates;
+        });
+        auto stored_ = [&](qint64 x) {
+            stored += x;
+            if (stored == total)
+                loop.quit();
+        };
+        connect(in, &QTcpSocket::readyRead, &ctx, [&]() {
+            QByteArray a = in->readAll();
+            if (pipelined) {
+                writer.write(a);
+            } else {
+                sink.write(a);
+                stored_(a.size());
+            }
+        });
+        connect(&writer, &AsyncFileWriter::bytesWritten, &ctx, stored_);
+        QTimer::singleShot(120000, &loop, &QEventLoop::quit);
+
+        QElapsedTimer timer;
+        timer.start();
+        trySend();
+        loop.exec();
+        writer.close();
+        sink.close();
+        res.msecs = timer.elapsed();
+        res.ok    = stored == total;
+        return res;
+    }
+
+private slots:
+    void initTestCase() { QVERIFY(dir.isValid()); }
+
+    void testReader()
+    {
+        const QString name = dir.filePath("reader");
+        createFile(name, 100000);
+        QFile f(name);
+        QVERIFY(f.open(QIODevice::ReadOnly));
+
+        FileBlockReader reader(4096, 2);
+        reader.setDevice(&f);
+        QByteArray all;
+        QByteArray prev = reader.read(100000);
+        QCOMPARE(prev.size(), 4096);
+        all += prev;
+        for (;;) {
+            QByteArray a = reader.read(100000);
+            QVERIFY(!a.isNull());
+            if (a.isEmpty())
+                break;
+            all += a;
+        }
+        // a block kept by the caller must not be overwritten when its buffer is reused
+        QCOMPARE(prev, all.left(4096));
+        QCOMPARE(QCryptographicHash::hash(all, QCryptographicHash::Sha1), fileHash(name));
+    }
+
+    void testWriter()
+    {
+        const QString name = dir.filePath("writer");
+        {
+            AsyncFileWriter w;
+            QVERIFY(w.open(name, 0));
+            QSignalSpy spy(&w, &AsyncFileWriter::bytesWritten);
+            w.write("hello ");
+            w.write("world");
+            QCOMPARE(w.bytesToWrite(), qint64(11)); // counted down in our thread
+            w.close();
+            QTRY_COMPARE(spy.count(), 2);
+            QCOMPARE(w.bytesToWrite(), qint64(0));
+        }
+        {
+            // resume at offset
+            AsyncFileWriter w;
+            QVERIFY(w.open(name, 6));
+            w.write("psi!!");
+            w.close();
+        }
+        QFile f(name);
+        QVERIFY(f.open(QIODevice::ReadOnly));
+        QCOMPARE(f.readAll(), QByteArray("hello psi!!"));
+
+        AsyncFileWriter w;
+        QVERIFY(!w.open(dir.filePath("no/such/dir/file"), 0));
+        QVERIFY(!w.errorString().isEmpty());
+    }
+
+    void testThrottle()
+    {
+        ProgressThrottle t(50);
+        QVERIFY(t.isDue());
+        QVERIFY(!t.isDue());
+        QTest::qWait(60);
+        QVERIFY(t.isDue());
+    }
+
+    void benchmarkLoopback_data()
+    {
+        QTest::addColumn<bool>("pipelined");
+        QTest::newRow("legacy") << false;
+        QTest::newRow("pipelined") << true;
+    }
+
+    void benchmarkLoopback()
+    {
+        QFETCH(bool, pipelined);
+        const qint64  size = 64 * 1024 * 1024;
+        const QString src  = dir.filePath("loopback-src");
+        const QString dst  = dir.filePath("loopback-dst");
+        if (!QFile::exists(src))
+            createFile(src, size);
+
+        LoopbackResult res;
+        QBENCHMARK_ONCE { res = runLoopback(pipelined, src, dst); }
+        QVERIFY(res.ok);
+        QCOMPARE(fileHash(dst), fileHash(src));
+        qDebug("%s: %.1f MiB/s, %d progress updates", pipelined ? "pipelined" : "legacy",
+               size / 1048576.0 / qMax<qint64>(res.msecs, 1) * 1000, res.progressUpdates);
+    }
+};
+
+QTEST_MAIN(TestFileTransferIO)
+#include "testfiletransferio.moc"
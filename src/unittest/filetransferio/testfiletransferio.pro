@@ -0,0 +1,11 @@
+TARGET = testfiletransferio
+CONFIG += unittest
+include($$PWD/../../../qa/oldtest/unittest.pri)
+
+QT -= gui
+QT += network
+INCLUDEPATH += ../..
+
+HEADERS += ../../filetransferio.h
+SOURCES += testfiletransferio.cpp \
+    ../../filetransferio.cpp
@@ -0,0 +1,110 @@
+#include "highlightmatcher.h"
+
+#include <QtTest/QtTest>
+
+#include <algorithm>
+
+using Spans = HighlightMatcher::Spans;
+
+Q_DECLARE_METATYPE(HighlightMatcher::Span)
+
+static Spans spans(std::initializer_list<std::pair<int, int>> list)
+{
+    Spans ret;
+    for (auto const &p : list)
+        ret.append({ p.first, p.second });
+    return ret;
+}
+
+class TestHighlightMatcher : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testMatch_data()
+    {
+        QTest::addColumn<QStringList>("rules");
+        QTest::addColumn<QString>("text");
+        QTest::addColumn<QString>("nick");
+        QTest::addColumn<Spans>("expected");
+
+        QTest::newRow("substring") << QStringList { "psi" } << "I like PSI+" << "" << spans({ { 7, 3 } });
+        QTest::newRow("inside word") << QStringList { "psi" } << "upsides" << "" << spans({ { 1, 3 } });
+        QTest::newRow("whole word") << QStringList { "\"psi\"" } << "upsides, psi!" << "" << spans({ { 9, 3 } });
+        QTest::newRow("whole word at edges") << QStringList { "\"psi\"" } << "Psi" << "" << spans({ { 0, 3 } });
+        QTest::newRow("regexp") << QStringList { "/ps[iy]\\d+/" } << "psy12 and PSI3" << ""
+                                << spans({ { 0, 5 }, { 10, 4 } });
+        QTest::newRow("overlapping") << QStringList { "he", "she", "hers" } << "ushers" << ""
+                                     << spans({ { 1, 5 } });
+        QTest::newRow("suffix of other") << QStringList { "abcd", "bc" } << "abcx" << "" << spans({ { 1, 2 } });
+        QTest::newRow("unicode fold") << QStringList { "привет" } << "ПРИВЕТ всем" << "" << spans({ { 0, 6 } });
+        QTest::newRow("nick is case sensitive") << QStringList {} << "Bob, bob" << "bob" << spans({ { 5, 3 } });
+        QTest::newRow("nick with words") << QStringList { "alert" } << "rex: ALERT" << "rex"
+                                         << spans({ { 0, 3 }, { 5, 5 } });
+        QTest::newRow("invalid regexp is skipped") << QStringList { "/(/", "x" } << "(x)" << ""
+                                                   << spans({ { 1, 1 } });
+        QTest::newRow("no match") << QStringList { "foo", "\"bar\"" } << "barista" << "" << Spans();
+    }
+
+    void testMatch()
+    {
+        QFETCH(QStringList, rules);
+        QFETCH(QString, text);
+        QFETCH(QString, nick);
+        QFETCH(Spans, expected);
+
+        HighlightMatcher m;
+        m.compile(rules);
+        QCOMPARE(m.match(text, nick), expected);
+        if (nick.isEmpty())
+            QCOMPARE(m.hasMatch(text), !expected.isEmpty());
+    }
+
+    // the check GCMainDlg::message() did before the matcher was there
+    void testAgainstContains()
+    {
+        const QStringList words { "psi", "Qt", "xmpp", "kde", "linux", "jabber", "iris", "muc" };
+        const QStringList texts { "nothing interesting", "Psi+ is out", "ANY XMPP", "linuxoid", "", "mu c" };
+        HighlightMatcher  m;
+        m.compile(words);
+        for (auto const &text : texts) {
+            bool legacy = std::any_of(words.begin(), words.end(),
+                                      [&text](const QString &w) { return text.contains(w, Qt::CaseInsensitive); });
+            QCOMPARE(m.hasMatch(text), legacy);
+        }
+    }
+
+    void benchmarkMatch_data()
+    {
+        QTest::addColumn<bool>("compiled");
+        QTest::newRow("contains") << false;
+        QTest::newRow("compiled") << true;
+    }
+
+    void benchmarkMatch()
+    {
+        QFETCH(bool, compiled);
+        QStringList words;
+        for (int i = 0; i < 50; i++)
+            words << QString("highlight%1").arg(i);
+        const QString text = QString("Some ordinary groupchat message which doesn't mention anything at all. ")
+                                 .repeated(3);
+        HighlightMatcher m;
+        m.compile(words);
+
+        bool found = false;
+        if (compiled) {
+            QBENCHMARK { found |= !m.match(text, "somenick").isEmpty(); }
+        } else {
+            QBENCHMARK
+            {
+                found |= text.contains(QLatin1String("somenick"));
+                for (auto const &w : words)
+                    found |= text.contains(w, Qt::CaseInsensitive);
+            }
+        }
+        QVERIFY(!found);
+    }
+};
+
+QTEST_MAIN(TestHighlightMatcher)
+#include "testhighlightmatcher.moc"
@@ -0,0 +1,10 @@
+TARGET = testhighlightmatcher
+CONFIG += unittest
+include($$PWD/../../../qa/oldtest/unittest.pri)
+
+QT -= gui
+INCLUDEPATH += ../..
+
+HEADERS += ../../highlightmatcher.h
+SOURCES += testhighlightmatcher.cpp \
+    ../../highlightmatcher.cpp
@@ -0,0 +1,81 @@
+#include "mucautojoiner.h"
+
+#include <QtTest/QtTest>
+
+class TestMucAutoJoiner : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testOrderAndConcurrency()
+    {
+        MucAutoJoiner joiner;
+        joiner.setConcurrency(2);
+        joiner.setBudget(60000);
+        QSignalSpy joins(&joiner, &MucAutoJoiner::join);
+        QSignalSpy done(&joiner, &MucAutoJoiner::done);
+
+        joiner.add("quiet@muc", 0);
+        joiner.add("busy@muc", 300);
+        joiner.add("active@muc", 200);
+        joiner.add("other@muc", 0);
+        joiner.add("busy@muc", 300); // already scheduled
+        QCOMPARE(joiner.totalCount(), 4);
+        QCOMPARE(joins.count(), 0); // started from the event loop
+
+        QCoreApplication::processEvents();
+        QCOMPARE(joins.count(), 2);
+        QCOMPARE(joins[0][0].toString(), QString("busy@muc"));
+        QCOMPARE(joins[1][0].toString(), QString("active@muc"));
+
+        joiner.finished("active@muc");
+        QCOMPARE(joins.count(), 3);
+        QCOMPARE(joins[2][0].toString(), QString("quiet@muc"));
+
+        joiner.finished("unknown@muc"); // not ours
+        joiner.finished("busy@muc");
+        joiner.finished("busy@muc"); // reported twice
+        QCOMPARE(joins.count(), 4);
+        QCOMPARE(joins[3][0].toString(), QString("other@muc"));
+        QCOMPARE(joiner.finishedCount(), 2);
+
+        joiner.finished("other@muc");
+        joiner.finished("quiet@muc");
+        QCOMPARE(done.count(), 1);
+        QVERIFY(!joiner.isActive());
+    }
+
+    void testBudget()
+    {
+        MucAutoJoiner joiner;
+        joiner.setConcurrency(1);
+        joiner.setBudget(50);
+        QSignalSpy joins(&joiner, &MucAutoJoiner::join);
+        QSignalSpy done(&joiner, &MucAutoJoiner::done);
+
+        joiner.add("slow@muc", 1);
+        joiner.add("fast@muc", 0);
+        QCoreApplication::processEvents();
+        QCOMPARE(joins.count(), 1);
+
+        // the slow room doesn't hold the queue longer than the budget
+        QTRY_COMPARE_WITH_TIMEOUT(joins.count(), 2, 1000);
+        joiner.finished("fast@muc");
+        QCOMPARE(done.count(), 0);
+        joiner.finished("slow@muc"); // still counted when it's finally joined
+        QCOMPARE(done.count(), 1);
+    }
+
+    void testClear()
+    {
+        MucAutoJoiner joiner;
+        QSignalSpy    joins(&joiner, &MucAutoJoiner::join);
+        joiner.add("a@muc", 0);
+        joiner.clear();
+        QCoreApplication::processEvents();
+        QCOMPARE(joins.count(), 0);
+        QVERIFY(!joiner.isActive());
+    }
+};
+
+QTEST_MAIN(TestMucAutoJoiner)
+#include "testmucautojoiner.moc"
@@ -0,0 +1,10 @@
+TARGET = testmucautojoiner
+CONFIG += unittest
+include($$PWD/../../../qa/oldtest/unittest.pri)
+
+QT -= gui
+INCLUDEPATH += ../..
+
+HEADERS += ../../mucautojoiner.h
+SOURCES += testmucautojoiner.cpp \
+    ../../mucautojoiner.cpp
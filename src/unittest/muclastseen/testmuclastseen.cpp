@@ -0,0 +1,57 @@
+#include "muclastseen.h"
+
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+class TestMucLastSeen : public QObject {
+    Q_OBJECT
+
+    QTemporaryDir dir;
+
+    QString fileName() const { return dir.filePath("muc-last-seen.dat"); }
+
+private slots:
+    void testSeen()
+    {
+        MucLastSeen ls(fileName());
+        QString     room = "room@conference.example.org";
+        QDateTime   t    = QDateTime::fromSecsSinceEpoch(1700000000, Qt::UTC);
+        QVERIFY(!ls.lastSeen(room).isValid());
+
+        QVERIFY(ls.seen(room, t, "a", false));
+        QVERIFY(ls.seen(room, t.addMSecs(300), "b", false)); // same second
+        QCOMPARE(ls.lastSeen(room), t);
+
+        // the history sent on the next join
+        QVERIFY(!ls.seen(room, t.addSecs(-60), "old", true));
+        QVERIFY(!ls.seen(room, t, "a", true));
+        QVERIFY(!ls.seen(room, t, "b", true));
+        QVERIFY(ls.seen(room, t, "c", true)); // missed one within the same second
+        QVERIFY(ls.seen(room, t.addSecs(5), "d", true));
+        QCOMPARE(ls.lastSeen(room), t.addSecs(5));
+
+        // live messages are never skipped
+        QVERIFY(ls.seen(room, t, "e", false));
+        QCOMPARE(ls.lastSeen(room), t.addSecs(5));
+
+        // other rooms are not affected
+        QVERIFY(ls.seen("other@conference.example.org", t, "a", true));
+    }
+
+    void testPersistence()
+    {
+        QString   room = "persistent@conference.example.org";
+        QDateTime t    = QDateTime::fromSecsSinceEpoch(1700001000, Qt::UTC);
+        {
+            MucLastSeen ls(fileName());
+            QVERIFY(ls.seen(room, t, "x", false));
+        } // saved on destruction
+        MucLastSeen ls(fileName());
+        QCOMPARE(ls.lastSeen(room), t);
+        QVERIFY(!ls.seen(room, t, "x", true));
+        QVERIFY(ls.seen(room, t, "y", true));
+    }
+};
+
+QTEST_MAIN(TestMucLastSeen)
+#include "testmuclastseen.moc"
@@ -0,0 +1,10 @@
+TARGET = testmuclastseen
+CONFIG += unittest
+include($$PWD/../../../qa/oldtest/unittest.pri)
+
+QT -= gui
+INCLUDEPATH += ../..
+
+HEADERS += ../../muclastseen.h
+SOURCES += testmuclastseen.cpp \
+    ../../muclastseen.cpp
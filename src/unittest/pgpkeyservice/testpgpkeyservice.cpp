@@ -0,0 +1,116 @@
+#include "pgpkeyservice.h"
+
+#include <QProcess>
+#include <QRegularExpression>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+// runs against a throwaway keyring with keys made on the fly
+class TestPGPKeyService : public QObject {
+    Q_OBJECT
+
+    QTemporaryDir home;
+    QString       gpgBin;
+
+    QByteArray gpg(const QStringList &arguments)
+    {
+        QProcess p;
+        p.start(gpgBin, QStringList { "--batch", "--no-tty" } + arguments);
+        if (!p.waitForFinished(60000) || p.exitCode() != 0)
+            return QByteArray();
+        return p.readAllStandardOutput();
+    }
+
+    // fingerprint of the new key
+    QString generate(const QString &uid)
+    {
+        gpg({ "--passphrase", "", "--quick-gen-key", uid, "ed25519", "sign", "never" });
+        auto listing = QString::fromUtf8(gpg({ "--with-colons", "--fingerprint", "=" + uid }));
+        auto match   = QRegularExpression("^fpr:+([0-9A-F]{40}):", QRegularExpression::MultilineOption).match(listing);
+        return match.captured(1);
+    }
+
+    PGPKeyService::Key key(PGPKeyService &service, const QString &keyId)
+    {
+        PGPKeyService::Key ret;
+        bool               done = false;
+        service.key(keyId, this, [&](const PGPKeyService::Key &key) {
+            ret  = key;
+            done = true;
+        });
+        QTest::qWaitFor([&]() { return done; }, 30000);
+        return ret;
+    }
+
+private slots:
+    void initTestCase()
+    {
+        gpgBin = QStandardPaths::findExecutable("gpg");
+        if (gpgBin.isEmpty())
+            QSKIP("gpg is not installed");
+        QVERIFY(home.isValid());
+        qputenv("GNUPGHOME", home.path().toLocal8Bit());
+        QCOMPARE(PGPKeyService::homeDir(), home.path());
+    }
+
+    void cleanupTestCase()
+    {
+        if (!gpgBin.isEmpty())
+            QProcess::execute("gpgconf", { "--kill", "gpg-agent" });
+    }
+
+    void testFormatFingerprint()
+    {
+        QCOMPARE(PGPKeyService::formatFingerprint("E4DCCF8B9EE9451CDB9DC9360AB3E847F0D9F49B"),
+                 QString("E4DC CF8B 9EE9 451C DB9D  C936 0AB3 E847 F0D9 F49B"));
+        QVERIFY(PGPKeyService::formatFingerprint("0AB3E847F0D9F49B").isEmpty());
+    }
+
+    void testKeys()
+    {
+        const QString fpr = generate("Test User: Colon <test@example.org>");
+        if (fpr.isEmpty())
+            QSKIP("could not generate a key");
+
+        PGPKeyService service;
+        QVERIFY(!service.isReady());
+        auto k = key(service, "0x" + fpr.right(16).toLower());
+        QVERIFY(service.isReady());
+        QCOMPARE(k.id, fpr.right(16));
+        QCOMPARE(k.fingerprint, fpr);
+        QCOMPARE(k.ownerName, QString("Test User: Colon <test@example.org>"));
+
+        // answered right away now
+        bool found = false;
+        service.key(fpr.right(8), this, [&](const PGPKeyService::Key &key) { found = key.id == k.id; });
+        QVERIFY(found);
+        QCOMPARE(key(service, fpr).id, k.id);
+        QVERIFY(key(service, "DEADBEEF").isNull());
+
+        QString data;
+        bool    exported = false;
+        service.publicKeyData(fpr, this, [&](const QString &d) {
+            data     = d;
+            exported = true;
+        });
+        QTRY_VERIFY_WITH_TIMEOUT(exported, 30000);
+        QVERIFY(data.startsWith("-----BEGIN PGP PUBLIC KEY BLOCK-----"));
+    }
+
+    void testKeyringChange()
+    {
+        PGPKeyService service;
+        QVERIFY(key(service, "DEADBEEF").isNull());
+
+        QSignalSpy    changed(&service, &PGPKeyService::keysChanged);
+        const QString fpr = generate("Second <second@example.org>");
+        if (fpr.isEmpty())
+            QSKIP("could not generate a key");
+        QTRY_VERIFY_WITH_TIMEOUT(changed.count() > 0 && service.isReady(), 30000);
+        QCOMPARE(key(service, fpr).ownerName, QString("Second <second@example.org>"));
+    }
+};
+
+QTEST_MAIN(TestPGPKeyService)
+#include "testpgpkeyservice.moc"
@@ -0,0 +1,12 @@
+TARGET = testpgpkeyservice
+CONFIG += unittest
+include($$PWD/../../../qa/oldtest/unittest.pri)
+
+QT -= gui
+INCLUDEPATH += ../..
+
+HEADERS += ../../gpgprocess.h \
+    ../../pgpkeyservice.h
+SOURCES += testpgpkeyservice.cpp \
+    ../../gpgprocess.cpp \
+    ../../pgpkeyservice.cpp
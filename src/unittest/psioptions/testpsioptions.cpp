@@ -0,0 +1,205 @@
+#include "optionscache.h"
+#include "optionstree.h"
+
+#include <QDateTime>
+#include <QTemporaryDir>
+#include <QtEndian>
+#include <QtTest/QtTest>
+
+#include <functional>
+#include <memory>
+
+// PsiOptions writes its delta and cache with OptionsCache
+class TestPsiOptions : public QObject {
+    Q_OBJECT
+
+    QTemporaryDir dir;
+    OptionsTree   builtIn; // what default.xml has
+
+    static const QString ns;
+    static const QString hibernateAfter; // 30 in the built-in defaults
+
+    // what the autosave writes
+    void saveWith(const QString &file, const std::function<void(OptionsTree &)> &change)
+    {
+        OptionsTree options;
+        copy(builtIn, options);
+        change(options);
+        QVERIFY(OptionsCache::write(file, OptionsCache::changedOptions(options, builtIn), ns, "1.0"));
+    }
+
+    static void copy(const OptionsTree &from, OptionsTree &to)
+    {
+        const auto names = from.allOptionNames();
+        for (const QString &name : names)
+            to.setOption(name, from.getOption(name));
+    }
+
+    static std::unique_ptr<OptionsTree> saved(const QString &file)
+    {
+        auto tree = std::make_unique<OptionsTree>();
+        tree->loadOptions(file, "options", ns);
+        return tree;
+    }
+
+    // like PsiOptions::load() over the defaults
+    QVariant loaded(const QString &file, const QString &name)
+    {
+        OptionsTree options;
+        copy(builtIn, options);
+        QVariantMap cached;
+        if (OptionsCache::read(file, cached)) {
+            for (auto it = cached.cbegin(); it != cached.cend(); ++it)
+                options.setOption(it.key(), it.value());
+        } else {
+            options.loadOptions(file, "options", ns);
+        }
+        return options.getOption(name);
+    }
+
+    static void setMTime(const QString &file, const QDateTime &time)
+    {
+        QFile f(file);
+        QVERIFY(f.open(QIODevice::ReadWrite));
+        QVERIFY(f.setFileTime(time, QFileDevice::FileModificationTime));
+    }
+
+    // replaces \a from with \a to of the same length keeping the mtime, so the cache stays valid
+    static void patchXml(const QString &file, const QByteArray &from, const QByteArray &to)
+    {
+        QCOMPARE(from.size(), to.size());
+        QDateTime mtime = QFileInfo(file).lastModified();
+        QFile     f(file);
+        QVERIFY(f.open(QIODevice::ReadOnly));
+        QByteArray data = f.readAll().replace(from, to);
+        f.close();
+        QVERIFY(f.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        f.write(data);
+        f.close();
+        setMTime(file, mtime);
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QVERIFY(dir.isValid());
+        builtIn.setOption(hibernateAfter, 30);
+        builtIn.setOption("options.ui.chat.css", QString("p { color: black }"));
+        for (int i = 0; i < 100; ++i)
+            builtIn.setOption(QString("options.unittest.filler.option%1").arg(i), i);
+    }
+
+    void testDeltaSave()
+    {
+        QString file = dir.filePath("delta.xml");
+        saveWith(file, [](OptionsTree &o) {
+            o.setOption(hibernateAfter, 5);
+            o.setOption("options.unittest.unknown", QString("value"));
+            o.setOption("options.ui.chat.css", o.getOption("options.ui.chat.css")); // unchanged
+        });
+
+        auto tree = saved(file);
+        QCOMPARE(tree->getOption(hibernateAfter).toInt(), 5);
+        QCOMPARE(tree->getOption("options.unittest.unknown").toString(), QString("value"));
+        QVERIFY(!tree->getOption("options.ui.chat.css").isValid());
+        QVERIFY(tree->allOptionNames().size() < builtIn.allOptionNames().size() / 10);
+
+        // loaded over the defaults it's the same as before
+        QCOMPARE(loaded(file, hibernateAfter).toInt(), 5);
+        QCOMPARE(loaded(file, "options.ui.chat.css"), builtIn.getOption("options.ui.chat.css"));
+    }
+
+    void testCache()
+    {
+        QString file = dir.filePath("cache.xml");
+        saveWith(file, [](OptionsTree &o) { o.setOption(hibernateAfter, 11); });
+        QVERIFY(QFile::exists(file + ".cache"));
+
+        // the xml says 22 now, but size and mtime match, so the cached 11 is used
+        patchXml(file, ">11<", ">22<");
+        QCOMPARE(loaded(file, hibernateAfter).toInt(), 11);
+
+        // another mtime
+        setMTime(file, QFileInfo(file).lastModified().addSecs(-10));
+        QCOMPARE(loaded(file, hibernateAfter).toInt(), 22);
+    }
+
+    void testCacheInvalidation_data()
+    {
+        QTest::addColumn<QString>("kind");
+        QTest::newRow("size") << "size";
+        QTest::newRow("qt version") << "qt";
+        QTest::newRow("garbage") << "garbage";
+        QTest::newRow("missing") << "missing";
+    }
+
+    void testCacheInvalidation()
+    {
+        QFETCH(QString, kind);
+        QString file = dir.filePath(QString("invalid-%1.xml").arg(kind));
+        saveWith(file, [](OptionsTree &o) { o.setOption(hibernateAfter, 11); });
+        patchXml(file, ">11<", ">22<");
+
+        QFile cache(file + ".cache");
+        if (kind == "size") {
+            QDateTime mtime = QFileInfo(file).lastModified();
+            patchXml(file, ">22<", ">33<");
+            QFile f(file);
+            QVERIFY(f.open(QIODevice::Append));
+            f.write("\n");
+            f.close();
+            setMTime(file, mtime);
+            QCOMPARE(loaded(file, hibernateAfter).toInt(), 33);
+            return;
+        } else if (kind == "qt") {
+            // magic, format version, then the Qt version the cache was written with
+            QVERIFY(cache.open(QIODevice::ReadWrite));
+            cache.seek(8);
+            quint32 other = qToBigEndian(quint32(QT_VERSION + 1));
+            cache.write(reinterpret_cast<const char *>(&other), sizeof(other));
+            cache.close();
+        } else if (kind == "garbage") {
+            QVERIFY(cache.open(QIODevice::WriteOnly | QIODevice::Truncate));
+            cache.write("not a cache");
+            cache.close();
+        } else {
+            QVERIFY(cache.remove());
+        }
+        QCOMPARE(loaded(file, hibernateAfter).toInt(), 22);
+    }
+
+    // PsiOptions::loadDefaults() loads the system-wide file into the defaults as well
+    void testSystemDefaults()
+    {
+        QString system = dir.filePath("options-default.xml");
+        {
+            OptionsTree tree;
+            tree.setOption(hibernateAfter, 60);
+            QVERIFY(tree.saveOptions(system, "options", ns, "1.0"));
+        }
+        OptionsTree defaults;
+        copy(builtIn, defaults);
+        QVERIFY(defaults.loadOptions(system, "options", ns));
+        QCOMPARE(defaults.getOption(hibernateAfter).toInt(), 60);
+
+        OptionsTree options;
+        copy(defaults, options);
+        // back to the built-in value, which is not the default anymore
+        options.setOption(hibernateAfter, 30);
+        QCOMPARE(OptionsCache::changedOptions(options, defaults).value(hibernateAfter).toInt(), 30);
+        QVERIFY(!OptionsCache::changedOptions(options, builtIn).contains(hibernateAfter));
+
+        // equal to the system-wide default, so not saved
+        options.setOption(hibernateAfter, 60);
+        options.setOption("options.unittest.unknown", true);
+        auto changed = OptionsCache::changedOptions(options, defaults);
+        QVERIFY(!changed.contains(hibernateAfter));
+        QVERIFY(changed.value("options.unittest.unknown").toBool());
+    }
+};
+
+const QString TestPsiOptions::ns             = QStringLiteral("http://psi-im.org/options");
+const QString TestPsiOptions::hibernateAfter = QStringLiteral("options.ui.tabs.hibernate-after");
+
+QTEST_MAIN(TestPsiOptions)
+#include "testpsioptions.moc"
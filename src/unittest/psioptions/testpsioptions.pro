@@ -0,0 +1,21 @@
+TARGET = testpsioptions
+CONFIG += unittest
+include($$PWD/../../../qa/oldtest/unittest.pri)
+
+QT += xml
+INCLUDEPATH += ../../tools \
+    ../../tools/optionstree
+
+HEADERS += ../../tools/optionstree/optionscache.h \
+    ../../tools/optionstree/optionstree.h \
+    ../../tools/optionstree/optionstreereader.h \
+    ../../tools/optionstree/optionstreewriter.h \
+    ../../tools/optionstree/varianttree.h \
+    ../../tools/atomicxmlfile/atomicxmlfile.h
+SOURCES += testpsioptions.cpp \
+    ../../tools/optionstree/optionscache.cpp \
+    ../../tools/optionstree/optionstree.cpp \
+    ../../tools/optionstree/optionstreereader.cpp \
+    ../../tools/optionstree/optionstreewriter.cpp \
+    ../../tools/optionstree/varianttree.cpp \
+    ../../tools/atomicxmlfile/atomicxmlfile.cpp
@@ -0,0 +1,167 @@
+#include "rostersearchindex.h"
+
+#include <QRegularExpression>
+#include <QtTest/QtTest>
+
+#include <memory>
+#include <vector>
+
+using Fields = RosterSearchIndex::Fields;
+
+static Fields contact(const QString &name, const QString &jid, const QString &group = QString(),
+                      const QString &nick = QString())
+{
+    return { { RosterSearchIndex::NameField, name },
+             { RosterSearchIndex::JidField, jid },
+             { RosterSearchIndex::GroupField, group },
+             { RosterSearchIndex::NickField, nick } };
+}
+
+class TestRosterSearchIndex : public QObject {
+    Q_OBJECT
+
+    std::vector<std::unique_ptr<QObject>> keys;
+
+    QObject *key(int i)
+    {
+        while (int(keys.size()) <= i)
+            keys.emplace_back(new QObject);
+        return keys[size_t(i)].get();
+    }
+
+    static QList<QObject *> found(const QList<RosterSearchIndex::Match> &matches)
+    {
+        QList<QObject *> ret;
+        for (auto const &m : matches)
+            ret.append(m.key);
+        return ret;
+    }
+
+private slots:
+    void testSearch()
+    {
+        RosterSearchIndex index;
+        index.setEntry(key(0), contact("Alice", "alice@example.org", "Friends"));
+        index.setEntry(key(1), contact("Bob", "bob@example.org", "Work", "bobby"));
+        index.setEntry(key(2), contact("Малика", "malika@example.net"));
+        QCOMPARE(index.count(), 3);
+
+        QCOMPARE(found(index.search("ALI")), QList<QObject *>({ key(0), key(2) }));
+        QCOMPARE(found(index.search("bobb")), QList<QObject *>({ key(1) }));
+        QCOMPARE(found(index.search("work")), QList<QObject *>({ key(1) }));
+        QCOMPARE(found(index.search("мал")), QList<QObject *>({ key(2) }));
+        QCOMPARE(found(index.search("o")).size(), 2);
+        QCOMPARE(index.search("example").size(), 3);
+        QVERIFY(index.search("nobody").isEmpty());
+        QCOMPARE(index.search("").size(), 3);
+    }
+
+    void testRanking()
+    {
+        RosterSearchIndex index;
+        index.setEntry(key(0), contact("Some Anna", "x@example.org"));
+        index.setEntry(key(1), contact("Hanna", "y@example.org"));
+        index.setEntry(key(2), contact("Zed", "zanna@example.org"));
+        index.setEntry(key(3), contact("Anna", "z@example.org"));
+        index.setEntry(key(4), contact("Annabel", "w@example.org"));
+
+        auto res = index.search("anna");
+        QCOMPARE(found(res), QList<QObject *>({ key(3), key(4), key(0), key(1), key(2) }));
+        for (int i = 1; i < res.size(); ++i)
+            QVERIFY(res[i - 1].score > res[i].score);
+    }
+
+    void testNarrowing()
+    {
+        RosterSearchIndex index;
+        index.setEntry(key(0), contact("Alice", "alice@example.org"));
+        index.setEntry(key(1), contact("Alina", "alina@example.org"));
+        index.setEntry(key(2), contact("Bob", "bob@example.org"));
+
+        QCOMPARE(index.search("al").size(), 2);
+        QCOMPARE(found(index.search("alic")), QList<QObject *>({ key(0) }));
+        // going back is not narrowing
+        QCOMPARE(index.search("ali").size(), 2);
+        // an entry changed between keystrokes has to be found anyway
+        index.setEntry(key(2), contact("Alibaba", "bob@example.org"));
+        QCOMPARE(index.search("alib").size(), 1);
+        QCOMPARE(found(index.search("alib")), QList<QObject *>({ key(2) }));
+    }
+
+    void testUpdate()
+    {
+        RosterSearchIndex index;
+        QVERIFY(index.setEntry(key(0), contact("Alice", "alice@example.org")));
+        QVERIFY(!index.setEntry(key(0), contact("Alice", "alice@example.org")));
+        QVERIFY(index.setEntry(key(0), contact("Carol", "alice@example.org")));
+        QVERIFY(index.search("alice@").size() == 1);
+        QVERIFY(index.search("Alice").size() == 1); // still in the jid
+        QVERIFY(index.search("carol").size() == 1);
+
+        index.removeEntry(key(0));
+        QCOMPARE(index.count(), 0);
+        QVERIFY(index.search("carol").isEmpty());
+
+        // freed slot is reused
+        index.setEntry(key(1), contact("Dave", "dave@example.org"));
+        QCOMPARE(found(index.search("dave")), QList<QObject *>({ key(1) }));
+        QVERIFY(index.search("carol").isEmpty());
+
+        index.clear();
+        QCOMPARE(index.count(), 0);
+        QVERIFY(index.search("").isEmpty());
+    }
+
+    void benchmarkSearch_data()
+    {
+        QTest::addColumn<bool>("indexed");
+        QTest::newRow("regexp scan") << false;
+        QTest::newRow("index") << true;
+    }
+
+    // typing a name letter by letter over a 20k contacts roster
+    void benchmarkSearch()
+    {
+        QFETCH(bool, indexed);
+        const int         count = 20000;
+        RosterSearchIndex index;
+        QList<Fields>     roster;
+        for (int i = 0; i < count; ++i) {
+            auto fields = contact(QString("Contact %1").arg(i), QString("user%1@server%2.example").arg(i).arg(i % 50),
+                                  QString("Group %1").arg(i % 20), QString("nick%1").arg(i * 7));
+            roster.append(fields);
+            index.setEntry(key(i), fields);
+        }
+        const QStringList keystrokes { "c", "co", "con", "cont", "conta", "contac", "contact", "contact 1",
+                                       "contact 12", "contact 123" };
+
+        int matches = 0;
+        if (indexed) {
+            QBENCHMARK
+            {
+                for (auto const &q : keystrokes)
+                    matches = index.search(q).size();
+            }
+        } else {
+            QBENCHMARK
+            {
+                for (auto const &q : keystrokes) {
+                    QRegularExpression re(QRegularExpression::escape(q), QRegularExpression::CaseInsensitiveOption);
+                    matches = 0;
+                    for (auto const &fields : std::as_const(roster)) {
+                        for (auto const &f : fields) {
+                            if (re.match(f.second).hasMatch()) {
+                                ++matches;
+                                break;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        QCOMPARE(matches, 111); // 123, 1230..1239, 12300..12399
+    }
+};
+
+QTEST_MAIN(TestRosterSearchIndex)
+#include "testrostersearchindex.moc"
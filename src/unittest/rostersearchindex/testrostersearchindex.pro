@@ -0,0 +1,10 @@
+TARGET = testrostersearchindex
+CONFIG += unittest
+include($$PWD/../../../qa/oldtest/unittest.pri)
+
+QT -= gui
+INCLUDEPATH += ../..
+
+HEADERS += ../../rostersearchindex.h
+SOURCES += testrostersearchindex.cpp \
+    ../../rostersearchindex.cpp
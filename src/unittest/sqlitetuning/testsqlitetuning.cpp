@@ -0,0 +1,133 @@
+#include "sqlitetuning.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+class TestSqliteTuning : public QObject {
+    Q_OBJECT
+
+    QTemporaryDir dir;
+    int           dbCounter = 0;
+
+    // same layout as the events table of history.db
+    QSqlDatabase openDb(bool tuned)
+    {
+        QString      name = QString("db%1").arg(++dbCounter);
+        QSqlDatabase db   = QSqlDatabase::addDatabase("QSQLITE", name);
+        db.setDatabaseName(dir.filePath(name + ".db"));
+        if (!db.open())
+            return db;
+        if (tuned) {
+            SqliteTuning::enableIncrementalVacuum(db);
+            SqliteTuning::apply(db, SqliteTuning::Settings());
+        }
+        QSqlQuery query(db);
+        query.exec("CREATE TABLE `events` ("
+                   "`id` INTEGER NOT NULL PRIMARY KEY ASC, "
+                   "`contact_id` INTEGER NOT NULL, "
+                   "`date` TEXT, "
+                   "`m_text` TEXT"
+                   ");");
+        query.exec("CREATE INDEX `date` ON `events` (`date`);");
+        return db;
+    }
+
+    static void closeDb(QSqlDatabase &db)
+    {
+        QString name = db.connectionName();
+        db.close();
+        db = QSqlDatabase();
+        QSqlDatabase::removeDatabase(name);
+    }
+
+    // commits every 3 events just like EDBSqLite does in its normal mode
+    static bool insertEvents(QSqlDatabase &db, int count)
+    {
+        QSqlQuery query(db);
+        query.prepare("INSERT INTO `events` (`contact_id`, `date`, `m_text`) VALUES (:contact_id, :date, :m_text);");
+        QDateTime date = QDateTime::currentDateTime();
+        for (int i = 0; i < count; ++i) {
+            if (i % 3 == 0 && !db.transaction())
+                return false;
+            query.bindValue(":contact_id", i % 10 + 1);
+            query.bindValue(":date", date.addSecs(i));
+            query.bindValue(":m_text", QString("Some groupchat message number %1").arg(i));
+            if (!query.exec())
+                return false;
+            if (i % 3 == 2 && !db.commit())
+                return false;
+        }
+        return count % 3 == 0 || db.commit();
+    }
+
+    static int pragma(QSqlDatabase &db, const QString &name)
+    {
+        QSqlQuery query(db);
+        return query.exec(QString("PRAGMA %1;").arg(name)) && query.next() ? query.value(0).toInt() : -1;
+    }
+
+private slots:
+    void initTestCase() { QVERIFY(dir.isValid()); }
+
+    void testApply()
+    {
+        QSqlDatabase db = openDb(false);
+        QVERIFY(db.isOpen());
+        SqliteTuning::Settings settings;
+        settings.cacheSize = 2048;
+        QCOMPARE(SqliteTuning::apply(db, settings), QString("wal"));
+        QCOMPARE(pragma(db, "synchronous"), 1); // NORMAL
+        QCOMPARE(pragma(db, "cache_size"), -2048);
+
+        settings.wal = false;
+        QCOMPARE(SqliteTuning::apply(db, settings), QString("delete"));
+        QCOMPARE(pragma(db, "synchronous"), 2); // FULL
+        closeDb(db);
+    }
+
+    void testIncrementalVacuum()
+    {
+        QSqlDatabase db = openDb(true);
+        QCOMPARE(pragma(db, "auto_vacuum"), 2);
+        QVERIFY(insertEvents(db, 3000));
+        QVERIFY(QSqlQuery(db).exec("DELETE FROM `events`;"));
+        int freeBefore = pragma(db, "freelist_count");
+        QVERIFY(freeBefore > 10);
+        SqliteTuning::maintain(db, 10);
+        QCOMPARE(pragma(db, "freelist_count"), freeBefore - 10);
+        SqliteTuning::maintain(db, freeBefore);
+        QCOMPARE(pragma(db, "freelist_count"), 0);
+        closeDb(db);
+    }
+
+    void benchmarkInsert_data()
+    {
+        QTest::addColumn<bool>("tuned");
+        QTest::newRow("rollback journal") << false;
+        QTest::newRow("tuned") << true;
+    }
+
+    // a busy groupchat session written with the normal commit batching
+    void benchmarkInsert()
+    {
+        QFETCH(bool, tuned);
+        QSqlDatabase db = openDb(tuned);
+        QVERIFY(db.isOpen());
+        bool ok = true;
+        QBENCHMARK_ONCE { ok = insertEvents(db, 3000); }
+        QVERIFY(ok);
+        {
+            QSqlQuery query(db);
+            QVERIFY(query.exec("SELECT count(*) FROM `events`;") && query.next());
+            QCOMPARE(query.value(0).toInt(), 3000);
+        }
+        closeDb(db);
+    }
+};
+
+QTEST_MAIN(TestSqliteTuning)
+#include "testsqlitetuning.moc"
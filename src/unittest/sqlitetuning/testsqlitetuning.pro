@@ -0,0 +1,11 @@
+TARGET = testsqlitetuning
+CONFIG += unittest
+include($$PWD/../../../qa/oldtest/unittest.pri)
+
+QT -= gui
+QT += sql
+INCLUDEPATH += ../..
+
+HEADERS += ../../sqlitetuning.h
+SOURCES += testsqlitetuning.cpp \
+    ../../sqlitetuning.cpp
@@ -0,0 +1,175 @@
+#include "stanzareplay.h"
+
+#include "xmlring.h"
+
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+class TestStanzaReplay : public QObject {
+    Q_OBJECT
+
+    QTemporaryDir dir;
+
+private slots:
+    void testSynthetic()
+    {
+        const QString self = "me@replay.example/psi";
+        for (const auto &scenario : { "presence", "muc", "chat" }) {
+            auto items = StanzaReplay::synthetic(scenario, 100, self);
+            QCOMPARE(items.size(), scenario == QLatin1String("presence") ? 101 : 100);
+            QCOMPARE(items.last().stanza.attribute("to"), self);
+            QVERIFY(items.first().msecs <= items.last().msecs);
+        }
+        QCOMPARE(StanzaReplay::synthetic("chat", 1, self).first().stanza.tagName(), QString("message"));
+
+        // the contacts are pushed to the roster before their presences
+        auto presences = StanzaReplay::synthetic("presence", 250, self);
+        QCOMPARE(presences.size(), 253);
+        auto query = presences.first().stanza.firstChildElement("query");
+        QCOMPARE(query.namespaceURI(), QString("jabber:iq:roster"));
+        QCOMPARE(query.elementsByTagName("item").size(), 100);
+        QCOMPARE(presences[2].stanza.firstChildElement("query").elementsByTagName("item").size(), 50);
+        QCOMPARE(presences[3].stanza.tagName(), QString("presence"));
+        QVERIFY(StanzaReplay::synthetic("unknown", 10, self).isEmpty());
+    }
+
+    void testXml()
+    {
+        QFile f(dir.filePath("stanzas.xml"));
+        QVERIFY(f.open(QIODevice::WriteOnly));
+        f.write("<replay xmlns='jabber:client'>"
+                "<presence from='a@example.org/x'/>"
+                "<stream:features xmlns:stream='http://etherx.jabber.org/streams'/>"
+                "<message replay-ms='250' from='a@example.org/x'><body>hi</body></message>"
+                "<iq type='get' id='1'/>"
+                "</replay>");
+        f.close();
+
+        auto items = StanzaReplay::readXml(f.fileName());
+        QCOMPARE(items.size(), 3);
+        QCOMPARE(items[0].msecs, qint64(0));
+        QCOMPARE(items[1].msecs, qint64(250));
+        QCOMPARE(items[2].msecs, qint64(250));
+        QVERIFY(!items[1].stanza.hasAttribute("replay-ms"));
+        QCOMPARE(items[1].stanza.firstChildElement("body").text(), QString("hi"));
+        QVERIFY(StanzaReplay::readCapture(f.fileName()).isEmpty());
+    }
+
+    void testCaptureJoins()
+    {
+        QFile f(dir.filePath("room.xml"));
+        QVERIFY(f.open(QIODevice::WriteOnly));
+        f.write("<replay xmlns='jabber:client'>"
+                "<presence from='room@muc.example.org/other'>"
+                "<x xmlns='http://jabber.org/protocol/muc#user'><item role='participant'/></x></presence>"
+                "<presence from='room@muc.example.org/me'>"
+                "<x xmlns='http://jabber.org/protocol/muc#user'><item role='participant'/><status code='110'/></x>"
+                "</presence>"
+                "<message type='groupchat' from='room@muc.example.org/other'><body>hi</body></message>"
+                "</replay>");
+        f.close();
+
+        StanzaReplay replay([](const QDomElement &) { });
+        QVERIFY(replay.load(f.fileName(), "me@example.org/psi"));
+        QCOMPARE(replay.joins(), QStringList { "room@muc.example.org/me" });
+    }
+
+    void testCapture()
+    {
+        QString file = dir.filePath("capture.bin");
+        {
+            XmlRing ring;
+            QVERIFY(ring.setCapture(file));
+            ring.append(XmlRing::In, "<presence xmlns='jabber:client' from='a@example.org/x'/>");
+            ring.append(XmlRing::Out, "<message xmlns='jabber:client' to='a@example.org/x'/>");
+            ring.append(XmlRing::In, "<message xmlns='jabber:client' from='a@example.org/x'/>");
+            ring.append(XmlRing::SysMsg, "Connected");
+        }
+        auto items = StanzaReplay::readCapture(file);
+        QCOMPARE(items.size(), 2);
+        QCOMPARE(items[0].msecs, qint64(0));
+        QCOMPARE(items[0].stanza.tagName(), QString("presence"));
+        QCOMPARE(items[1].stanza.tagName(), QString("message"));
+    }
+
+    void testReplay()
+    {
+        QStringList  received;
+        StanzaReplay replay([&](const QDomElement &e) { received << e.attribute("from"); });
+        QVERIFY(replay.load("synthetic:presence:500", "me@replay.example/psi"));
+        QCOMPARE(replay.count(), 505); // and 5 roster pushes
+        replay.setSpeed(0);
+        replay.setSettleTime(0);
+        replay.setTraceFile(dir.filePath("trace.json"));
+
+        QSignalSpy spy(&replay, &StanzaReplay::finished);
+        replay.start();
+        QVERIFY(spy.wait(10000));
+        QVERIFY(replay.isFinished());
+        QCOMPARE(received.size(), 505);
+        QCOMPARE(received[5], QString("contact0@replay.example/psi"));
+        QVERIFY(!Tracer::isEnabled());
+        QVERIFY(QFile::exists(dir.filePath("trace.json")));
+
+        auto report = replay.report();
+        QCOMPARE(report.value("stanzas").toInt(), 505);
+        QCOMPARE(report.value("kinds").toObject().value("presence").toObject().value("count").toInt(), 500);
+        QCOMPARE(report.value("kinds").toObject().value("iq").toObject().value("count").toInt(), 5);
+        QCOMPARE(report.value("stages").toObject().value("StanzaReplay::inject").toObject().value("count").toInt(),
+                 505);
+        QVERIFY(replay.writeReport(dir.filePath("report.json")));
+    }
+
+    void testMucJoin()
+    {
+        QStringList  joined;
+        QStringList  received;
+        StanzaReplay replay([&](const QDomElement &e) {
+            QVERIFY(!joined.isEmpty()); // the room is joined before its first presence
+            received << e.attribute("from");
+        });
+        replay.setJoinHandler([&](const QString &room) { joined << room; });
+        QVERIFY(replay.load("synthetic:muc:10", "me@replay.example/psi"));
+        QCOMPARE(replay.joins().size(), 1);
+
+        QSignalSpy spy(&replay, &StanzaReplay::finished);
+        replay.setSpeed(0);
+        replay.setSettleTime(0);
+        replay.start();
+        QVERIFY(spy.wait(5000));
+        QCOMPARE(joined, replay.joins());
+        QCOMPARE(received.first(), joined.first());
+
+        auto self = StanzaReplay::synthetic("muc", 2, "me@replay.example/psi").first().stanza;
+        auto x    = self.firstChildElement("x");
+        QCOMPARE(x.firstChildElement("status").attribute("code"), QString("110"));
+        QCOMPARE(x.firstChildElement("item").attribute("role"), QString("moderator"));
+
+        QVERIFY(replay.load("synthetic:chat:10", "me@replay.example/psi"));
+        QVERIFY(replay.joins().isEmpty());
+    }
+
+    void testTiming()
+    {
+        auto items     = StanzaReplay::synthetic("chat", 2, "me@replay.example/psi");
+        items[1].msecs = 400;
+
+        int          received = 0;
+        StanzaReplay replay([&](const QDomElement &) { ++received; });
+        replay.setItems(items);
+        replay.setSpeed(2); // the second one comes 200 ms after the first
+        replay.setSettleTime(0);
+
+        QSignalSpy    spy(&replay, &StanzaReplay::finished);
+        QElapsedTimer timer;
+        timer.start();
+        replay.start();
+        QCOMPARE(received, 1);
+        QVERIFY(spy.wait(5000));
+        QCOMPARE(received, 2);
+        QVERIFY(timer.elapsed() >= 190);
+    }
+};
+
+QTEST_MAIN(TestStanzaReplay)
+#include "teststanzareplay.moc"
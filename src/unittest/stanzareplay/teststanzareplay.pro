@@ -0,0 +1,15 @@
+TARGET = teststanzareplay
+CONFIG += unittest
+include($$PWD/../../../qa/oldtest/unittest.pri)
+
+QT -= gui
+QT += xml
+INCLUDEPATH += ../..
+
+HEADERS += ../../stanzareplay.h \
+    ../../tracer.h \
+    ../../xmlring.h
+SOURCES += teststanzareplay.cpp \
+    ../../stanzareplay.cpp \
+    ../../tracer.cpp \
+    ../../xmlring.cpp
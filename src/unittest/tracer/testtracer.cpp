@@ -0,0 +1,98 @@
+#include "tracer.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+class TestTracer : public QObject {
+    Q_OBJECT
+
+    QTemporaryDir dir;
+
+    QString fileName() const { return dir.filePath("trace.json"); }
+
+    QJsonArray readEvents() const
+    {
+        QFile f(fileName());
+        if (!f.open(QIODevice::ReadOnly))
+            return QJsonArray();
+        return QJsonDocument::fromJson(f.readAll()).object().value("traceEvents").toArray();
+    }
+
+private slots:
+    void testDisabled()
+    {
+        QVERIFY(!Tracer::isEnabled());
+        {
+            TRACE_SPAN("ignored");
+        }
+        QVERIFY(!Tracer::stop());
+        QVERIFY(!QFile::exists(fileName()));
+    }
+
+    void testSpans()
+    {
+        Tracer::start(fileName());
+        {
+            TRACE_SPAN("outer \"quoted\"");
+            TRACE_COUNTER("queue", 42);
+        }
+        auto thread = QThread::create([]() { TRACE_SPAN("worker"); });
+        thread->setObjectName("worker thread");
+        thread->start();
+        thread->wait();
+        delete thread;
+        QVERIFY(Tracer::stop());
+        QVERIFY(!Tracer::isEnabled());
+
+        QStringList                 threads;
+        QHash<QString, QJsonObject> events;
+
+        const auto list = readEvents();
+        for (const auto &v : list) {
+            auto e = v.toObject();
+            if (e.value("ph").toString() == "M")
+                threads << e.value("args").toObject().value("name").toString();
+            else
+                events.insert(e.value("name").toString(), e);
+        }
+        QVERIFY(threads.contains("main"));
+        QVERIFY(threads.contains("worker thread"));
+        QCOMPARE(events.size(), 3);
+        QCOMPARE(events.value("outer \"quoted\"").value("ph").toString(), QString("X"));
+        QVERIFY(events.value("outer \"quoted\"").value("dur").toDouble() >= 0);
+        QCOMPARE(events.value("queue").value("args").toObject().value("value").toInt(), 42);
+        QVERIFY(events.value("worker").value("tid") != events.value("queue").value("tid"));
+    }
+
+    void testRestart()
+    {
+        Tracer::start(fileName());
+        {
+            TRACE_SPAN("dropped");
+        }
+        Tracer::start(fileName()); // starting over drops what was collected
+        QVERIFY(Tracer::stop());
+        for (const auto &v : readEvents())
+            QVERIFY(v.toObject().value("ph").toString() == "M");
+    }
+
+    void testSummary()
+    {
+        Tracer::start(fileName());
+        for (int i = 0; i < 3; ++i) {
+            TRACE_SPAN("repeated");
+        }
+        TRACE_COUNTER("not a span", 1);
+        const auto summary = Tracer::summary();
+        QVERIFY(Tracer::stop());
+        QCOMPARE(summary.size(), 1);
+        QCOMPARE(summary.value("repeated").count, qint64(3));
+        QVERIFY(summary.value("repeated").max <= summary.value("repeated").total);
+    }
+};
+
+QTEST_MAIN(TestTracer)
+#include "testtracer.moc"
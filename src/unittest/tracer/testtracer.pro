@@ -0,0 +1,10 @@
+TARGET = testtracer
+CONFIG += unittest
+include($$PWD/../../../qa/oldtest/unittest.pri)
+
+QT -= gui
+INCLUDEPATH += ../..
+
+HEADERS += ../../tracer.h
+SOURCES += testtracer.cpp \
+    ../../tracer.cpp
@@ -0,0 +1,78 @@
+#include "webassetcache.h"
+
+#include <QtTest/QtTest>
+
+class TestWebAssetCache : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testEtagMatches_data()
+    {
+        QTest::addColumn<QByteArray>("ifNoneMatch");
+        QTest::addColumn<bool>("expected");
+
+        QByteArray etag = WebAssetCache::etag("body { color: red }");
+        QTest::newRow("same") << etag << true;
+        QTest::newRow("weak") << QByteArray("W/" + etag) << true;
+        QTest::newRow("list") << QByteArray("\"abc\", " + etag) << true;
+        QTest::newRow("any") << QByteArray("*") << true;
+        QTest::newRow("other") << WebAssetCache::etag("body { color: blue }") << false;
+        QTest::newRow("empty") << QByteArray() << false;
+    }
+
+    void testEtagMatches()
+    {
+        QFETCH(QByteArray, ifNoneMatch);
+        QFETCH(bool, expected);
+        QCOMPARE(WebAssetCache::etagMatches(ifNoneMatch, WebAssetCache::etag("body { color: red }")), expected);
+    }
+
+    void testDeflate()
+    {
+        QByteArray css   = QByteArray(".message { margin: 0; padding: 2px; }\n").repeated(100);
+        auto       asset = WebAssetCache::makeAsset(css, WebAssetCache::contentType("style/main.css"));
+        QVERIFY(asset.deflated);
+        QVERIFY(asset.data.size() < css.size());
+
+        bool deflated;
+        QCOMPARE(asset.body(false, &deflated), css);
+        QVERIFY(!deflated);
+        QByteArray body = asset.body(true, &deflated);
+        QVERIFY(deflated);
+        // "deflate" content encoding is a zlib stream. qUncompress wants its size prefix
+        QByteArray prefix(4, 0);
+        qToBigEndian<quint32>(quint32(css.size()), reinterpret_cast<uchar *>(prefix.data()));
+        QCOMPARE(qUncompress(prefix + body), css);
+
+        auto png = WebAssetCache::makeAsset(css, "image/png");
+        QVERIFY(!png.deflated);
+        QCOMPARE(png.body(true, &deflated), css);
+        QVERIFY(!deflated);
+    }
+
+    void testCache()
+    {
+        WebAssetCache cache(1000);
+        QVERIFY(cache.find("theme:a.js").isNull());
+        QByteArray data(600, 'a');
+        auto       asset = cache.insert("theme:a.js", data, "image/png");
+        QCOMPARE(cache.find("theme:a.js").etag, asset.etag);
+        QCOMPARE(cache.find("theme:a.js").data, data);
+
+        cache.insert("theme:b.js", QByteArray(600, 'b'), "image/png");
+        QVERIFY(cache.find("theme:a.js").isNull()); // evicted
+        QVERIFY(!cache.find("theme:b.js").isNull());
+        cache.clear();
+        QVERIFY(cache.find("theme:b.js").isNull());
+    }
+
+    void testContentType()
+    {
+        QCOMPARE(WebAssetCache::contentType("adapter.JS"), QByteArray("application/javascript;charset=utf-8"));
+        QCOMPARE(WebAssetCache::contentType("img/bg.png"), QByteArray("image/png"));
+        QVERIFY(WebAssetCache::contentType("Info.plist").isEmpty());
+    }
+};
+
+QTEST_MAIN(TestWebAssetCache)
+#include "testwebassetcache.moc"
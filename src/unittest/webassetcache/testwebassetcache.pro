@@ -0,0 +1,10 @@
+TARGET = testwebassetcache
+CONFIG += unittest
+include($$PWD/../../../qa/oldtest/unittest.pri)
+
+QT -= gui
+INCLUDEPATH += ../..
+
+HEADERS += ../../webassetcache.h
+SOURCES += testwebassetcache.cpp \
+    ../../webassetcache.cpp
@@ -0,0 +1,146 @@
+#include "xmlring.h"
+
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+class TestXmlRing : public QObject {
+    Q_OBJECT
+
+    QTemporaryDir dir;
+
+    static QString stanza(int n) { return QString("<message id='%1'><body>%2</body></message>").arg(n).arg(n); }
+
+private slots:
+    void testBudget()
+    {
+        XmlRing ring(4096);
+        for (int i = 0; i < 1000; ++i)
+            ring.append(i % 2 ? XmlRing::Out : XmlRing::In, stanza(i));
+        QVERIFY(ring.bytes() <= 4096);
+
+        auto records = ring.records();
+        QVERIFY(records.size() > 10 && records.size() < 1000);
+        QCOMPARE(records.last().xml, stanza(999));
+        QCOMPARE(records.last().type, XmlRing::Out);
+        QVERIFY(records.first().time <= records.last().time);
+        QVERIFY(qAbs(records.last().time.msecsTo(QDateTime::currentDateTime())) < 5000);
+
+        // the latest stanza stays even if it doesn't fit
+        QString big(10000, 'x');
+        ring.append(XmlRing::In, big);
+        QCOMPARE(ring.records().size(), 1);
+        QCOMPARE(ring.records().first().xml, big);
+
+        ring.clear();
+        QCOMPARE(ring.bytes(), 0);
+        QVERIFY(ring.records().isEmpty());
+    }
+
+    void testCompression()
+    {
+        XmlRing plain, packed;
+        packed.setCompression(true);
+        QString roster = "<iq type='result'><query xmlns='jabber:iq:roster'>";
+        for (int i = 0; i < 100; ++i)
+            roster += QString("<item jid='contact%1@example.org' subscription='both'/>").arg(i);
+        roster += "</query></iq>";
+        plain.append(XmlRing::In, roster);
+        packed.append(XmlRing::In, roster);
+        QVERIFY(packed.bytes() < plain.bytes() / 2);
+        QCOMPARE(packed.records().first().xml, roster);
+    }
+
+    void testCapture()
+    {
+        QString file = dir.filePath("capture.bin");
+        {
+            XmlRing ring(1024);
+            ring.setCompression(true);
+            QVERIFY(ring.setCapture(file, 2048, 3));
+            for (int i = 0; i < 200; ++i)
+                ring.append(XmlRing::In, stanza(i));
+        }
+        QVERIFY(QFile::exists(file + ".1"));
+        QVERIFY(QFile::exists(file + ".2"));
+        QVERIFY(!QFile::exists(file + ".3"));
+
+        // the oldest records were rotated away, the rest comes in order
+        auto records = XmlRing::readCapture(file, 3);
+        QVERIFY(records.size() > 10 && records.size() < 200);
+        QCOMPARE(records.last().xml, stanza(199));
+        int first = 200 - records.size();
+        for (int i = 0; i < records.size(); ++i)
+            QCOMPARE(records[i].xml, stanza(first + i));
+
+        // appending to an existing capture
+        {
+            XmlRing ring;
+            QVERIFY(ring.setCapture(file, 1024 * 1024, 3));
+            ring.append(XmlRing::Out, stanza(200));
+        }
+        records = XmlRing::readCapture(file, 3);
+        QCOMPARE(records.last().xml, stanza(200));
+        QCOMPARE(records.last().type, XmlRing::Out);
+    }
+
+    void testRedaction_data()
+    {
+        QTest::addColumn<QString>("xml");
+        QTest::addColumn<QString>("expected");
+        QTest::newRow("sasl auth")
+            << "<auth xmlns='urn:ietf:params:xml:ns:xmpp-sasl' mechanism='PLAIN'>AGp1bGlldABzZWNyZXQ=</auth>"
+            << "<auth xmlns='urn:ietf:params:xml:ns:xmpp-sasl' mechanism='PLAIN'>[redacted]</auth>";
+        QTest::newRow("sasl response") << "<response xmlns='urn:ietf:params:xml:ns:xmpp-sasl'>Yz1iaXdz</response>"
+                                       << "<response xmlns='urn:ietf:params:xml:ns:xmpp-sasl'>[redacted]</response>";
+        QTest::newRow("register") << "<iq type='set' id='c1'><query xmlns='jabber:iq:register'>"
+                                     "<username>bill</username><password>newpass</password></query></iq>"
+                                  << "<iq type='set' id='c1'><query xmlns='jabber:iq:register'>"
+                                     "<username>bill</username><password>[redacted]</password></query></iq>";
+        QTest::newRow("register form")
+            << "<query xmlns='jabber:iq:register'><x xmlns='jabber:x:data' type='submit'>"
+               "<field type='text-private' var='password'><value>secret</value></field></x></query>"
+            << "<query xmlns='jabber:iq:register'><x xmlns='jabber:x:data' type='submit'>"
+               "<field type='text-private' var='password'><value>[redacted]</value></field></x></query>";
+        QTest::newRow("omemo") << "<encrypted xmlns='urn:xmpp:omemo:2'><header sid='1'><keys jid='a@b'>"
+                                  "<key rid='2' kex='true'>MwohBf==</key></keys></header><payload>AAA=</payload>"
+                                  "</encrypted>"
+                               << "<encrypted xmlns='urn:xmpp:omemo:2'><header sid='1'><keys jid='a@b'>"
+                                  "<key rid='2' kex='true'>[redacted]</key></keys></header><payload>AAA=</payload>"
+                                  "</encrypted>";
+        QTest::newRow("untouched") << stanza(1) << stanza(1);
+        QTest::newRow("other namespace") << "<iq><query xmlns='jabber:iq:private'><password>x</password></query></iq>"
+                                         << "<iq><query xmlns='jabber:iq:private'><password>x</password></query></iq>";
+    }
+
+    void testRedaction()
+    {
+        QFETCH(QString, xml);
+        QFETCH(QString, expected);
+        QString redacted = xml;
+        QCOMPARE(XmlRing::redact(redacted), xml != expected);
+        QCOMPARE(redacted, expected);
+    }
+
+    void testCaptureRedaction()
+    {
+        QString file = dir.filePath("redaction.bin");
+        QString auth = "<auth xmlns='urn:ietf:params:xml:ns:xmpp-sasl' mechanism='PLAIN'>AGp1bGlldABzZWNyZXQ=</auth>";
+        XmlRing ring;
+        QVERIFY(ring.setCapture(file));
+        ring.append(XmlRing::Out, auth);
+        ring.append(XmlRing::In, stanza(1));
+        QVERIFY(ring.hasUnflushedCapture());
+        ring.flushCapture();
+        QVERIFY(!ring.hasUnflushedCapture());
+
+        // only the file is redacted
+        QCOMPARE(ring.records().first().xml, auth);
+        auto records = XmlRing::readCapture(file);
+        QCOMPARE(records.size(), 2);
+        QVERIFY(!records.first().xml.contains("AGp1"));
+        QCOMPARE(records.last().xml, stanza(1));
+    }
+};
+
+QTEST_MAIN(TestXmlRing)
+#include "testxmlring.moc"
@@ -0,0 +1,10 @@
+TARGET = testxmlring
+CONFIG += unittest
+include($$PWD/../../../qa/oldtest/unittest.pri)
+
+QT -= gui
+INCLUDEPATH += ../..
+
+HEADERS += ../../xmlring.h
+SOURCES += testxmlring.cpp \
+    ../../xmlring.cpp
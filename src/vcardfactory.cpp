@@ -182,6 +182,8 @@ const VCard4::VCard VCardFactory::mucVcard(const Jid &j) const
     return {};
 }
 
+VCard4::VCard VCardFactory::cachedVcard(const Jid &j) const { return vcardDict_.value(j.bare()); }
+
 /**
  * \brief Call this, when you need a cached vCard.
  */
@@ -52,6 +52,8 @@ public:
     static VCardFactory *instance();
     VCard4::VCard        vcard(const Jid &, Flags flags = {});
     const VCard4::VCard  mucVcard(const Jid &j) const;
+    // only what was already loaded to memory. never touches the disk
+    VCard4::VCard cachedVcard(const Jid &j) const;
 
     Task *setVCard(PsiAccount *account, const VCard4::VCard &v, const Jid &targetJid, VCardFactory::Flags flags);
     VCardRequest *getVCard(PsiAccount *account, const Jid &, VCardFactory::Flags flags = {});
@@ -0,0 +1,120 @@
+/*
+ * webassetcache.cpp - in-memory cache of resources served to chat views
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "webassetcache.h"
+
+#include <QCryptographicHash>
+#include <QFileInfo>
+#include <QList>
+#include <QPair>
+
+static const int minDeflateSize = 512; // smaller assets aren't worth it
+
+static bool isText(const QByteArray &contentType)
+{
+    return contentType.startsWith("text/") || contentType.startsWith("application/javascript")
+        || contentType.startsWith("application/json") || contentType.startsWith("image/svg+xml");
+}
+
+QByteArray WebAssetCache::Asset::body(bool acceptDeflate, bool *isDeflated) const
+{
+    *isDeflated = deflated && acceptDeflate;
+    if (!deflated)
+        return data;
+    // qCompress() output is zlib stream prefixed with 4 bytes of the uncompressed size.
+    // zlib stream is exactly what HTTP calls "deflate"
+    return acceptDeflate ? data.mid(4) : qUncompress(data);
+}
+
+WebAssetCache::WebAssetCache(int maxSize) : cache_(maxSize) { }
+
+WebAssetCache::Asset WebAssetCache::find(const QString &key)
+{
+    Asset *asset = cache_.object(key);
+    return asset ? *asset : Asset();
+}
+
+WebAssetCache::Asset WebAssetCache::insert(const QString &key, const QByteArray &data, const QByteArray &contentType)
+{
+    Asset asset = makeAsset(data, contentType);
+    cache_.insert(key, new Asset(asset), qMax(1, int(asset.data.size())));
+    return asset;
+}
+
+void WebAssetCache::clear() { cache_.clear(); }
+
+WebAssetCache::Asset WebAssetCache::makeAsset(const QByteArray &data, const QByteArray &contentType)
+{
+    Asset asset;
+    asset.contentType = contentType;
+    asset.etag        = etag(data);
+    if (data.size() >= minDeflateSize && isText(contentType)) {
+        asset.data     = qCompress(data);
+        asset.deflated = true;
+    } else {
+        asset.data = data;
+    }
+    return asset;
+}
+
+QByteArray WebAssetCache::etag(const QByteArray &data)
+{
+    return '"' + QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex().left(32) + '"';
+}
+
+bool WebAssetCache::etagMatches(const QByteArray &ifNoneMatch, const QByteArray &etag)
+{
+    if (ifNoneMatch.isEmpty() || etag.isEmpty())
+        return false;
+    const auto tags = ifNoneMatch.split(',');
+    for (QByteArray tag : tags) {
+        tag = tag.trimmed();
+        if (tag.startsWith("W/")) // weak comparison is fine for GET
+            tag = tag.mid(2);
+        if (tag == "*" || tag == etag)
+            return true;
+    }
+    return false;
+}
+
+QByteArray WebAssetCache::contentType(const QString &fileName)
+{
+    static const QList<QPair<QString, QByteArray>> types {
+        { QLatin1String("css"), "text/css;charset=utf-8" },
+        { QLatin1String("js"), "application/javascript;charset=utf-8" },
+        { QLatin1String("html"), "text/html;charset=utf-8" },
+        { QLatin1String("htm"), "text/html;charset=utf-8" },
+        { QLatin1String("json"), "application/json;charset=utf-8" },
+        { QLatin1String("svg"), "image/svg+xml" },
+        { QLatin1String("png"), "image/png" },
+        { QLatin1String("jpg"), "image/jpeg" },
+        { QLatin1String("jpeg"), "image/jpeg" },
+        { QLatin1String("gif"), "image/gif" },
+        { QLatin1String("webp"), "image/webp" },
+        { QLatin1String("woff"), "font/woff" },
+        { QLatin1String("woff2"), "font/woff2" },
+        { QLatin1String("ttf"), "font/ttf" },
+    };
+    QString suffix = QFileInfo(fileName).suffix().toLower();
+    for (const auto &t : types) {
+        if (t.first == suffix)
+            return t.second;
+    }
+    return QByteArray();
+}
@@ -0,0 +1,65 @@
+/*
+ * webassetcache.h - in-memory cache of resources served to chat views
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef WEBASSETCACHE_H
+#define WEBASSETCACHE_H
+
+#include <QByteArray>
+#include <QCache>
+#include <QString>
+
+/**
+ * LRU cache of files served by the internal web server (theme css/js/images etc).
+ *
+ * Every asset gets an ETag made of its content hash, so a chat view asking
+ * for a file it already has gets "304 Not Modified" without the file being
+ * read again. Text assets are kept deflated, and they are sent to the client
+ * as they are when it accepts "Content-Encoding: deflate".
+ */
+class WebAssetCache {
+public:
+    struct Asset {
+        QByteArray data; // qCompress()'ed if deflated
+        QByteArray contentType;
+        QByteArray etag;
+        bool       deflated = false;
+
+        inline bool isNull() const { return etag.isEmpty(); }
+        // the data to send. deflated is set if it has to go with "Content-Encoding: deflate"
+        QByteArray body(bool acceptDeflate, bool *deflated) const;
+    };
+
+    explicit WebAssetCache(int maxSize = 16 * 1024 * 1024);
+
+    // returns a null asset if nothing is cached for the key
+    Asset find(const QString &key);
+    Asset insert(const QString &key, const QByteArray &data, const QByteArray &contentType);
+    void  clear();
+
+    static Asset      makeAsset(const QByteArray &data, const QByteArray &contentType);
+    static QByteArray etag(const QByteArray &data);
+    // checks If-None-Match header value
+    static bool       etagMatches(const QByteArray &ifNoneMatch, const QByteArray &etag);
+    static QByteArray contentType(const QString &fileName);
+
+private:
+    QCache<QString, Asset> cache_;
+};
+
+#endif // WEBASSETCACHE_H
@@ -40,6 +40,43 @@ QUrl WebServer::serverUrl()
     return u;
 }
 
+void WebServer::sendAsset(qhttp::server::QHttpRequest *req, qhttp::server::QHttpResponse *res,
+                          const WebAssetCache::Asset &asset, CachePolicy policy)
+{
+    // qhttp::server keeps headers lower-cased
+    static const QByteArray ifNoneMatch("if-none-match");
+    static const QByteArray acceptEncoding("accept-encoding");
+
+    switch (policy) {
+    case Revalidate:
+        res->addHeader("Cache-Control", "no-cache");
+        break;
+    case Immutable:
+        res->addHeader("Cache-Control", "public, max-age=31536000, immutable");
+        break;
+    case NoStore:
+        res->addHeader("Cache-Control", "no-store");
+        break;
+    }
+    if (policy != NoStore) {
+        res->addHeader("ETag", asset.etag);
+        if (WebAssetCache::etagMatches(req->headers().value(ifNoneMatch), asset.etag)) {
+            res->setStatusCode(qhttp::ESTATUS_NOT_MODIFIED);
+            res->end();
+            return;
+        }
+    }
+
+    bool       deflated;
+    QByteArray body = asset.body(req->headers().value(acceptEncoding).contains("deflate"), &deflated);
+    if (!asset.contentType.isEmpty())
+        res->addHeader("Content-Type", asset.contentType);
+    if (deflated)
+        res->addHeader("Content-Encoding", "deflate");
+    res->setStatusCode(qhttp::ESTATUS_OK);
+    res->end(body);
+}
+
 void WebServer::route(const char *path, const WebServer::Handler &handler)
 {
     pathHandlers.append(QPair<QString, Handler>(QLatin1String(path), handler));
@@ -4,6 +4,7 @@
 #include "qhttpserver.hpp"
 #include "qhttpserverrequest.hpp"
 #include "qhttpserverresponse.hpp"
+#include "webassetcache.h"
 
 #include <QObject>
 #include <functional>
@@ -13,6 +14,12 @@ class WebServer : public qhttp::server::QHttpServer {
 public:
     typedef std::function<bool(qhttp::server::QHttpRequest *req, qhttp::server::QHttpResponse *res)> Handler;
 
+    enum CachePolicy {
+        Revalidate, // the client may keep it but has to check the ETag each time
+        Immutable,  // the url is made of the content hash (avatars, bob)
+        NoStore
+    };
+
     WebServer(QObject *parent = nullptr);
 
     quint16      serverPort() const;
@@ -24,6 +31,10 @@ public:
 
     inline void setDefaultHandler(const Handler &h) { defaultHandler = h; }
 
+    // sends the asset with cache headers or just "304 Not Modified" if the client has it already
+    static void sendAsset(qhttp::server::QHttpRequest *req, qhttp::server::QHttpResponse *res,
+                          const WebAssetCache::Asset &asset, CachePolicy policy = Revalidate);
+
 private:
     QList<QPair<QString, Handler>> pathHandlers;
     Handler                        defaultHandler;
@@ -132,28 +132,14 @@ span.emojis {
                   QString anchorName = QLatin1String("share:") + id;
                   QUrl    url(anchorName);
 
-                  if (item->isCached()) {
-                      QVariant         vimg = document()->resource(QTextDocument::ImageResource, url);
-                      QTextImageFormat fmt;
-                      fmt.setName(url.toString());
-                      QImage img;
-                      if (vimg.isValid()) {
-                          img = vimg.value<QImage>();
-                      } else {
-                          img = item->preview(QSize(640, 480));
-                          document()->addResource(QTextDocument::ImageResource, url, img);
-                      }
-
-                      fmt.setWidth(img.width());
-                      fmt.setHeight(img.height());
-
-                      return { fmt, "" };
-                  }
-
-                  // otherwise we have to download it
-                  connect(item, &FileSharingItem::downloadFinished, this, [this, anchorName, url, item, insertAfter]() {
+                  // replaces the markers with the preview. false if the preview is not decoded yet
+                  auto insertPreview = [this, anchorName, url, item, insertAfter]() {
+                      bool pending;
+                      auto img = item->preview(QSize(640, 480), &pending);
+                      if (pending)
+                          return false;
                       item->disconnect(this);
-                      document()->addResource(QTextDocument::ImageResource, url, item->preview(QSize(640, 480)));
+                      document()->addResource(QTextDocument::ImageResource, url, img);
                       auto        prevCur = textCursor();
                       QTextCursor cur(document());
                       cur.setPosition(insertAfter);
@@ -162,11 +148,11 @@ span.emojis {
                       if (cur.isNull()) {
                           cur = PsiRichText::findMarker(QTextCursor(document()), anchorName + "/start");
                           if (cur.isNull())
-                              return;
+                              return true;
                       }
                       auto curEnd = PsiRichText::findMarker(cur, anchorName + "/end");
                       if (curEnd.isNull())
-                          return;
+                          return true;
 
                       bool doScroll = atBottom();
                       cur.setPosition(curEnd.position() + 1, QTextCursor::KeepAnchor);
@@ -176,6 +162,40 @@ span.emojis {
                       if (doScroll)
                           QTimer::singleShot(0, this, &PsiTextView::scrollToBottom);
                       setTextCursor(prevCur);
+                      return true;
+                  };
+
+                  if (item->isCached()) {
+                      QVariant vimg    = document()->resource(QTextDocument::ImageResource, url);
+                      bool     pending = false;
+                      QImage   img;
+                      if (vimg.isValid()) {
+                          img = vimg.value<QImage>();
+                      } else {
+                          img = item->preview(QSize(640, 480), &pending);
+                          if (!pending)
+                              document()->addResource(QTextDocument::ImageResource, url, img);
+                      }
+
+                      if (!pending) {
+                          QTextImageFormat fmt;
+                          fmt.setName(url.toString());
+                          fmt.setWidth(img.width());
+                          fmt.setHeight(img.height());
+                          return { fmt, "" };
+                      }
+
+                      // decoded in background. show a placeholder till then
+                      connect(item, &FileSharingItem::imageReady, this, insertPreview);
+                      return { QTextCharFormat(),
+                               QString("<marker id=\"%1/start\">%2<marker id=\"%3/end\">")
+                                   .arg(anchorName, tr("Loading preview (%1)").arg(item->mimeType()), anchorName) };
+                  }
+
+                  // otherwise we have to download it
+                  connect(item, &FileSharingItem::downloadFinished, this, [this, item, insertPreview]() {
+                      if (!insertPreview())
+                          connect(item, &FileSharingItem::imageReady, this, insertPreview);
                   });
                   auto downloader = item->download();
                   downloader->setSelfDelete(true);
@@ -26,6 +26,7 @@
 #include "psicon.h"
 #include "psicontactlist.h"
 #include "textutil.h"
+#include "tracer.h"
 
 #include <QCheckBox>
 #include <QHBoxLayout>
@@ -130,6 +131,7 @@ void XmlConsole::dumpRingbuf()
 
 void XmlConsole::addRecord(bool incoming, const QString &str)
 {
+    TRACE_SPAN("XmlConsole::addRecord");
     if (filtered(str))
         return;
     auto *textEdit    = ui_.te;
@@ -0,0 +1,251 @@
+/*
+ * xmlring.cpp - memory and disk buffer of recent xml traffic
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "xmlring.h"
+
+#include <QDataStream>
+#include <QFile>
+#include <QRegularExpression>
+
+static const quint32 captureMagic      = 0x50535852; // PSXR
+static const quint32 captureVersion    = 1;
+static const quint8  compressedFlag    = 1;
+static const int     compressThreshold = 512; // small stanzas hardly get smaller
+
+XmlRing::XmlRing(qint64 byteBudget) : budget_(byteBudget)
+{
+    clock_.start();
+    epochMsecs_ = QDateTime::currentMSecsSinceEpoch();
+}
+
+XmlRing::~XmlRing() { }
+
+void XmlRing::setByteBudget(qint64 bytes)
+{
+    budget_ = bytes;
+    shrink();
+}
+
+void XmlRing::setCompression(bool enabled) { compress_ = enabled; }
+
+void XmlRing::append(Type type, const QString &xml)
+{
+    Entry e = makeEntry(clock_.elapsed(), type, xml);
+
+    if (capture_) {
+        QString safe = xml;
+        if (redact(safe))
+            writeCapture(makeEntry(e.msecs, type, safe));
+        else
+            writeCapture(e);
+    }
+
+    bytes_ += e.data.size() + qint64(sizeof(Entry));
+    entries_.push_back(std::move(e));
+    shrink();
+}
+
+XmlRing::Entry XmlRing::makeEntry(qint64 msecs, Type type, const QString &xml) const
+{
+    Entry e { msecs, type, false, xml.toUtf8() };
+    if (compress_ && e.data.size() >= compressThreshold) {
+        QByteArray packed = qCompress(e.data, 1);
+        if (packed.size() < e.data.size()) {
+            e.data       = packed;
+            e.compressed = true;
+        }
+    }
+    return e;
+}
+
+void XmlRing::writeCapture(const Entry &e)
+{
+    if (captureSize_ >= maxFileSize_)
+        rotateCapture();
+    if (!capture_)
+        return;
+    QDataStream out(capture_.get());
+    out << qint64(epochMsecs_ + e.msecs) << quint8(e.type) << quint8(e.compressed ? compressedFlag : 0)
+        << quint32(e.data.size());
+    out.writeRawData(e.data.constData(), int(e.data.size()));
+    captureSize_ += qint64(sizeof(qint64) + 2 * sizeof(quint8) + sizeof(quint32)) + e.data.size();
+    unflushed_ = true;
+}
+
+void XmlRing::flushCapture()
+{
+    if (capture_)
+        capture_->flush();
+    unflushed_ = false;
+}
+
+bool XmlRing::hasUnflushedCapture() const { return unflushed_; }
+
+bool XmlRing::redact(QString &xml)
+{
+    struct Rule {
+        QLatin1String      marker; // namespace of the elements, checked first since it's cheap
+        QRegularExpression element;
+    };
+    // the element text is replaced. sasl payloads, iq:auth/iq:register passwords, omemo message keys
+    static const auto element = [](const char *names) {
+        return QRegularExpression(QString("(<(?:\\w+:)?(?:%1)(?:\\s[^>]*)?>)[^<]+(</)").arg(QLatin1String(names)));
+    };
+    static const Rule rules[] = {
+        { QLatin1String("urn:ietf:params:xml:ns:xmpp-sasl"), element("auth|response|challenge|success") },
+        { QLatin1String("urn:xmpp:sasl:2"), element("initial-response|response|challenge|additional-data") },
+        { QLatin1String("jabber:iq:auth"), element("password|digest") },
+        { QLatin1String("jabber:iq:register"), element("password") },
+        // the registration form
+        { QLatin1String("jabber:iq:register"),
+          QRegularExpression("(<field\\s[^>]*var=['\"](?:password|old_password)['\"][^>]*>\\s*<value>)[^<]+(</)") },
+        { QLatin1String("eu.siacs.conversations.axolotl"), element("key") },
+        { QLatin1String("urn:xmpp:omemo:"), element("key") },
+    };
+
+    bool changed = false;
+    for (const auto &rule : rules) {
+        if (xml.contains(rule.marker)) {
+            QString redacted = QString(xml).replace(rule.element, QStringLiteral("\\1[redacted]\\2"));
+            if (redacted != xml) {
+                xml     = redacted;
+                changed = true;
+            }
+        }
+    }
+    return changed;
+}
+
+void XmlRing::clear()
+{
+    entries_.clear();
+    entries_.shrink_to_fit();
+    bytes_ = 0;
+}
+
+qint64 XmlRing::bytes() const { return bytes_; }
+
+void XmlRing::shrink()
+{
+    // the latest one is kept even if it alone is over the budget
+    while (bytes_ > budget_ && entries_.size() > 1) {
+        bytes_ -= entries_.front().data.size() + qint64(sizeof(Entry));
+        entries_.pop_front();
+    }
+}
+
+QList<XmlRing::Record> XmlRing::records() const
+{
+    QList<Record> ret;
+    ret.reserve(int(entries_.size()));
+    for (const auto &e : entries_) {
+        ret.append({ e.type, QDateTime::fromMSecsSinceEpoch(epochMsecs_ + e.msecs),
+                     QString::fromUtf8(e.compressed ? qUncompress(e.data) : e.data) });
+    }
+    return ret;
+}
+
+bool XmlRing::setCapture(const QString &fileName, qint64 maxFileSize, int maxFiles)
+{
+    maxFileSize_ = maxFileSize;
+    maxFiles_    = qMax(1, maxFiles);
+    if (fileName == captureName_ && (capture_ || fileName.isEmpty()))
+        return true;
+
+    capture_.reset();
+    captureName_ = fileName;
+    if (fileName.isEmpty())
+        return true;
+    return openCapture(false);
+}
+
+QString XmlRing::captureFile() const { return captureName_; }
+
+bool XmlRing::openCapture(bool truncate)
+{
+    capture_.reset(new QFile(captureName_));
+    if (!truncate && capture_->open(QIODevice::ReadOnly)) {
+        // appending to a file of another format would make both unreadable
+        QDataStream in(capture_.get());
+        quint32     magic = 0, version = 0;
+        in >> magic >> version;
+        truncate = capture_->size() && (magic != captureMagic || version != captureVersion);
+        capture_->close();
+    }
+    if (!capture_->open(truncate ? QIODevice::WriteOnly | QIODevice::Truncate : QIODevice::Append)) {
+        qWarning("xmlring: failed to open %s: %s", qPrintable(captureName_), qPrintable(capture_->errorString()));
+        capture_.reset();
+        return false;
+    }
+    captureSize_ = capture_->size();
+    if (captureSize_ == 0) {
+        QDataStream out(capture_.get());
+        out << captureMagic << captureVersion;
+        captureSize_ = qint64(2 * sizeof(quint32));
+    }
+    return true;
+}
+
+void XmlRing::rotateCapture()
+{
+    capture_.reset();
+    QFile::remove(QString("%1.%2").arg(captureName_).arg(maxFiles_ - 1));
+    for (int i = maxFiles_ - 2; i >= 1; --i)
+        QFile::rename(QString("%1.%2").arg(captureName_).arg(i), QString("%1.%2").arg(captureName_).arg(i + 1));
+    if (maxFiles_ > 1)
+        QFile::rename(captureName_, captureName_ + ".1");
+    openCapture(true);
+}
+
+QList<XmlRing::Record> XmlRing::readCapture(const QString &fileName, int maxFiles)
+{
+    QList<Record> ret;
+    for (int i = maxFiles - 1; i >= 1; --i)
+        ret += readCaptureFile(QString("%1.%2").arg(fileName).arg(i));
+    ret += readCaptureFile(fileName);
+    return ret;
+}
+
+QList<XmlRing::Record> XmlRing::readCaptureFile(const QString &fileName)
+{
+    QList<Record> ret;
+    QFile         f(fileName);
+    if (!f.open(QIODevice::ReadOnly))
+        return ret;
+
+    QDataStream in(&f);
+    quint32     magic, version;
+    in >> magic >> version;
+    if (magic != captureMagic || version != captureVersion)
+        return ret;
+    while (!in.atEnd()) {
+        qint64  time;
+        quint8  type, flags;
+        quint32 size;
+        in >> time >> type >> flags >> size;
+        if (in.status() != QDataStream::Ok || size > f.size())
+            break;
+        QByteArray data(int(size), Qt::Uninitialized);
+        if (in.readRawData(data.data(), int(size)) != int(size))
+            break; // cut short by a crash
+        ret.append({ Type(type), QDateTime::fromMSecsSinceEpoch(time),
+                     QString::fromUtf8(flags & compressedFlag ? qUncompress(data) : data) });
+    }
+    return ret;
+}
@@ -0,0 +1,120 @@
+/*
+ * xmlring.h - memory and disk buffer of recent xml traffic
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef XMLRING_H
+#define XMLRING_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QList>
+#include <QString>
+
+#include <deque>
+#include <memory>
+
+class QFile;
+
+/**
+ * Keeps the most recent xml traffic of an account within a memory budget,
+ * so there is something to look at when a problem shows up with the xml
+ * console closed.
+ *
+ * Stanzas are stored as UTF-8, optionally compressed, with a monotonic
+ * timestamp. The oldest ones are dropped when the budget is exceeded.
+ *
+ * Optionally every record is also appended to a capture file, which is
+ * rotated to <file>.1 ... <file>.<maxFiles - 1> when it grows too large.
+ * Credentials (SASL exchange, passwords of iq:auth and iq:register) and
+ * OMEMO message keys are replaced with "[redacted]" there, see redact().
+ * The file is written through a buffer. The owner calls flushCapture()
+ * when hasUnflushedCapture(), usually CaptureFlushDelay after the first
+ * unflushed record, so a crash loses at most that much.
+ * Its format, with all integers big endian:
+ *   header:  quint32 magic 0x50535852 ("PSXR"), quint32 version 1
+ *   records: qint64 time in ms since the epoch (UTC), quint8 type (see Type),
+ *            quint8 flags (1 - the payload is compressed by qCompress(): a
+ *            quint32 size of the uncompressed data followed by a zlib stream),
+ *            quint32 payload size, UTF-8 xml payload
+ */
+class XmlRing {
+public:
+    enum Type : quint8 { In, Out, SysMsg };
+    enum { CaptureFlushDelay = 1000 }; // ms
+
+    struct Record {
+        Type      type;
+        QDateTime time;
+        QString   xml;
+    };
+
+    explicit XmlRing(qint64 byteBudget = 1024 * 1024);
+    ~XmlRing();
+
+    void   setByteBudget(qint64 bytes);
+    void   setCompression(bool enabled);
+    void   append(Type type, const QString &xml);
+    void   clear();
+    qint64 bytes() const;
+
+    // oldest first
+    QList<Record> records() const;
+
+    // an empty fileName stops capturing
+    bool    setCapture(const QString &fileName, qint64 maxFileSize = 4 * 1024 * 1024, int maxFiles = 4);
+    QString captureFile() const;
+    void    flushCapture();
+    bool    hasUnflushedCapture() const;
+
+    // replaces the content of credential-carrying elements. returns false if there are none
+    static bool redact(QString &xml);
+
+    // records of the capture file and all its rotated files, oldest first
+    static QList<Record> readCapture(const QString &fileName, int maxFiles = 4);
+    static QList<Record> readCaptureFile(const QString &fileName);
+
+private:
+    struct Entry {
+        qint64     msecs; // since clock_ start
+        Type       type;
+        bool       compressed;
+        QByteArray data;
+    };
+
+    Entry makeEntry(qint64 msecs, Type type, const QString &xml) const;
+    void  writeCapture(const Entry &e);
+    bool  openCapture(bool truncate);
+    void  rotateCapture();
+    void  shrink();
+
+    std::deque<Entry>      entries_;
+    qint64                 bytes_ = 0;
+    qint64                 budget_;
+    bool                   compress_ = false;
+    QElapsedTimer          clock_;
+    qint64                 epochMsecs_; // wall clock time of the clock_ start
+    std::unique_ptr<QFile> capture_;
+    QString                captureName_;
+    qint64                 maxFileSize_ = 0;
+    int                    maxFiles_    = 0;
+    qint64                 captureSize_ = 0; // QFile::size() would flush
+    bool                   unflushed_   = false;
+};
+
+#endif // XMLRING_H